@@ -24,24 +24,26 @@
 
 #include "akonadiartifactqueries.h"
 
-#include "akonadicollectionfetchjobinterface.h"
-#include "akonadiitemfetchjobinterface.h"
-
-#include "utils/jobhandler.h"
+#include "akonadiqueryscheduler.h"
 
 using namespace Akonadi;
 
 ArtifactQueries::ArtifactQueries(const StorageInterface::Ptr &storage,
                                  const SerializerInterface::Ptr &serializer,
-                                 const MonitorInterface::Ptr &monitor)
+                                 const MonitorInterface::Ptr &monitor,
+                                 const TagIndex::Ptr &tagIndex)
     : m_storage(storage),
       m_serializer(serializer),
-      m_monitor(monitor)
+      m_monitor(monitor),
+      m_tagIndex(tagIndex),
+      m_selectedScope(CollectionScope::SelectedCollections)
 {
-    connect(m_monitor.data(), SIGNAL(itemAdded(Akonadi::Item)), this, SLOT(onItemAdded(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemRemoved(Akonadi::Item)), this, SLOT(onItemRemoved(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemChanged(Akonadi::Item)), this, SLOT(onItemChanged(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(collectionSelectionChanged(Akonadi::Collection)), this, SLOT(onCollectionSelectionChanged()));
+    QueryScheduler::install();
+
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(collectionSelectionChanged(Akonadi::Collection)), this, SLOT(onCollectionSelectionChanged(Akonadi::Collection)));
 }
 
 ArtifactQueries::ArtifactResult::Ptr ArtifactQueries::findInboxTopLevel() const
@@ -50,31 +52,11 @@ ArtifactQueries::ArtifactResult::Ptr ArtifactQueries::findInboxTopLevel() const
         {
             ArtifactQueries *self = const_cast<ArtifactQueries*>(this);
             self->m_findInbox = self->createArtifactQuery();
+            self->m_findInbox->setDebugName(QStringLiteral("ArtifactQueries::findInboxTopLevel"));
         }
 
         m_findInbox->setFetchFunction([this] (const ArtifactQuery::AddFunction &add) {
-            CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
-                                                                           StorageInterface::Recursive,
-                                                                           StorageInterface::Tasks|StorageInterface::Notes);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
-                    return;
-
-                for (auto collection : job->collections()) {
-                    if (!m_serializer->isSelectedCollection(collection))
-                        continue;
-
-                    ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
-
-                        for (auto item : job->items()) {
-                            add(item);
-                        }
-                    });
-                }
-            });
+            m_selectedScope.fetchItems(m_storage, m_serializer, StorageInterface::Tasks|StorageInterface::Notes, add);
         });
 
         m_findInbox->setConvertFunction([this] (const Akonadi::Item &item) {
@@ -102,8 +84,10 @@ ArtifactQueries::ArtifactResult::Ptr ArtifactQueries::findInboxTopLevel() const
         m_findInbox->setPredicateFunction([this] (const Akonadi::Item &item) {
             const bool excluded = !m_serializer->relatedUidFromItem(item).isEmpty()
                                || (!m_serializer->isTaskItem(item) && !m_serializer->isNoteItem(item))
-                               || (m_serializer->isTaskItem(item) && m_serializer->hasContextTags(item))
-                               || m_serializer->hasAkonadiTags(item);
+                               || (m_serializer->isTaskItem(item) && (m_tagIndex ? m_tagIndex->hasContextTags(item)
+                                                                                 : m_serializer->hasContextTags(item)))
+                               || (m_tagIndex ? m_tagIndex->hasPlainTags(item)
+                                              : m_serializer->hasAkonadiTags(item));
 
             return !excluded;
         });
@@ -111,6 +95,8 @@ ArtifactQueries::ArtifactResult::Ptr ArtifactQueries::findInboxTopLevel() const
         m_findInbox->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Artifact::Ptr &artifact) {
             return m_serializer->representsItem(artifact, item);
         });
+
+        m_findInbox->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findInbox->result();
@@ -123,28 +109,46 @@ ArtifactQueries::TagResult::Ptr ArtifactQueries::findTags(Domain::Artifact::Ptr
     return TagResult::Ptr();
 }
 
-void ArtifactQueries::onItemAdded(const Item &item)
+void ArtifactQueries::onItemsAdded(const Item::List &items)
 {
+    const auto inScope = m_selectedScope.filter(items);
     foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onAdded(item);
+        query->onAddedBatch(inScope);
 }
 
-void ArtifactQueries::onItemRemoved(const Item &item)
+void ArtifactQueries::onItemsRemoved(const Item::List &items)
 {
     foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onRemoved(item);
+        query->onRemovedBatch(items);
 }
 
-void ArtifactQueries::onItemChanged(const Item &item)
+void ArtifactQueries::onItemsChanged(const Item::List &items)
 {
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onChanged(item);
+    // Items moved to a deselected collection go away
+    Item::List outOfScope;
+    const auto inScope = m_selectedScope.filter(items, &outOfScope);
+    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries) {
+        query->onChangedBatch(inScope);
+        if (!outOfScope.isEmpty())
+            query->onRemovedBatch(outOfScope);
+    }
 }
 
-void ArtifactQueries::onCollectionSelectionChanged()
+void ArtifactQueries::onCollectionSelectionChanged(const Collection &collection)
 {
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->reset();
+    if (m_artifactQueries.isEmpty())
+        return;
+
+    // Only the contents of the toggled collection get fetched
+    m_selectedScope.changeSelection(collection, m_storage, m_serializer,
+                                    [this] (const Akonadi::Item::List &items, bool selected) {
+        foreach (const ArtifactQuery::Ptr &query, m_artifactQueries) {
+            if (selected)
+                query->onChangedBatch(items);
+            else
+                query->onRemovedBatch(items);
+        }
+    });
 }
 
 ArtifactQueries::ArtifactQuery::Ptr ArtifactQueries::createArtifactQuery()
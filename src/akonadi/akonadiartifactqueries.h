@@ -27,9 +27,11 @@
 #include <QHash>
 #include <AkonadiCore/Item>
 
+#include "akonadi/akonadicollectionscope.h"
 #include "akonadi/akonadimonitorinterface.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
+#include "akonadi/akonaditagindex.h"
 
 #include "domain/artifactqueries.h"
 #include "domain/livequery.h"
@@ -55,16 +57,17 @@ public:
 
     ArtifactQueries(const StorageInterface::Ptr &storage,
                     const SerializerInterface::Ptr &serializer,
-                    const MonitorInterface::Ptr &monitor);
+                    const MonitorInterface::Ptr &monitor,
+                    const TagIndex::Ptr &tagIndex = TagIndex::Ptr());
 
     ArtifactResult::Ptr findInboxTopLevel() const Q_DECL_OVERRIDE;
     TagResult::Ptr findTags(Domain::Artifact::Ptr artifact) const Q_DECL_OVERRIDE;
 
 private slots:
-    void onItemAdded(const Akonadi::Item &item);
-    void onItemRemoved(const Akonadi::Item &item);
-    void onItemChanged(const Akonadi::Item &item);
-    void onCollectionSelectionChanged();
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
+    void onCollectionSelectionChanged(const Akonadi::Collection &collection);
 
 private:
     ArtifactQuery::Ptr createArtifactQuery();
@@ -72,9 +75,12 @@ private:
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
     MonitorInterface::Ptr m_monitor;
+    TagIndex::Ptr m_tagIndex;
 
     ArtifactQuery::Ptr m_findInbox;
     ArtifactQuery::List m_artifactQueries;
+    // Scope of the queries showing the selected collections contents
+    CollectionScope m_selectedScope;
 };
 
 }
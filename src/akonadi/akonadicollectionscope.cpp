@@ -0,0 +1,162 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#include "akonadicollectionscope.h"
+
+#include "akonadicollectionfetchjobinterface.h"
+#include "akonadiitemfetchjobinterface.h"
+
+#include "utils/jobhandler.h"
+
+using namespace Akonadi;
+
+CollectionScope::CollectionScope(Type type, const Collection &collection)
+    : m_type(type),
+      m_collection(collection),
+      m_state(new State)
+{
+    Q_ASSERT(m_type != SingleCollection || m_collection.isValid());
+}
+
+CollectionScope::Type CollectionScope::type() const
+{
+    return m_type;
+}
+
+Collection CollectionScope::collection() const
+{
+    return m_collection;
+}
+
+void CollectionScope::fetchItems(const StorageInterface::Ptr &storage,
+                                 const SerializerInterface::Ptr &serializer,
+                                 StorageInterface::FetchContentTypes types,
+                                 const AddFunction &add) const
+{
+    auto fetchCollectionItems = [storage, add] (const Collection &collection) {
+        ItemFetchJobInterface *job = storage->fetchItems(collection);
+        job->streamItems([add] (const Akonadi::Item::List &items) {
+            for (auto item : items)
+                add(item);
+        });
+    };
+
+    if (m_type == SingleCollection) {
+        fetchCollectionItems(m_collection);
+        return;
+    }
+
+    CollectionFetchJobInterface *job = storage->fetchCollections(Akonadi::Collection::root(),
+                                                                 StorageInterface::Recursive,
+                                                                 types);
+    const CollectionScope self = *this;
+    Utils::JobHandler::install(job->kjob(), [self, job, serializer, fetchCollectionItems] {
+        if (job->kjob()->error() != KJob::NoError)
+            return;
+
+        for (auto collection : job->collections()) {
+            const bool accepted = self.accepts(collection, serializer);
+            self.rememberCollection(collection, accepted);
+            if (accepted)
+                fetchCollectionItems(collection);
+        }
+    });
+}
+
+bool CollectionScope::mightContain(const Item &item) const
+{
+    const auto collectionId = item.parentCollection().id();
+
+    switch (m_type) {
+    case AllCollections:
+        return true;
+    case SelectedCollections:
+        return !m_state->excludedIds.contains(collectionId);
+    case SingleCollection:
+        return collectionId == m_collection.id();
+    }
+
+    return true;
+}
+
+Item::List CollectionScope::filter(const Item::List &items, Item::List *rejected) const
+{
+    if (m_type == AllCollections)
+        return items;
+
+    Item::List result;
+    foreach (const Item &item, items) {
+        if (mightContain(item))
+            result << item;
+        else if (rejected)
+            *rejected << item;
+    }
+    return result;
+}
+
+void CollectionScope::changeSelection(const Collection &collection,
+                                      const StorageInterface::Ptr &storage,
+                                      const SerializerInterface::Ptr &serializer,
+                                      const SelectionFunction &apply) const
+{
+    Q_ASSERT(m_type == SelectedCollections);
+
+    const int generation = ++m_state->selectionChanges[collection.id()];
+    const bool selected = accepts(collection, serializer);
+    rememberCollection(collection, selected);
+
+    ItemFetchJobInterface *job = storage->fetchItems(collection);
+    const auto state = m_state;
+    Utils::JobHandler::install(job->kjob(), [job, state, collection, generation, selected, apply] {
+        if (job->kjob()->error() != KJob::NoError)
+            return;
+
+        if (state->selectionChanges.value(collection.id()) != generation)
+            return;
+
+        apply(job->items(), selected);
+    });
+}
+
+bool CollectionScope::accepts(const Collection &collection, const SerializerInterface::Ptr &serializer) const
+{
+    switch (m_type) {
+    case AllCollections:
+        return true;
+    case SingleCollection:
+        return collection.id() == m_collection.id();
+    case SelectedCollections:
+        break;
+    }
+
+    return serializer->isSelectedCollection(collection);
+}
+
+void CollectionScope::rememberCollection(const Collection &collection, bool accepted) const
+{
+    if (accepted)
+        m_state->excludedIds.remove(collection.id());
+    else
+        m_state->excludedIds.insert(collection.id());
+}
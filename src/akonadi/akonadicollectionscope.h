@@ -0,0 +1,98 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef AKONADI_COLLECTIONSCOPE_H
+#define AKONADI_COLLECTIONSCOPE_H
+
+#include <functional>
+
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+
+#include <AkonadiCore/Collection>
+#include <AkonadiCore/Item>
+
+#include "akonadi/akonadiserializerinterface.h"
+#include "akonadi/akonadistorageinterface.h"
+
+namespace Akonadi {
+
+// Which collections a query fetches its items from and gets notified
+// about, copies share what they learnt about the collections
+class CollectionScope
+{
+public:
+    enum Type {
+        AllCollections = 0,
+        SelectedCollections,
+        SingleCollection
+    };
+
+    typedef std::function<void(const Item &)> AddFunction;
+    typedef std::function<void(const Item::List &, bool)> SelectionFunction;
+
+    explicit CollectionScope(Type type = AllCollections, const Collection &collection = Collection());
+
+    Type type() const;
+    Collection collection() const;
+
+    // Fetches the items of every collection of the scope having the given content types
+    void fetchItems(const StorageInterface::Ptr &storage,
+                    const SerializerInterface::Ptr &serializer,
+                    StorageInterface::FetchContentTypes types,
+                    const AddFunction &add) const;
+
+    // Notified items only know the id of their collection, so only the
+    // ones from collections known to be out of the scope are filtered out
+    bool mightContain(const Item &item) const;
+    // Items which might be in the scope, rejected gets the others
+    Item::List filter(const Item::List &items, Item::List *rejected = Q_NULLPTR) const;
+
+    // Fetches the items of a collection which got selected or deselected,
+    // apply is called with them unless a later change superseded it
+    void changeSelection(const Collection &collection,
+                         const StorageInterface::Ptr &storage,
+                         const SerializerInterface::Ptr &serializer,
+                         const SelectionFunction &apply) const;
+
+private:
+    // What was learnt about the collections, a cache which doesn't
+    // change what the scope is, hence mutable
+    struct State
+    {
+        QSet<Collection::Id> excludedIds;
+        QHash<Collection::Id, int> selectionChanges;
+    };
+
+    bool accepts(const Collection &collection, const SerializerInterface::Ptr &serializer) const;
+    void rememberCollection(const Collection &collection, bool accepted) const;
+
+    Type m_type;
+    Collection m_collection;
+    mutable QSharedPointer<State> m_state;
+};
+
+}
+
+#endif // AKONADI_COLLECTIONSCOPE_H
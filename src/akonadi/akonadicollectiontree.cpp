@@ -0,0 +1,323 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+
+#include "akonadicollectiontree.h"
+
+#include <algorithm>
+
+#include <QQueue>
+
+using namespace Akonadi;
+
+static QSet<QString> trigrams(const QString &text)
+{
+    QSet<QString> result;
+    for (int i = 0; i + 3 <= text.size(); i++)
+        result.insert(text.mid(i, 3));
+    return result;
+}
+
+CollectionTree::CollectionTree(const MonitorInterface::Ptr &monitor, ListFilter filter)
+    : m_monitor(monitor),
+      m_filter(filter),
+      m_populated(false)
+{
+    connect(m_monitor.data(), SIGNAL(collectionAdded(Akonadi::Collection)), this, SLOT(onCollectionAdded(Akonadi::Collection)));
+    connect(m_monitor.data(), SIGNAL(collectionRemoved(Akonadi::Collection)), this, SLOT(onCollectionRemoved(Akonadi::Collection)));
+    connect(m_monitor.data(), SIGNAL(collectionChanged(Akonadi::Collection)), this, SLOT(onCollectionChanged(Akonadi::Collection)));
+}
+
+bool CollectionTree::isPopulated() const
+{
+    return m_populated;
+}
+
+bool CollectionTree::waitForPopulation(const PopulatedFunction &callback)
+{
+    if (m_populated) {
+        callback(true);
+        return false;
+    }
+
+    m_pendingCallbacks << callback;
+    return m_pendingCallbacks.size() == 1;
+}
+
+void CollectionTree::setCollections(const Collection::List &collections)
+{
+    m_collections.clear();
+    m_parentIds.clear();
+    m_childIds.clear();
+    m_chains.clear();
+    m_nameTrigrams.clear();
+
+    foreach (const Collection &collection, collections)
+        insertCollection(collection);
+
+    m_populated = true;
+
+    const auto notifications = m_pendingNotifications;
+    m_pendingNotifications.clear();
+    foreach (const auto &notification, notifications) {
+        switch (notification.first) {
+        case CollectionAdded:
+            onCollectionAdded(notification.second);
+            break;
+        case CollectionRemoved:
+            onCollectionRemoved(notification.second);
+            break;
+        case CollectionChanged:
+            onCollectionChanged(notification.second);
+            break;
+        }
+    }
+
+    const auto callbacks = m_pendingCallbacks;
+    m_pendingCallbacks.clear();
+    foreach (const PopulatedFunction &callback, callbacks)
+        callback(true);
+}
+
+void CollectionTree::setPopulationFailed()
+{
+    m_pendingNotifications.clear();
+
+    const auto callbacks = m_pendingCallbacks;
+    m_pendingCallbacks.clear();
+    foreach (const PopulatedFunction &callback, callbacks)
+        callback(false);
+}
+
+Collection CollectionTree::collection(Collection::Id id) const
+{
+    if (id == Collection::root().id())
+        return Collection::root();
+
+    if (!m_collections.contains(id))
+        return Collection();
+
+    auto it = m_chains.constFind(id);
+    if (it != m_chains.constEnd())
+        return *it;
+
+    auto result = m_collections.value(id);
+    result.setParentCollection(collection(m_parentIds.value(id)));
+    m_chains.insert(id, result);
+    return result;
+}
+
+Collection::List CollectionTree::children(Collection::Id id) const
+{
+    Collection::List result;
+    foreach (Collection::Id childId, m_childIds.value(id))
+        result << collection(childId);
+    return result;
+}
+
+Collection::List CollectionTree::descendants(Collection::Id id) const
+{
+    Collection::List result;
+
+    // Depth first to keep parents right before their children
+    QList<Collection::Id> stack = m_childIds.value(id);
+    std::reverse(stack.begin(), stack.end());
+    while (!stack.isEmpty()) {
+        const auto childId = stack.takeLast();
+        result << collection(childId);
+
+        auto childIds = m_childIds.value(childId);
+        std::reverse(childIds.begin(), childIds.end());
+        stack << childIds;
+    }
+
+    return result;
+}
+
+Collection::List CollectionTree::search(const QString &term) const
+{
+    const QString foldedTerm = term.toCaseFolded();
+
+    QList<Collection::Id> candidates;
+    if (foldedTerm.size() < 3) {
+        candidates = m_collections.keys();
+    } else {
+        // Start from the rarest trigram to keep the intersections small
+        QList<QSet<Collection::Id>> sets;
+        foreach (const QString &trigram, trigrams(foldedTerm))
+            sets << m_nameTrigrams.value(trigram);
+        std::sort(sets.begin(), sets.end(),
+                  [] (const QSet<Collection::Id> &lhs, const QSet<Collection::Id> &rhs) {
+                      return lhs.size() < rhs.size();
+                  });
+
+        auto ids = sets.takeFirst();
+        foreach (const auto &set, sets) {
+            if (ids.isEmpty())
+                break;
+            ids.intersect(set);
+        }
+        candidates = ids.toList();
+    }
+
+    // Sorted to get a stable order between runs
+    std::sort(candidates.begin(), candidates.end());
+
+    Collection::List result;
+    foreach (Collection::Id id, candidates) {
+        // Sharing all the trigrams doesn't mean they're in the right order
+        if (m_collections.value(id).displayName().contains(term, Qt::CaseInsensitive))
+            result << collection(id);
+    }
+    return result;
+}
+
+void CollectionTree::onCollectionAdded(const Collection &collection)
+{
+    if (queueNotification(CollectionAdded, collection))
+        return;
+
+    if (!m_populated || !isListed(collection))
+        return;
+
+    insertCollection(collection);
+}
+
+void CollectionTree::onCollectionRemoved(const Collection &collection)
+{
+    if (queueNotification(CollectionRemoved, collection))
+        return;
+
+    removeCollection(collection.id());
+}
+
+void CollectionTree::onCollectionChanged(const Collection &collection)
+{
+    if (queueNotification(CollectionChanged, collection))
+        return;
+
+    if (!m_populated)
+        return;
+
+    // Hidden collections stay around only to hold their children
+    if (!isListed(collection) && m_childIds.value(collection.id()).isEmpty()) {
+        removeCollection(collection.id());
+        return;
+    }
+
+    invalidateChains(collection.id());
+    insertCollection(collection);
+}
+
+bool CollectionTree::queueNotification(Notification notification, const Collection &collection)
+{
+    // Nobody listing means the listing to come will be up to date
+    if (m_populated || m_pendingCallbacks.isEmpty())
+        return false;
+
+    m_pendingNotifications << qMakePair(notification, collection);
+    return true;
+}
+
+bool CollectionTree::isListed(const Collection &collection) const
+{
+    return m_filter == AllCollections
+        || collection.shouldList(Collection::ListDisplay)
+        || collection.referenced();
+}
+
+void CollectionTree::insertCollection(const Collection &collection)
+{
+    Q_ASSERT(collection.isValid());
+    const auto id = collection.id();
+    const auto parent = collection.parentCollection();
+
+    // Make sure we know the ancestors we got with it, unless it's a dummy
+    if (parent.isValid() && parent != Collection::root()
+     && parent.parentCollection().isValid() && !m_collections.contains(parent.id())) {
+        insertCollection(parent);
+    }
+
+    if (m_parentIds.contains(id) && m_parentIds.value(id) != parent.id())
+        m_childIds[m_parentIds.value(id)].removeAll(id);
+
+    if (!m_parentIds.contains(id) || m_parentIds.value(id) != parent.id())
+        m_childIds[parent.id()] << id;
+
+    if (m_collections.contains(id))
+        unindexName(id, m_collections.value(id).displayName());
+    indexName(id, collection.displayName());
+
+    auto stored = collection;
+    stored.setParentCollection(Collection(parent.id()));
+    m_collections.insert(id, stored);
+    m_parentIds.insert(id, parent.id());
+}
+
+void CollectionTree::removeCollection(Collection::Id id)
+{
+    if (!m_collections.contains(id))
+        return;
+
+    foreach (Collection::Id childId, m_childIds.value(id))
+        removeCollection(childId);
+
+    m_childIds.remove(id);
+    m_childIds[m_parentIds.value(id)].removeAll(id);
+    m_parentIds.remove(id);
+    unindexName(id, m_collections.take(id).displayName());
+    m_chains.remove(id);
+}
+
+void CollectionTree::invalidateChains(Collection::Id id)
+{
+    QQueue<Collection::Id> queue;
+    queue.enqueue(id);
+
+    while (!queue.isEmpty()) {
+        const auto current = queue.dequeue();
+        m_chains.remove(current);
+        foreach (Collection::Id childId, m_childIds.value(current))
+            queue.enqueue(childId);
+    }
+}
+
+void CollectionTree::indexName(Collection::Id id, const QString &name)
+{
+    foreach (const QString &trigram, trigrams(name.toCaseFolded()))
+        m_nameTrigrams[trigram].insert(id);
+}
+
+void CollectionTree::unindexName(Collection::Id id, const QString &name)
+{
+    foreach (const QString &trigram, trigrams(name.toCaseFolded())) {
+        auto it = m_nameTrigrams.find(trigram);
+        if (it == m_nameTrigrams.end())
+            continue;
+
+        it->remove(id);
+        if (it->isEmpty())
+            m_nameTrigrams.erase(it);
+    }
+}
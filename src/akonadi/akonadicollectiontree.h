@@ -0,0 +1,116 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#ifndef AKONADI_COLLECTIONTREE_H
+#define AKONADI_COLLECTIONTREE_H
+
+#include <functional>
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QSharedPointer>
+
+#include <AkonadiCore/Collection>
+
+#include "akonadi/akonadimonitorinterface.h"
+
+namespace Akonadi {
+
+// Collections known below the root collection, listed once and then kept
+// up to date from the monitor notifications. The ancestor chains handed
+// out are built only once per collection.
+class CollectionTree : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<CollectionTree> Ptr;
+    typedef std::function<void(bool)> PopulatedFunction;
+
+    enum ListFilter {
+        DisplayedCollections = 0,
+        AllCollections
+    };
+
+    explicit CollectionTree(const MonitorInterface::Ptr &monitor,
+                            ListFilter filter = DisplayedCollections);
+
+    bool isPopulated() const;
+
+    // Registers a callback called with the outcome of the population (immediately
+    // if the tree is already populated), returns true if the caller
+    // is the first one waiting and thus has to provide the listing
+    bool waitForPopulation(const PopulatedFunction &callback);
+    void setCollections(const Collection::List &collections);
+    void setPopulationFailed();
+
+    // With their full ancestor chain
+    Collection collection(Collection::Id id) const;
+    Collection::List children(Collection::Id id) const;
+    Collection::List descendants(Collection::Id id) const;
+    // Collections with a display name containing term, ignoring case
+    Collection::List search(const QString &term) const;
+
+private slots:
+    void onCollectionAdded(const Akonadi::Collection &collection);
+    void onCollectionRemoved(const Akonadi::Collection &collection);
+    void onCollectionChanged(const Akonadi::Collection &collection);
+
+private:
+    enum Notification {
+        CollectionAdded,
+        CollectionRemoved,
+        CollectionChanged
+    };
+
+    // Whether a notification arrived while the first listing runs, it
+    // then gets applied on top of the listing
+    bool queueNotification(Notification notification, const Collection &collection);
+    bool isListed(const Collection &collection) const;
+    void insertCollection(const Collection &collection);
+    void removeCollection(Collection::Id id);
+    void invalidateChains(Collection::Id id);
+    void indexName(Collection::Id id, const QString &name);
+    void unindexName(Collection::Id id, const QString &name);
+
+    MonitorInterface::Ptr m_monitor;
+    ListFilter m_filter;
+
+    bool m_populated;
+    QList<PopulatedFunction> m_pendingCallbacks;
+    QList<QPair<Notification, Collection>> m_pendingNotifications;
+
+    QHash<Collection::Id, Collection> m_collections;
+    QHash<Collection::Id, Collection::Id> m_parentIds;
+    QHash<Collection::Id, QList<Collection::Id>> m_childIds;
+    mutable QHash<Collection::Id, Collection> m_chains;
+
+    // Trigrams of the case folded display names
+    QHash<QString, QSet<Collection::Id>> m_nameTrigrams;
+};
+
+}
+
+#endif // AKONADI_COLLECTIONTREE_H
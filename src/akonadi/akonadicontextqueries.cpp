@@ -26,9 +26,10 @@
 
 #include "akonadicollectionfetchjobinterface.h"
 #include "akonadiitemfetchjobinterface.h"
+#include "akonadiqueryscheduler.h"
 #include "akonaditagfetchjobinterface.h"
 
-#include "utils/jobhandler.h"
+#include "utils/jobcontinuation.h"
 #include <QByteArray>
 #include <QDebug>
 
@@ -36,18 +37,29 @@ using namespace Akonadi;
 
 ContextQueries::ContextQueries(const StorageInterface::Ptr &storage,
                                const SerializerInterface::Ptr &serializer,
-                               const MonitorInterface::Ptr &monitor)
+                               const MonitorInterface::Ptr &monitor,
+                               const TagIndex::Ptr &tagIndex)
     : m_storage(storage),
       m_serializer(serializer),
-      m_monitor(monitor)
+      m_monitor(monitor),
+      m_tagIndex(tagIndex)
 {
+    QueryScheduler::install();
+
+    // Task queries are keyed by tag id
+    m_taskRouter = TaskRouter::Ptr::create([] (const Akonadi::Item &item, QStringList &keys) {
+        foreach (const Akonadi::Tag &tag, item.tags())
+            keys << QString::number(tag.id());
+        return true;
+    });
+
     connect(m_monitor.data(), SIGNAL(tagAdded(Akonadi::Tag)), this, SLOT(onTagAdded(Akonadi::Tag)));
     connect(m_monitor.data(), SIGNAL(tagRemoved(Akonadi::Tag)), this, SLOT(onTagRemoved(Akonadi::Tag)));
     connect(m_monitor.data(), SIGNAL(tagChanged(Akonadi::Tag)), this, SLOT(onTagChanged(Akonadi::Tag)));
 
-    connect(m_monitor.data(), SIGNAL(itemAdded(Akonadi::Item)), this, SLOT(onItemAdded(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemRemoved(Akonadi::Item)), this, SLOT(onItemRemoved(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemChanged(Akonadi::Item)), this, SLOT(onItemChanged(Akonadi::Item)));
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
 }
 
 ContextQueries::ContextResult::Ptr ContextQueries::findAll() const
@@ -56,11 +68,12 @@ ContextQueries::ContextResult::Ptr ContextQueries::findAll() const
         {
             ContextQueries *self = const_cast<ContextQueries*>(this);
             self->m_findAll = self->createContextQuery();
+            self->m_findAll->setDebugName(QStringLiteral("ContextQueries::findAll"));
         }
 
         m_findAll->setFetchFunction([this] (const ContextQuery::AddFunction &add) {
             TagFetchJobInterface *job = m_storage->fetchTags();
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
+            Utils::JobContinuation::whenDone(job->kjob(), [job, add] (KJob *) {
                 for (Akonadi::Tag tag : job->tags())
                     add(tag);
             });
@@ -92,20 +105,39 @@ ContextQueries::TaskResult::Ptr ContextQueries::findTopLevelTasks(Domain::Contex
 
         {
             ContextQueries *self = const_cast<ContextQueries*>(this);
-            query = self->createTaskQuery();
+            query = self->createTaskQuery(tag.id());
+            query->setDebugName(QStringLiteral("ContextQueries::findTopLevelTasks"));
             self->m_findToplevel.insert(tag.id(), query);
         }
 
-        query->setFetchFunction([this, tag] (const TaskQuery::AddFunction &add) {
-            ItemFetchJobInterface *job = m_storage->fetchTagItems(tag);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
-                    return;
-
-                for (auto item : job->items())
-                    add(item);
-            });
-
+        query->setFetchFunction([this, tag] (const TaskQuery::AddFunction &queryAdd) {
+            auto add = m_taskRouter->trackedAdd(QString::number(tag.id()), queryAdd);
+
+            auto storage = m_storage;
+            auto fetchTagItems = [storage, tag, add] {
+                ItemFetchJobInterface *job = storage->fetchTagItems(tag);
+                job->streamItems([add] (const Akonadi::Item::List &items) {
+                    for (auto item : items)
+                        add(item);
+                });
+            };
+
+            if (m_tagIndex) {
+                // Might be populated after we're gone, so only what's needed is captured
+                auto tagIndex = m_tagIndex;
+                tagIndex->populate([tagIndex, tag, add, fetchTagItems] (bool populated) {
+                    if (!populated) {
+                        fetchTagItems();
+                        return;
+                    }
+
+                    for (auto item : tagIndex->taggedItems(tag.id()))
+                        add(item);
+                });
+                return;
+            }
+
+            fetchTagItems();
         });
         query->setConvertFunction([this] (const Akonadi::Item &item) {
             return m_serializer->createTaskFromItem(item);
@@ -119,6 +151,7 @@ ContextQueries::TaskResult::Ptr ContextQueries::findTopLevelTasks(Domain::Contex
         query->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Task::Ptr &task) {
             return m_serializer->representsItem(task, item);
         });
+        query->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findToplevel.value(tag.id())->result();
@@ -142,22 +175,19 @@ void ContextQueries::onTagChanged(const Tag &tag)
         query->onChanged(tag);
 }
 
-void ContextQueries::onItemAdded(const Item &item)
+void ContextQueries::onItemsAdded(const Item::List &items)
 {
-    foreach (const TaskQuery::Ptr &query, m_taskQueries)
-        query->onAdded(item);
+    m_taskRouter->onAdded(items);
 }
 
-void ContextQueries::onItemRemoved(const Item &item)
+void ContextQueries::onItemsRemoved(const Item::List &items)
 {
-    foreach (const TaskQuery::Ptr &query, m_taskQueries)
-        query->onRemoved(item);
+    m_taskRouter->onRemoved(items);
 }
 
-void ContextQueries::onItemChanged(const Item &item)
+void ContextQueries::onItemsChanged(const Item::List &items)
 {
-    foreach (const TaskQuery::Ptr &query, m_taskQueries)
-        query->onChanged(item);
+    m_taskRouter->onChanged(items);
 }
 
 ContextQueries::ContextQuery::Ptr ContextQueries::createContextQuery()
@@ -167,9 +197,9 @@ ContextQueries::ContextQuery::Ptr ContextQueries::createContextQuery()
     return query;
 }
 
-ContextQueries::TaskQuery::Ptr ContextQueries::createTaskQuery()
+ContextQueries::TaskQuery::Ptr ContextQueries::createTaskQuery(Akonadi::Tag::Id tagId)
 {
     auto query = TaskQuery::Ptr::create();
-    m_taskQueries << query;
+    m_taskRouter->addQuery(QString::number(tagId), query);
     return query;
 }
@@ -30,8 +30,10 @@
 #include <AkonadiCore/Item>
 
 #include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadiqueryrouter.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
+#include "akonadi/akonaditagindex.h"
 
 #include "domain/livequery.h"
 
@@ -46,6 +48,7 @@ public:
     typedef Domain::LiveQuery<Akonadi::Item, Domain::Task::Ptr> TaskQuery;
     typedef Domain::QueryResult<Domain::Task::Ptr> TaskResult;
     typedef Domain::QueryResultProvider<Domain::Task::Ptr> TaskProvider;
+    typedef QueryRouter<TaskQuery> TaskRouter;
 
     typedef Domain::LiveQuery<Akonadi::Tag, Domain::Context::Ptr> ContextQuery;
     typedef Domain::QueryResult<Domain::Context::Ptr> ContextResult;
@@ -53,7 +56,8 @@ public:
 
     ContextQueries(const StorageInterface::Ptr &storage,
                    const SerializerInterface::Ptr &serializer,
-                   const MonitorInterface::Ptr &monitor);
+                   const MonitorInterface::Ptr &monitor,
+                   const TagIndex::Ptr &tagIndex = TagIndex::Ptr());
 
 
     ContextResult::Ptr findAll() const Q_DECL_OVERRIDE;
@@ -64,23 +68,24 @@ private slots:
     void onTagRemoved(const Akonadi::Tag &tag);
     void onTagChanged(const Akonadi::Tag &tag);
 
-    void onItemAdded(const Akonadi::Item &item);
-    void onItemRemoved(const Akonadi::Item &item);
-    void onItemChanged(const Akonadi::Item &item);
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
 
 private:
     ContextQuery::Ptr createContextQuery();
-    TaskQuery::Ptr createTaskQuery();
+    TaskQuery::Ptr createTaskQuery(Akonadi::Tag::Id tagId);
 
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
     MonitorInterface::Ptr m_monitor;
+    TagIndex::Ptr m_tagIndex;
 
     ContextQuery::Ptr m_findAll;
     ContextQuery::List m_contextQueries;
 
     QHash<Akonadi::Tag::Id, TaskQuery::Ptr> m_findToplevel;
-    TaskQuery::List m_taskQueries;
+    TaskRouter::Ptr m_taskRouter;
 };
 
 } // akonadi namespace
@@ -27,6 +27,7 @@
 #include "akonadicollectionfetchjobinterface.h"
 #include "akonadicollectionsearchjobinterface.h"
 #include "akonadiitemfetchjobinterface.h"
+#include "akonadiqueryscheduler.h"
 
 #include "utils/jobhandler.h"
 
@@ -39,6 +40,8 @@ DataSourceQueries::DataSourceQueries(const StorageInterface::Ptr &storage,
       m_serializer(serializer),
       m_monitor(monitor)
 {
+    QueryScheduler::install();
+
     connect(m_monitor.data(), SIGNAL(collectionAdded(Akonadi::Collection)), this, SLOT(onCollectionAdded(Akonadi::Collection)));
     connect(m_monitor.data(), SIGNAL(collectionRemoved(Akonadi::Collection)), this, SLOT(onCollectionRemoved(Akonadi::Collection)));
     connect(m_monitor.data(), SIGNAL(collectionChanged(Akonadi::Collection)), this, SLOT(onCollectionChanged(Akonadi::Collection)));
@@ -50,6 +53,7 @@ DataSourceQueries::DataSourceResult::Ptr DataSourceQueries::findTasks() const
         {
             DataSourceQueries *self = const_cast<DataSourceQueries*>(this);
             self->m_findTasks = self->createDataSourceQuery();
+            self->m_findTasks->setDebugName(QStringLiteral("DataSourceQueries::findTasks"));
         }
 
         m_findTasks->setFetchFunction([this] (const DataSourceQuery::AddFunction &add) {
@@ -83,6 +87,7 @@ DataSourceQueries::DataSourceResult::Ptr DataSourceQueries::findNotes() const
         {
             DataSourceQueries *self = const_cast<DataSourceQueries*>(this);
             self->m_findNotes = self->createDataSourceQuery();
+            self->m_findNotes->setDebugName(QStringLiteral("DataSourceQueries::findNotes"));
         }
 
         m_findNotes->setFetchFunction([this] (const DataSourceQuery::AddFunction &add) {
@@ -116,6 +121,7 @@ DataSourceQueries::DataSourceResult::Ptr DataSourceQueries::findTopLevel() const
         {
             DataSourceQueries *self = const_cast<DataSourceQueries*>(this);
             self->m_findTopLevel = self->createDataSourceQuery();
+            self->m_findTopLevel->setDebugName(QStringLiteral("DataSourceQueries::findTopLevel"));
         }
 
         m_findTopLevel->setFetchFunction([this] (const DataSourceQuery::AddFunction &add) {
@@ -168,6 +174,7 @@ DataSourceQueries::DataSourceResult::Ptr DataSourceQueries::findChildren(Domain:
         {
             DataSourceQueries *self = const_cast<DataSourceQueries*>(this);
             query = self->createDataSourceQuery();
+            query->setDebugName(QStringLiteral("DataSourceQueries::findChildren"));
             self->m_findChildren.insert(root.id(), query);
         }
 
@@ -236,6 +243,7 @@ DataSourceQueries::DataSourceResult::Ptr DataSourceQueries::findSearchTopLevel()
         {
             DataSourceQueries *self = const_cast<DataSourceQueries*>(this);
             self->m_findSearchTopLevel = self->createDataSourceQuery();
+            self->m_findSearchTopLevel->setDebugName(QStringLiteral("DataSourceQueries::findSearchTopLevel"));
         }
 
         m_findSearchTopLevel->setFetchFunction([this] (const DataSourceQuery::AddFunction &add) {
@@ -289,6 +297,7 @@ DataSourceQueries::DataSourceResult::Ptr DataSourceQueries::findSearchChildren(D
         {
             DataSourceQueries *self = const_cast<DataSourceQueries*>(this);
             query = self->createDataSourceQuery();
+            query->setDebugName(QStringLiteral("DataSourceQueries::findSearchChildren"));
             self->m_findSearchChildren.insert(root.id(), query);
         }
 
@@ -0,0 +1,230 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#include "akonadiitemcache.h"
+
+#include <AkonadiCore/CollectionStatistics>
+
+using namespace Akonadi;
+
+ItemCache::ItemCache(const MonitorInterface::Ptr &monitor)
+    : m_monitor(monitor)
+{
+    connect(m_monitor.data(), SIGNAL(collectionRemoved(Akonadi::Collection)), this, SLOT(onCollectionRemoved(Akonadi::Collection)));
+    connect(m_monitor.data(), SIGNAL(collectionStatisticsChanged(Akonadi::Collection)), this, SLOT(onCollectionStatisticsChanged(Akonadi::Collection)));
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsStored(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsStored(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsMoved(Akonadi::Item::List)), this, SLOT(onItemsStored(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRevisionChanged(Akonadi::Item::List)), this, SLOT(onItemsRevisionChanged(Akonadi::Item::List)));
+}
+
+bool ItemCache::isCached(Collection::Id id) const
+{
+    return m_entries.contains(id);
+}
+
+bool ItemCache::isStale(Collection::Id id) const
+{
+    return m_entries.value(id).stale;
+}
+
+Item::List ItemCache::items(Collection::Id id) const
+{
+    return m_entries.value(id).items.values();
+}
+
+Item::List ItemCache::outdatedItems(Collection::Id id, const Item::List &listedItems) const
+{
+    const auto &items = m_entries.value(id).items;
+
+    Item::List result;
+    foreach (const Item &listedItem, listedItems) {
+        auto it = items.constFind(listedItem.id());
+        if (it == items.constEnd() || it->revision() != listedItem.revision())
+            result << listedItem;
+    }
+    return result;
+}
+
+void ItemCache::beginFetch(Collection::Id id)
+{
+    m_fetches.insert(id, false);
+}
+
+bool ItemCache::isFetching(Collection::Id id) const
+{
+    return m_fetches.contains(id);
+}
+
+void ItemCache::waitForFetch(Collection::Id id, const FetchedFunction &callback)
+{
+    Q_ASSERT(isFetching(id));
+    m_fetchWaiters[id] << callback;
+}
+
+void ItemCache::cancelFetch(Collection::Id id)
+{
+    m_fetches.remove(id);
+    notifyFetchWaiters(id, false);
+}
+
+void ItemCache::setItems(Collection::Id id, const Item::List &items)
+{
+    if (m_entries.contains(id)) {
+        foreach (const Item::Id itemId, m_entries.value(id).items.keys())
+            m_itemCollections.remove(itemId);
+    }
+
+    Entry entry;
+    foreach (const Item &item, items) {
+        entry.items.insert(item.id(), item);
+        m_itemCollections.insert(item.id(), id);
+    }
+    entry.stale = m_fetches.take(id);
+    m_entries.insert(id, entry);
+
+    notifyFetchWaiters(id, true);
+}
+
+void ItemCache::updateItems(Collection::Id id, const Item::List &listedItems, const Item::List &fetchedItems)
+{
+    const auto &cachedItems = m_entries.value(id).items;
+
+    QHash<Item::Id, Item> fetchedMap;
+    foreach (const Item &item, fetchedItems)
+        fetchedMap.insert(item.id(), item);
+
+    Item::List items;
+    items.reserve(listedItems.size());
+    foreach (const Item &listedItem, listedItems) {
+        const auto itemId = listedItem.id();
+        if (fetchedMap.contains(itemId))
+            items << fetchedMap.value(itemId);
+        else if (cachedItems.contains(itemId))
+            items << cachedItems.value(itemId);
+    }
+
+    setItems(id, items);
+}
+
+void ItemCache::onCollectionRemoved(const Collection &collection)
+{
+    const auto id = collection.id();
+    markFetchDirty(id);
+
+    if (!m_entries.contains(id))
+        return;
+
+    foreach (const Item::Id itemId, m_entries.value(id).items.keys())
+        m_itemCollections.remove(itemId);
+    m_entries.remove(id);
+}
+
+void ItemCache::onCollectionStatisticsChanged(const Collection &collection)
+{
+    auto it = m_entries.find(collection.id());
+    if (it == m_entries.end())
+        return;
+
+    // The item notifications might still be on their way, in which case
+    // checking the revisions will be cheap anyway
+    const auto count = collection.statistics().count();
+    if (count >= 0 && count != it->items.size())
+        it->stale = true;
+}
+
+void ItemCache::storeItem(const Item &item)
+{
+    const auto collectionId = item.parentCollection().id();
+
+    // Might come from another collection
+    if (m_itemCollections.value(item.id(), collectionId) != collectionId) {
+        markFetchDirty(m_itemCollections.value(item.id()));
+        dropItem(item.id());
+    }
+
+    markFetchDirty(collectionId);
+
+    auto it = m_entries.find(collectionId);
+    if (it == m_entries.end())
+        return;
+
+    it->items.insert(item.id(), item);
+    m_itemCollections.insert(item.id(), collectionId);
+}
+
+void ItemCache::onItemsStored(const Item::List &items)
+{
+    foreach (const Item &item, items)
+        storeItem(item);
+}
+
+void ItemCache::onItemsRevisionChanged(const Item::List &items)
+{
+    foreach (const Item &item, items) {
+        if (!m_itemCollections.contains(item.id()))
+            continue;
+
+        const auto collectionId = m_itemCollections.value(item.id());
+        markFetchDirty(collectionId);
+
+        auto it = m_entries.find(collectionId);
+        if (it != m_entries.end())
+            it->items[item.id()].setRevision(item.revision());
+    }
+}
+
+void ItemCache::onItemsRemoved(const Item::List &items)
+{
+    foreach (const Item &item, items) {
+        markFetchDirty(m_itemCollections.value(item.id(), item.parentCollection().id()));
+        dropItem(item.id());
+    }
+}
+
+void ItemCache::markFetchDirty(Collection::Id id)
+{
+    auto it = m_fetches.find(id);
+    if (it != m_fetches.end())
+        *it = true;
+}
+
+void ItemCache::notifyFetchWaiters(Collection::Id id, bool success)
+{
+    const auto callbacks = m_fetchWaiters.take(id);
+    foreach (const FetchedFunction &callback, callbacks)
+        callback(success);
+}
+
+void ItemCache::dropItem(Item::Id id)
+{
+    if (!m_itemCollections.contains(id))
+        return;
+
+    const auto collectionId = m_itemCollections.take(id);
+    auto it = m_entries.find(collectionId);
+    if (it != m_entries.end())
+        it->items.remove(id);
+}
@@ -0,0 +1,108 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef AKONADI_ITEMCACHE_H
+#define AKONADI_ITEMCACHE_H
+
+#include <functional>
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QSharedPointer>
+
+#include <AkonadiCore/Collection>
+#include <AkonadiCore/Item>
+
+#include "akonadi/akonadimonitorinterface.h"
+
+namespace Akonadi {
+
+// Items of the collections fetched so far, kept up to date from the
+// monitor notifications. A collection which statistics don't match what
+// we know anymore is stale, the revisions of its items need to be checked
+// against the server before trusting it again.
+class ItemCache : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<ItemCache> Ptr;
+    typedef std::function<void(bool)> FetchedFunction;
+
+    explicit ItemCache(const MonitorInterface::Ptr &monitor);
+
+    bool isCached(Collection::Id id) const;
+    bool isStale(Collection::Id id) const;
+    // Ordered by id, so that they come in the same order on each run
+    Item::List items(Collection::Id id) const;
+
+    // Items listed with their revision only which aren't known in
+    // this revision, those are the ones to fetch again
+    Item::List outdatedItems(Collection::Id id, const Item::List &listedItems) const;
+
+    // Notifications received between the beginning of a fetch and
+    // the items being set leave the collection stale
+    void beginFetch(Collection::Id id);
+    bool isFetching(Collection::Id id) const;
+    // Registers a callback called with the outcome of the running fetch
+    // of the collection, once its items are set or the fetch is canceled
+    void waitForFetch(Collection::Id id, const FetchedFunction &callback);
+    void cancelFetch(Collection::Id id);
+    void setItems(Collection::Id id, const Item::List &items);
+    // Replaces the outdated items with their fetched version and drops
+    // the ones which aren't listed anymore
+    void updateItems(Collection::Id id, const Item::List &listedItems, const Item::List &fetchedItems);
+
+private slots:
+    void onCollectionRemoved(const Akonadi::Collection &collection);
+    void onCollectionStatisticsChanged(const Akonadi::Collection &collection);
+    void onItemsStored(const Akonadi::Item::List &items);
+    void onItemsRevisionChanged(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+
+private:
+    struct Entry
+    {
+        Entry() : stale(false) {}
+
+        QMap<Item::Id, Item> items;
+        bool stale;
+    };
+
+    void storeItem(const Item &item);
+    void markFetchDirty(Collection::Id id);
+    void notifyFetchWaiters(Collection::Id id, bool success);
+    void dropItem(Item::Id id);
+
+    MonitorInterface::Ptr m_monitor;
+
+    QHash<Collection::Id, Entry> m_entries;
+    QHash<Item::Id, Collection::Id> m_itemCollections;
+    // Collections being fetched, true if they got notified meanwhile
+    QHash<Collection::Id, bool> m_fetches;
+    QHash<Collection::Id, QList<FetchedFunction>> m_fetchWaiters;
+};
+
+}
+
+#endif // AKONADI_ITEMCACHE_H
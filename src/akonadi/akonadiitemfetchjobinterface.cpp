@@ -25,6 +25,7 @@
 #include "akonadiitemfetchjobinterface.h"
 
 #include <KJob>
+#include <QSharedPointer>
 
 using namespace Akonadi;
 
@@ -42,3 +43,20 @@ KJob *ItemFetchJobInterface::kjob()
     Q_ASSERT(job);
     return job;
 }
+
+void ItemFetchJobInterface::streamItems(const ItemsHandler &handler,
+                                        const Utils::JobHandler::ResultHandler &resultHandler)
+{
+    // Only JobHandler holds on to handler, abandoning the job drops it
+    auto sharedHandler = QSharedPointer<ItemsHandler>::create(handler);
+    QWeakPointer<ItemsHandler> weakHandler = sharedHandler;
+    setItemsHandler([weakHandler] (const Item::List &items) {
+        if (auto handler = weakHandler.toStrongRef())
+            (*handler)(items);
+    });
+
+    Utils::JobHandler::install(kjob(), [sharedHandler, resultHandler] {
+        if (resultHandler)
+            resultHandler();
+    });
+}
@@ -24,8 +24,12 @@
 #ifndef AKONADI_ITEMFETCHJOBINTERFACE_H
 #define AKONADI_ITEMFETCHJOBINTERFACE_H
 
+#include <functional>
+
 #include <AkonadiCore/Item>
 
+#include "utils/jobhandler.h"
+
 class KJob;
 
 namespace Akonadi {
@@ -33,12 +37,27 @@ namespace Akonadi {
 class ItemFetchJobInterface
 {
 public:
+    typedef std::function<void(const Item::List &)> ItemsHandler;
+
     ItemFetchJobInterface();
     virtual ~ItemFetchJobInterface();
 
     KJob *kjob();
 
     virtual Item::List items() const = 0;
+
+    // Once a handler is set the items are delivered in batches
+    // while they arrive and items() is not filled anymore. Batches
+    // delivered before an error are not taken back, receivers keep
+    // what they got so far instead of getting nothing at all
+    virtual void setItemsHandler(const ItemsHandler &handler) = 0;
+
+    // For fetches only interested in the items: sets handler and starts
+    // the job through Utils::JobHandler, so it is abandoned along with
+    // its owner and the batches still arriving after that are dropped.
+    // Errors only cut the fetch short, unless resultHandler checks them
+    void streamItems(const ItemsHandler &handler,
+                     const Utils::JobHandler::ResultHandler &resultHandler = Utils::JobHandler::ResultHandler());
 };
 
 }
@@ -0,0 +1,129 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#include "akonadiitemfetchworker.h"
+
+#include <QThread>
+
+#include <AkonadiCore/ItemFetchJob>
+#include <AkonadiCore/Session>
+
+using namespace Akonadi;
+
+int ItemFetchWorker::batchSize()
+{
+    return 50;
+}
+
+ItemFetchWorker::ItemFetchWorker(const ItemFetchScope &scope)
+    : m_thread(new QThread),
+      m_session(Q_NULLPTR),
+      m_scope(scope),
+      m_nextRequestId(0),
+      m_dispatcher(new QObject)
+{
+    qRegisterMetaType<Akonadi::Collection>();
+    qRegisterMetaType<Akonadi::Item::List>();
+
+    // Queued to the dispatcher thread, one lookup per batch whatever the
+    // number of fetches going on
+    connect(this, &ItemFetchWorker::itemsFetched,
+            m_dispatcher, [this] (int requestId, const Akonadi::Item::List &items) {
+        if (!m_requests.contains(requestId))
+            return;
+
+        // Might cancel the request, so not called from the hash
+        const auto itemsFunction = m_requests.value(requestId).first;
+        itemsFunction(items);
+    });
+    connect(this, &ItemFetchWorker::fetchDone,
+            m_dispatcher, [this] (int requestId, int error, const QString &errorText) {
+        if (!m_requests.contains(requestId))
+            return;
+
+        const auto done = m_requests.take(requestId).second;
+        done(error, errorText);
+    });
+
+    m_thread->setObjectName(QStringLiteral("ItemFetchWorker"));
+    moveToThread(m_thread);
+    m_thread->start();
+}
+
+ItemFetchWorker::~ItemFetchWorker()
+{
+    // The session belongs to the worker thread, it has to go from there
+    QMetaObject::invokeMethod(this, "shutdown", Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    delete m_dispatcher;
+}
+
+int ItemFetchWorker::fetchItems(const Collection &collection, const ItemsFunction &items, const DoneFunction &done)
+{
+    Q_ASSERT(QThread::currentThread() == m_dispatcher->thread());
+    Q_ASSERT(items);
+    Q_ASSERT(done);
+
+    const int requestId = m_nextRequestId++;
+    m_requests.insert(requestId, qMakePair(items, done));
+    QMetaObject::invokeMethod(this, "onFetchRequested", Qt::QueuedConnection,
+                              Q_ARG(int, requestId),
+                              Q_ARG(Akonadi::Collection, collection));
+    return requestId;
+}
+
+void ItemFetchWorker::cancel(int requestId)
+{
+    Q_ASSERT(QThread::currentThread() == m_dispatcher->thread());
+    m_requests.remove(requestId);
+}
+
+void ItemFetchWorker::onFetchRequested(int requestId, const Collection &collection)
+{
+    Q_ASSERT(QThread::currentThread() == m_thread);
+
+    if (!m_session)
+        m_session = new Session(QByteArrayLiteral("zanshin-itemfetchworker"), this);
+
+    auto job = new ItemFetchJob(collection, m_session);
+    job->setFetchScope(m_scope);
+    job->setDeliveryOption(ItemFetchJob::EmitItemsInBatches);
+
+    connect(job, &ItemFetchJob::itemsReceived, this, [this, requestId] (const Akonadi::Item::List &items) {
+        const int size = batchSize();
+        for (int i = 0; i < items.size(); i += size)
+            emit itemsFetched(requestId, items.mid(i, size));
+    });
+    connect(job, &KJob::result, this, [this, requestId, job] {
+        emit fetchDone(requestId, job->error(), job->errorText());
+    });
+}
+
+void ItemFetchWorker::shutdown()
+{
+    delete m_session;
+    m_session = Q_NULLPTR;
+}
@@ -0,0 +1,89 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef AKONADI_ITEMFETCHWORKER_H
+#define AKONADI_ITEMFETCHWORKER_H
+
+#include <functional>
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QSharedPointer>
+
+#include <AkonadiCore/Collection>
+#include <AkonadiCore/Item>
+#include <AkonadiCore/ItemFetchScope>
+
+class QThread;
+
+namespace Akonadi {
+
+class Session;
+
+// Runs item fetches on its own thread with its own session, the items
+// get decoded there and are handed back in batches of bounded size so
+// that the GUI thread only deals with a few of them at a time. Needs the
+// LockedSerializerPlugin installed, the GUI thread deals with payloads too.
+class ItemFetchWorker : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<ItemFetchWorker> Ptr;
+    typedef std::function<void(const Item::List &)> ItemsFunction;
+    typedef std::function<void(int error, const QString &errorText)> DoneFunction;
+
+    static int batchSize();
+
+    explicit ItemFetchWorker(const ItemFetchScope &scope);
+    ~ItemFetchWorker();
+
+    // To be called from the thread which created the worker, the functions
+    // get called there until the fetch is done or canceled
+    int fetchItems(const Collection &collection, const ItemsFunction &items, const DoneFunction &done);
+    // The fetch carries on, its results just go nowhere
+    void cancel(int requestId);
+
+signals:
+    // Emitted from the worker thread, only meant for the dispatch
+    void itemsFetched(int requestId, const Akonadi::Item::List &items);
+    void fetchDone(int requestId, int error, const QString &errorText);
+
+private slots:
+    void onFetchRequested(int requestId, const Akonadi::Collection &collection);
+    void shutdown();
+
+private:
+    QThread *m_thread;
+    Session *m_session;
+    const ItemFetchScope m_scope;
+    int m_nextRequestId;
+
+    // Lives on the thread which created us, as do the requests
+    QObject *m_dispatcher;
+    QHash<int, QPair<ItemsFunction, DoneFunction>> m_requests;
+};
+
+}
+
+#endif // AKONADI_ITEMFETCHWORKER_H
@@ -0,0 +1,266 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#include "akonadiitemwritequeue.h"
+
+#include <QEventLoop>
+#include <QTimer>
+
+#include <KJob>
+
+#include "akonadiitemfetchjobinterface.h"
+
+#include "utils/jobhandler.h"
+#include "utils/paralleljob.h"
+
+namespace Akonadi {
+
+// Stands for a write in the queue, finished by the queue itself
+class ItemWriteJob : public KJob
+{
+public:
+    void start() Q_DECL_OVERRIDE
+    {
+    }
+
+    void finish(int error, const QString &errorText)
+    {
+        if (error != KJob::NoError) {
+            setError(error);
+            setErrorText(errorText);
+        }
+        emitResult();
+    }
+};
+
+}
+
+using namespace Akonadi;
+
+int ItemWriteQueue::flushDelay()
+{
+    return 250;
+}
+
+ItemWriteQueue::ItemWriteQueue(const StorageInterface::Ptr &storage,
+                               const MonitorInterface::Ptr &monitor)
+    : m_storage(storage),
+      m_monitor(monitor),
+      m_flushTimer(new QTimer(this)),
+      m_drainLoop(Q_NULLPTR)
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(flushDelay());
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+ItemWriteQueue::~ItemWriteQueue()
+{
+    // The editor saves its last edits through us on its way out, they
+    // and the writes still in flight have to be done before we go
+    m_flushTimer->setInterval(0);
+    flush();
+    if (m_entries.isEmpty())
+        return;
+
+    QEventLoop loop;
+    m_drainLoop = &loop;
+    loop.exec();
+    m_drainLoop = Q_NULLPTR;
+}
+
+KJob *ItemWriteQueue::updateItem(const Item &item)
+{
+    Q_ASSERT(item.isValid());
+
+    auto job = new ItemWriteJob;
+    auto &entry = m_entries[item.id()];
+
+    // Only the latest version of the item is worth writing
+    entry.pendingItem = item;
+    entry.pendingJobs << job;
+
+    if (!entry.inFlight && !m_flushTimer->isActive())
+        m_flushTimer->start();
+
+    return job;
+}
+
+KJob *ItemWriteQueue::flushItems(const Item::List &items)
+{
+    Utils::ParallelJob *writeJobs = Q_NULLPTR;
+    bool flushNeeded = false;
+
+    foreach (const auto &item, items) {
+        if (!m_entries.contains(item.id()))
+            continue;
+
+        // Done along the latest write of the item
+        auto job = new ItemWriteJob;
+        auto &entry = m_entries[item.id()];
+        if (entry.pendingItem.isValid()) {
+            entry.pendingJobs << job;
+            flushNeeded = flushNeeded || !entry.inFlight;
+        } else {
+            entry.inFlightJobs << job;
+        }
+
+        if (!writeJobs)
+            writeJobs = new Utils::ParallelJob;
+        writeJobs->addSubjob(job);
+    }
+
+    if (flushNeeded)
+        flush();
+
+    return writeJobs;
+}
+
+void ItemWriteQueue::flush()
+{
+    m_flushTimer->stop();
+
+    KJob *transaction = Q_NULLPTR;
+    auto state = FlushPtr::create();
+    QPointer<ItemWriteQueue> self(this);
+
+    // The transaction reports after its writes with Akonadi, but we only
+    // rely on getting all the results
+    auto onResult = [self, state] {
+        if (--state->pendingResults == 0 && self)
+            self->onFlushDone(state);
+    };
+
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        auto &entry = it.value();
+        if (entry.inFlight || !entry.pendingItem.isValid())
+            continue;
+
+        if (!transaction) {
+            transaction = m_storage->createTransaction();
+            state->pendingResults++;
+        }
+
+        const auto id = it.key();
+        auto updateJob = m_storage->updateItem(entry.pendingItem, transaction);
+        connect(updateJob, &KJob::result, this, [self, id, onResult] (KJob *job) {
+            if (self && job->error() != KJob::NoError) {
+                auto &entry = self->m_entries[id];
+                entry.writeError = job->error();
+                entry.writeErrorText = job->errorText();
+            }
+            onResult();
+        });
+        state->pendingResults++;
+        state->ids << id;
+
+        entry.inFlight = true;
+        entry.inFlightItem = entry.pendingItem;
+        entry.inFlightJobs = entry.pendingJobs;
+        entry.writeError = KJob::NoError;
+        entry.writeErrorText.clear();
+        entry.pendingItem = Item();
+        entry.pendingJobs.clear();
+        updateJob->start();
+    }
+
+    if (!transaction)
+        return;
+
+    connect(transaction, &KJob::result, this, [state, onResult] (KJob *transaction) {
+        state->error = transaction->error();
+        state->errorText = transaction->errorText();
+        onResult();
+    });
+    transaction->start();
+}
+
+void ItemWriteQueue::onFlushDone(const FlushPtr &state)
+{
+    // The server rolled the whole transaction back on failure, the items
+    // which didn't fail on their own get written again in a new one
+    bool culpritFound = false;
+    foreach (const auto id, state->ids)
+        culpritFound = culpritFound || m_entries.value(id).writeError != KJob::NoError;
+    const bool retry = state->error != KJob::NoError && culpritFound;
+
+    foreach (const auto id, state->ids) {
+        auto &entry = m_entries[id];
+        if (retry && entry.writeError == KJob::NoError) {
+            entry.inFlight = false;
+            entry.pendingJobs = entry.inFlightJobs + entry.pendingJobs;
+            if (!entry.pendingItem.isValid())
+                entry.pendingItem = entry.inFlightItem;
+            entry.inFlightItem = Item();
+            entry.inFlightJobs.clear();
+            continue;
+        }
+
+        if (entry.writeError != KJob::NoError)
+            finishWrite(id, entry.writeError, entry.writeErrorText);
+        else
+            finishWrite(id, state->error, state->errorText);
+    }
+
+    if (retry)
+        flush();
+    else if (m_drainLoop && m_entries.isEmpty())
+        m_drainLoop->quit();
+}
+
+void ItemWriteQueue::finishWrite(Item::Id id, int error, const QString &errorText)
+{
+    auto &entry = m_entries[id];
+    const auto jobs = entry.inFlightJobs;
+    entry.inFlight = false;
+    entry.inFlightItem = Item();
+    entry.inFlightJobs.clear();
+
+    // A later write might still make it, otherwise the server is right
+    if (entry.pendingItem.isValid()) {
+        if (!m_flushTimer->isActive())
+            m_flushTimer->start();
+    } else {
+        if (error != KJob::NoError)
+            rollback(id);
+        m_entries.remove(id);
+    }
+
+    foreach (const auto &job, jobs) {
+        if (job)
+            job->finish(error, errorText);
+    }
+}
+
+void ItemWriteQueue::rollback(Item::Id id)
+{
+    auto monitor = m_monitor;
+    ItemFetchJobInterface *job = m_storage->fetchItem(Item(id));
+    Utils::JobHandler::install(job->kjob(), [job, monitor] {
+        if (job->kjob()->error() != KJob::NoError)
+            return;
+
+        monitor->revertItems(job->items());
+    });
+}
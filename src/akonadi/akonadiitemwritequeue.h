@@ -0,0 +1,121 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef AKONADI_ITEMWRITEQUEUE_H
+#define AKONADI_ITEMWRITEQUEUE_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+
+#include <AkonadiCore/Item>
+
+#include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadistorageinterface.h"
+
+class KJob;
+class QEventLoop;
+class QTimer;
+
+namespace Akonadi {
+
+class ItemWriteJob;
+
+// Gathers the writes of items and flushes them in one transaction at
+// regular intervals, the domain objects being already modified when we
+// get them, the results show the change right away. What is still queued
+// when the queue goes away gets written before it's gone
+class ItemWriteQueue : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<ItemWriteQueue> Ptr;
+
+    static int flushDelay();
+
+    ItemWriteQueue(const StorageInterface::Ptr &storage,
+                   const MonitorInterface::Ptr &monitor);
+    ~ItemWriteQueue();
+
+    // Writes item with the next flush, a write of the same item still
+    // waiting for its turn is replaced by the new one. An item is written
+    // again only once its previous write is done. The returned job
+    // finishes along the write carrying the change, if it fails the
+    // server version of the item gets notified as changed to roll the
+    // results back. The other items of the flush get written again in
+    // a new transaction
+    KJob *updateItem(const Item &item);
+
+    // The queued snapshots carry the whole item, writes bypassing the
+    // queue would get undone by them. Those have to wait for the
+    // returned job, done once the queued writes of the items are.
+    // Pending ones not waiting for a previous write of their item are
+    // flushed right away. No job if nothing is queued for the items
+    KJob *flushItems(const Item::List &items);
+
+private slots:
+    void flush();
+
+private:
+    struct Entry
+    {
+        Entry() : inFlight(false), writeError(0) {}
+
+        bool inFlight;
+        Item inFlightItem;
+        QList<QPointer<ItemWriteJob>> inFlightJobs;
+        // Of the write of the in flight item on its own
+        int writeError;
+        QString writeErrorText;
+        Item pendingItem;
+        QList<QPointer<ItemWriteJob>> pendingJobs;
+    };
+
+    // The writes and the transaction carrying them, done once they all are
+    struct Flush
+    {
+        Flush() : pendingResults(0), error(0) {}
+
+        QList<Item::Id> ids;
+        int pendingResults;
+        int error;
+        QString errorText;
+    };
+    typedef QSharedPointer<Flush> FlushPtr;
+
+    void onFlushDone(const FlushPtr &state);
+    void finishWrite(Item::Id id, int error, const QString &errorText);
+    void rollback(Item::Id id);
+
+    StorageInterface::Ptr m_storage;
+    MonitorInterface::Ptr m_monitor;
+    QHash<Item::Id, Entry> m_entries;
+    QTimer *m_flushTimer;
+    // Only while the destructor waits for the last writes
+    QEventLoop *m_drainLoop;
+};
+
+}
+
+#endif // AKONADI_ITEMWRITEQUEUE_H
@@ -0,0 +1,190 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#include "akonadilockedserializerplugin.h"
+
+#include <QDir>
+#include <QMimeDatabase>
+#include <QMutexLocker>
+#include <QPluginLoader>
+#include <QSettings>
+#include <QStandardPaths>
+
+#include <AkonadiCore/Item>
+
+using namespace Akonadi;
+
+bool LockedSerializerPlugin::install()
+{
+    static const bool installed = [] {
+        // Stays around as long as the process, like the plugins themselves
+        auto plugin = new LockedSerializerPlugin;
+        if (!plugin->loadPlugins()) {
+            delete plugin;
+            return false;
+        }
+
+        ItemSerializerPlugin::overridePluginLookup(plugin);
+        return true;
+    }();
+
+    return installed;
+}
+
+LockedSerializerPlugin::LockedSerializerPlugin()
+    : m_lock(QMutex::Recursive)
+{
+}
+
+bool LockedSerializerPlugin::deserialize(Item &item, const QByteArray &label, QIODevice &data, int version)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (auto serializer = serializerFor(item))
+        return serializer->deserialize(item, label, data, version);
+
+    if (label != Item::FullPayload)
+        return false;
+
+    item.setPayload(data.readAll());
+    return true;
+}
+
+void LockedSerializerPlugin::serialize(const Item &item, const QByteArray &label, QIODevice &data, int &version)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (auto serializer = serializerFor(item)) {
+        serializer->serialize(item, label, data, version);
+        return;
+    }
+
+    if (label == Item::FullPayload && item.hasPayload<QByteArray>())
+        data.write(item.payload<QByteArray>());
+}
+
+QSet<QByteArray> LockedSerializerPlugin::parts(const Item &item) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (auto serializer = serializerFor(item))
+        return serializer->parts(item);
+    return ItemSerializerPlugin::parts(item);
+}
+
+void LockedSerializerPlugin::apply(Item &item, const Item &other)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (auto serializer = serializerFor(item))
+        serializer->apply(item, other);
+    else
+        ItemSerializerPlugin::apply(item, other);
+}
+
+QSet<QByteArray> LockedSerializerPlugin::allowedForeignParts(const Item &item) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (auto serializer = serializerFor(item))
+        return serializer->allowedForeignParts(item);
+    return ItemSerializerPlugin::allowedForeignParts(item);
+}
+
+QSet<QByteArray> LockedSerializerPlugin::availableParts(const Item &item) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (auto serializer = serializerFor(item))
+        return serializer->availableParts(item);
+    return ItemSerializerPlugin::availableParts(item);
+}
+
+QString LockedSerializerPlugin::extractGid(const Item &item) const
+{
+    QMutexLocker locker(&m_lock);
+
+    auto extractor = qobject_cast<GidExtractorInterface*>(pluginForMimeType(item.mimeType()));
+    return extractor ? extractor->extractGid(item) : QString();
+}
+
+bool LockedSerializerPlugin::loadPlugins()
+{
+    // Found the same way Akonadi finds them
+    const auto directories = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation,
+                                                       QStringLiteral("akonadi/plugins/serializer"),
+                                                       QStandardPaths::LocateDirectory);
+    foreach (const QString &directory, directories) {
+        const auto fileNames = QDir(directory).entryList(QStringList() << QStringLiteral("*.desktop"), QDir::Files);
+        foreach (const QString &fileName, fileNames) {
+            QSettings desktopFile(QDir(directory).filePath(fileName), QSettings::IniFormat);
+            desktopFile.beginGroup(QStringLiteral("Plugin"));
+            const auto library = desktopFile.value(QStringLiteral("X-KDE-Library")).toString();
+            const auto mimeTypes = desktopFile.value(QStringLiteral("X-Akonadi-MimeTypes")).toStringList();
+            if (library.isEmpty() || mimeTypes.isEmpty())
+                continue;
+
+            // Qt hands out one instance per library, so it's the one
+            // Akonadi would have been using
+            auto plugin = QPluginLoader(library).instance();
+            if (!qobject_cast<ItemSerializerPlugin*>(plugin))
+                continue;
+
+            foreach (const QString &mimeType, mimeTypes)
+                m_plugins << qMakePair(mimeType.trimmed(), plugin);
+        }
+    }
+
+    return !m_plugins.isEmpty();
+}
+
+QObject *LockedSerializerPlugin::pluginForMimeType(const QString &mimeType) const
+{
+    if (m_lookups.contains(mimeType))
+        return m_lookups.value(mimeType);
+
+    QObject *result = Q_NULLPTR;
+    for (auto it = m_plugins.constBegin(); !result && it != m_plugins.constEnd(); ++it) {
+        if (it->first == mimeType)
+            result = it->second;
+    }
+
+    // Otherwise the plugin of a type it derives from, e.g. the todos
+    // are handled by the plugin for text/calendar
+    if (!result) {
+        const auto type = QMimeDatabase().mimeTypeForName(mimeType);
+        for (auto it = m_plugins.constBegin(); !result && it != m_plugins.constEnd(); ++it) {
+            if (type.isValid() && type.inherits(it->first))
+                result = it->second;
+        }
+    }
+
+    m_lookups.insert(mimeType, result);
+    return result;
+}
+
+ItemSerializerPlugin *LockedSerializerPlugin::serializerFor(const Item &item) const
+{
+    return qobject_cast<ItemSerializerPlugin*>(pluginForMimeType(item.mimeType()));
+}
@@ -0,0 +1,79 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef AKONADI_LOCKEDSERIALIZERPLUGIN_H
+#define AKONADI_LOCKEDSERIALIZERPLUGIN_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+
+#include <AkonadiCore/GidExtractorInterface>
+#include <AkonadiCore/ItemSerializerPlugin>
+
+namespace Akonadi {
+
+// Stands in for all the payload serializer plugins and forwards to them
+// under one lock. The plugins are shared instances keeping parsing state,
+// the payloads encoded or decoded on several threads, e.g. by the item
+// fetch worker and by the jobs and the monitor of the GUI thread, all
+// have to go through here.
+class LockedSerializerPlugin : public QObject, public ItemSerializerPlugin, public GidExtractorInterface
+{
+    Q_OBJECT
+    Q_INTERFACES(Akonadi::ItemSerializerPlugin Akonadi::GidExtractorInterface)
+public:
+    // Loads the plugins and has Akonadi use the process wide instance
+    // for all the payloads, false if no plugin could be loaded. To be
+    // called before any other thread deals with payloads.
+    static bool install();
+
+    bool deserialize(Item &item, const QByteArray &label, QIODevice &data, int version) Q_DECL_OVERRIDE;
+    void serialize(const Item &item, const QByteArray &label, QIODevice &data, int &version) Q_DECL_OVERRIDE;
+    QSet<QByteArray> parts(const Item &item) const Q_DECL_OVERRIDE;
+    void apply(Item &item, const Item &other) Q_DECL_OVERRIDE;
+    QSet<QByteArray> allowedForeignParts(const Item &item) const Q_DECL_OVERRIDE;
+    QSet<QByteArray> availableParts(const Item &item) const Q_DECL_OVERRIDE;
+
+    QString extractGid(const Item &item) const Q_DECL_OVERRIDE;
+
+private:
+    LockedSerializerPlugin();
+
+    bool loadPlugins();
+    // Null if there's no plugin for the type, the payload then stays raw
+    // like Akonadi does it. To be called with the lock held.
+    QObject *pluginForMimeType(const QString &mimeType) const;
+    ItemSerializerPlugin *serializerFor(const Item &item) const;
+
+    // Recursive since the default implementations go back through Akonadi
+    mutable QMutex m_lock;
+    QList<QPair<QString, QObject*>> m_plugins;
+    mutable QHash<QString, QObject*> m_lookups;
+};
+
+}
+
+#endif // AKONADI_LOCKEDSERIALIZERPLUGIN_H
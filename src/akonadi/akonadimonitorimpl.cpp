@@ -24,6 +24,10 @@
 
 #include "akonadimonitorimpl.h"
 
+#include <algorithm>
+
+#include <QTimer>
+
 #include <KCalCore/Todo>
 
 #include <AkonadiCore/AttributeFactory>
@@ -39,12 +43,18 @@
 using namespace Akonadi;
 
 MonitorImpl::MonitorImpl()
-    : m_monitor(new Akonadi::Monitor)
+    : m_monitor(new Akonadi::Monitor),
+      m_pendingTimer(new QTimer(this))
 {
+    m_pendingTimer->setSingleShot(true);
+    m_pendingTimer->setInterval(0);
+    connect(m_pendingTimer, SIGNAL(timeout()), this, SLOT(emitPendingItems()));
+
     AttributeFactory::registerAttribute<ApplicationSelectedAttribute>();
     AttributeFactory::registerAttribute<TimestampAttribute>();
 
     m_monitor->fetchCollection(true);
+    m_monitor->fetchCollectionStatistics(true);
     m_monitor->setCollectionMonitored(Akonadi::Collection::root());
 
     m_monitor->setMimeTypeMonitored(KCalCore::Todo::todoMimeType());
@@ -59,19 +69,28 @@ MonitorImpl::MonitorImpl()
     connect(m_monitor, SIGNAL(collectionAdded(Akonadi::Collection,Akonadi::Collection)), this, SIGNAL(collectionAdded(Akonadi::Collection)));
     connect(m_monitor, SIGNAL(collectionRemoved(Akonadi::Collection)), this, SIGNAL(collectionRemoved(Akonadi::Collection)));
     connect(m_monitor, SIGNAL(collectionChanged(Akonadi::Collection,QSet<QByteArray>)), this, SLOT(onCollectionChanged(Akonadi::Collection,QSet<QByteArray>)));
+    // The moved collection comes with its new ancestor chain
+    connect(m_monitor, SIGNAL(collectionMoved(Akonadi::Collection,Akonadi::Collection,Akonadi::Collection)), this, SIGNAL(collectionChanged(Akonadi::Collection)));
+    connect(m_monitor, SIGNAL(collectionStatisticsChanged(Akonadi::Collection::Id,Akonadi::CollectionStatistics)), this, SLOT(onCollectionStatisticsChanged(Akonadi::Collection::Id,Akonadi::CollectionStatistics)));
 
     auto itemScope = m_monitor->itemFetchScope();
-    itemScope.fetchFullPayload();
+    // The serializer only ever reads the full payload. The attributes
+    // are still wanted, the notified items end up in the index and cache
+    // copies which get written back
+    itemScope.fetchPayloadPart(Item::FullPayload);
     itemScope.fetchAllAttributes();
     itemScope.setFetchTags(true);
     itemScope.tagFetchScope().setFetchIdOnly(false);
     itemScope.setAncestorRetrieval(ItemFetchScope::All);
     m_monitor->setItemFetchScope(itemScope);
+    // Changed items only come with the parts which changed, if that's not
+    // the payload they're only worth a new revision
+    m_monitor->fetchChangedOnly(true);
 
-    connect(m_monitor, SIGNAL(itemAdded(Akonadi::Item, Akonadi::Collection)), this, SIGNAL(itemAdded(Akonadi::Item)));
-    connect(m_monitor, SIGNAL(itemRemoved(Akonadi::Item)), this, SIGNAL(itemRemoved(Akonadi::Item)));
-    connect(m_monitor, SIGNAL(itemChanged(Akonadi::Item,QSet<QByteArray>)), this, SIGNAL(itemChanged(Akonadi::Item)));
-    connect(m_monitor, SIGNAL(itemMoved(Akonadi::Item,Akonadi::Collection,Akonadi::Collection)), this, SIGNAL(itemMoved(Akonadi::Item)));
+    connect(m_monitor, SIGNAL(itemAdded(Akonadi::Item, Akonadi::Collection)), this, SLOT(onItemAdded(Akonadi::Item)));
+    connect(m_monitor, SIGNAL(itemRemoved(Akonadi::Item)), this, SLOT(onItemRemoved(Akonadi::Item)));
+    connect(m_monitor, SIGNAL(itemChanged(Akonadi::Item,QSet<QByteArray>)), this, SLOT(onItemChanged(Akonadi::Item,QSet<QByteArray>)));
+    connect(m_monitor, SIGNAL(itemMoved(Akonadi::Item,Akonadi::Collection,Akonadi::Collection)), this, SLOT(onItemMoved(Akonadi::Item)));
     connect(m_monitor, SIGNAL(itemsTagsChanged(Akonadi::Item::List, QSet<Akonadi::Tag>, QSet<Akonadi::Tag>)), this, SLOT(onItemsTagsChanged(Akonadi::Item::List,QSet<Akonadi::Tag>,QSet<Akonadi::Tag>)));
 
     connect(m_monitor, SIGNAL(tagAdded(Akonadi::Tag)), this, SIGNAL(tagAdded(Akonadi::Tag)));
@@ -83,6 +102,18 @@ MonitorImpl::~MonitorImpl()
 {
 }
 
+bool MonitorImpl::hasPendingItemChanges(Item::Id id) const
+{
+    return m_pendingChanges.contains(id);
+}
+
+void MonitorImpl::revertItems(const Item::List &items)
+{
+    // Merged with what the server told us meanwhile
+    foreach (const Item &item, items)
+        onItemChanged(item);
+}
+
 void MonitorImpl::onCollectionChanged(const Collection &collection, const QSet<QByteArray> &parts)
 {
     // Will probably need to be expanded and to also fetch the full parent chain before emitting in some cases
@@ -90,6 +121,8 @@ void MonitorImpl::onCollectionChanged(const Collection &collection, const QSet<Q
                                                                     << "REMOTEID"
                                                                     << "AccessRights"
                                                                     << "ENTITYDISPLAY"
+                                                                    << "ENABLED"
+                                                                    << "REFERENCED"
                                                                     << "ZanshinSelected"
                                                                     << "ZanshinTimestamp";
 
@@ -104,17 +137,164 @@ void MonitorImpl::onCollectionChanged(const Collection &collection, const QSet<Q
     }
 }
 
+void MonitorImpl::onCollectionStatisticsChanged(Collection::Id id, const CollectionStatistics &statistics)
+{
+    Collection collection(id);
+    collection.setStatistics(statistics);
+    emit collectionStatisticsChanged(collection);
+}
+
 void MonitorImpl::onItemsTagsChanged(const Akonadi::Item::List &items, const QSet<Akonadi::Tag> &addedTags, const QSet<Akonadi::Tag> &removedTags)
 {
+    emit itemsTagsChanged(items, addedTags, removedTags);
+
     // Because itemChanged is not emitted on tag removal, we need to listen to itemsTagsChanged and
     // emit the itemChanged only in this case (avoid double emits in case of tag dissociation / association)
     // So if both list are empty it means we are just seeing a tag being removed so we update its related items
     if (addedTags.isEmpty() && removedTags.isEmpty()) {
         foreach (const Item &item, items)
-            emit itemChanged(item);
+            onItemChanged(item);
     }
 }
 
+void MonitorImpl::onItemChanged(const Item &item, const QSet<QByteArray> &parts)
+{
+    // Those parts are never displayed, if nothing else changed there's
+    // no point in having the queries decode the payload again
+    static const QSet<QByteArray> ignoredParts = QSet<QByteArray>() << "REMOTEID"
+                                                                    << "REMOTEREVISION"
+                                                                    << "GID"
+                                                                    << "FLAGS";
+
+    // No parts means we don't know what changed
+    const bool displayedPartChanged = parts.isEmpty()
+                                   || std::any_of(parts.begin(), parts.end(),
+                                                  [] (const QByteArray &part) {
+                                                      return !ignoredParts.contains(part) && !part.startsWith("ATR:");
+                                                  });
+    if (displayedPartChanged && item.hasPayload()) {
+        onItemChanged(item);
+        return;
+    }
+
+    // Still a new revision, a pending notification of the item will
+    // carry it, otherwise only the kept copies need to know about it
+    const auto changes = m_pendingChanges.value(item.id(), NoChange);
+    if (changes == NoChange)
+        emit itemsRevisionChanged(Item::List() << item);
+    else if (!(changes & ItemRemoved))
+        m_pendingItems[item.id()].setRevision(item.revision());
+}
+
+void MonitorImpl::onItemAdded(const Item &item)
+{
+    emit itemAdded(item);
+    queueItem(item, ItemAdded);
+}
+
+void MonitorImpl::onItemRemoved(const Item &item)
+{
+    emit itemRemoved(item);
+    queueItem(item, ItemRemoved);
+}
+
+void MonitorImpl::onItemChanged(const Item &item)
+{
+    emit itemChanged(item);
+    queueItem(item, ItemChanged);
+}
+
+void MonitorImpl::onItemMoved(const Item &item)
+{
+    emit itemMoved(item);
+    queueItem(item, ItemMoved);
+}
+
+MonitorImpl::PendingChanges MonitorImpl::mergeChanges(PendingChanges previous, PendingChange change)
+{
+    if (previous == NoChange)
+        return change;
+
+    switch (change) {
+    case ItemAdded:
+        // Removed then added back, the item is still there
+        return previous & ItemAdded ? previous : PendingChanges(ItemChanged);
+    case ItemRemoved:
+        // Came and went, nobody needs to know
+        if (previous & ItemAdded)
+            return NoChange;
+        return ItemRemoved;
+    case ItemChanged:
+    case ItemMoved:
+        // Nothing to tell about an item which isn't there anymore, and
+        // an addition already carries the latest version of the item
+        if (previous & (ItemAdded | ItemRemoved))
+            return previous;
+        return previous | change;
+    case NoChange:
+        break;
+    }
+
+    return previous;
+}
+
+void MonitorImpl::queueItem(const Item &item, PendingChange change)
+{
+    const auto id = item.id();
+
+    if (!m_pendingChanges.contains(id))
+        m_pendingIds << id;
+
+    const auto changes = mergeChanges(m_pendingChanges.value(id, NoChange), change);
+    if (changes == NoChange) {
+        m_pendingChanges.remove(id);
+        m_pendingItems.remove(id);
+        return;
+    }
+
+    // A removed item is notified as it was when removed
+    if (!(changes & ItemRemoved) || change == ItemRemoved)
+        m_pendingItems.insert(id, item);
+    m_pendingChanges.insert(id, changes);
+
+    if (!m_pendingTimer->isActive())
+        m_pendingTimer->start();
+}
+
+void MonitorImpl::emitPendingItems()
+{
+    Item::List added, removed, changed, moved;
+
+    foreach (Item::Id id, m_pendingIds) {
+        if (!m_pendingChanges.contains(id))
+            continue;
+
+        const auto item = m_pendingItems.take(id);
+        const auto changes = m_pendingChanges.take(id);
+        if (changes & ItemAdded)
+            added << item;
+        else if (changes & ItemRemoved)
+            removed << item;
+
+        // Moved items having changed too end up in both batches, the
+        // queries only look at the changes
+        if (changes & ItemChanged)
+            changed << item;
+        if (changes & ItemMoved)
+            moved << item;
+    }
+    m_pendingIds.clear();
+
+    if (!removed.isEmpty())
+        emit itemsRemoved(removed);
+    if (!added.isEmpty())
+        emit itemsAdded(added);
+    if (!changed.isEmpty())
+        emit itemsChanged(changed);
+    if (!moved.isEmpty())
+        emit itemsMoved(moved);
+}
+
 bool MonitorImpl::hasSupportedMimeTypes(const Collection &collection)
 {
     QSet<QString> mimeIntersection = m_monitor->mimeTypesMonitored().toSet();
@@ -25,8 +25,15 @@
 #define AKONADI_MONITORIMPL_H
 
 #include "akonadimonitorinterface.h"
+
+#include <QHash>
+
+#include <AkonadiCore/Collection>
+#include <AkonadiCore/CollectionStatistics>
 #include <AkonadiCore/Item>
 
+class QTimer;
+
 namespace Akonadi {
 
 class Monitor;
@@ -38,15 +45,48 @@ public:
     MonitorImpl();
     virtual ~MonitorImpl();
 
+    bool hasPendingItemChanges(Akonadi::Item::Id id) const Q_DECL_OVERRIDE;
+    void revertItems(const Akonadi::Item::List &items) Q_DECL_OVERRIDE;
+
+    enum PendingChange {
+        NoChange = 0,
+        ItemAdded = 1,
+        ItemRemoved = 2,
+        ItemChanged = 4,
+        ItemMoved = 8
+    };
+    Q_DECLARE_FLAGS(PendingChanges, PendingChange)
+
+    // What is left to notify about an item when a change follows the
+    // ones still pending, NoChange if it came and went in between
+    static PendingChanges mergeChanges(PendingChanges previous, PendingChange change);
+
 private slots:
     void onCollectionChanged(const Akonadi::Collection &collection, const QSet<QByteArray> &parts);
+    void onCollectionStatisticsChanged(Akonadi::Collection::Id id, const Akonadi::CollectionStatistics &statistics);
     void onItemsTagsChanged(const Akonadi::Item::List &items, const QSet<Akonadi::Tag> &addedTags, const QSet<Akonadi::Tag> &removedTags);
 
+    void onItemAdded(const Akonadi::Item &item);
+    void onItemRemoved(const Akonadi::Item &item);
+    void onItemChanged(const Akonadi::Item &item);
+    void onItemChanged(const Akonadi::Item &item, const QSet<QByteArray> &parts);
+    void onItemMoved(const Akonadi::Item &item);
+    void emitPendingItems();
+
 private:
     bool hasSupportedMimeTypes(const Collection &collection);
+    void queueItem(const Akonadi::Item &item, PendingChange change);
+
     Akonadi::Monitor *m_monitor;
+
+    QTimer *m_pendingTimer;
+    QList<Item::Id> m_pendingIds;
+    QHash<Item::Id, PendingChanges> m_pendingChanges;
+    QHash<Item::Id, Item> m_pendingItems;
 };
 
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Akonadi::MonitorImpl::PendingChanges)
+
 #endif // AKONADI_MONITORIMPL_H
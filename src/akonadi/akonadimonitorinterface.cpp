@@ -34,3 +34,14 @@ MonitorInterface::MonitorInterface(QObject *parent)
 MonitorInterface::~MonitorInterface()
 {
 }
+
+bool MonitorInterface::hasPendingItemChanges(Item::Id id) const
+{
+    Q_UNUSED(id);
+    return false;
+}
+
+void MonitorInterface::revertItems(const Item::List &items)
+{
+    emit itemsChanged(items);
+}
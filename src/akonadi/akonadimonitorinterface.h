@@ -25,13 +25,15 @@
 #define AKONADI_MONITORINTERFACE_H
 
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 
+#include <AkonadiCore/Item>
+#include <AkonadiCore/Tag>
+
 namespace Akonadi {
 
 class Collection;
-class Item;
-class Tag;
 
 class MonitorInterface : public QObject
 {
@@ -42,17 +44,43 @@ public:
     explicit MonitorInterface(QObject *parent = Q_NULLPTR);
     virtual ~MonitorInterface();
 
+    // True while notifications about the item are held back to be
+    // grouped, copies of the item kept so far are outdated then
+    virtual bool hasPendingItemChanges(Akonadi::Item::Id id) const;
+    // For writes which didn't make it to the server, the stored version
+    // of the items gets notified as changed to undo what was shown
+    virtual void revertItems(const Akonadi::Item::List &items);
+
 signals:
     void collectionAdded(const Akonadi::Collection &collection);
     void collectionRemoved(const Akonadi::Collection &collection);
     void collectionChanged(const Akonadi::Collection &collection);
     void collectionSelectionChanged(const Akonadi::Collection &collection);
+    // Only the id and the statistics of the collection are known
+    void collectionStatisticsChanged(const Akonadi::Collection &collection);
 
+    // Emitted as soon as notified, prefer the grouped versions below
     void itemAdded(const Akonadi::Item &item);
     void itemRemoved(const Akonadi::Item &item);
     void itemChanged(const Akonadi::Item &items);
     void itemMoved(const Akonadi::Item &item);
 
+    // Same notifications as above, possibly delayed and grouped, several
+    // notifications about the same item being merged into one
+    void itemsAdded(const Akonadi::Item::List &items);
+    void itemsRemoved(const Akonadi::Item::List &items);
+    void itemsChanged(const Akonadi::Item::List &items);
+    void itemsMoved(const Akonadi::Item::List &items);
+    // Changes touching none of the parts the queries look at, only of
+    // interest to those keeping copies of the items to write them back.
+    // The items might only carry their new revision
+    void itemsRevisionChanged(const Akonadi::Item::List &items);
+    // Tag (dis)associations, not delayed, both sets are empty when the
+    // items lost a tag because it got removed
+    void itemsTagsChanged(const Akonadi::Item::List &items,
+                          const QSet<Akonadi::Tag> &addedTags,
+                          const QSet<Akonadi::Tag> &removedTags);
+
     void tagAdded(const Akonadi::Tag &tag);
     void tagRemoved(const Akonadi::Tag &tag);
     void tagChanged(const Akonadi::Tag &tag);
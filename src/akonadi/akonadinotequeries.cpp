@@ -26,6 +26,7 @@
 
 #include "akonadicollectionfetchjobinterface.h"
 #include "akonadiitemfetchjobinterface.h"
+#include "akonadiqueryscheduler.h"
 
 #include "utils/jobhandler.h"
 
@@ -38,9 +39,11 @@ NoteQueries::NoteQueries(const StorageInterface::Ptr &storage,
       m_serializer(serializer),
       m_monitor(monitor)
 {
-    connect(m_monitor.data(), SIGNAL(itemAdded(Akonadi::Item)), this, SLOT(onItemAdded(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemRemoved(Akonadi::Item)), this, SLOT(onItemRemoved(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemChanged(Akonadi::Item)), this, SLOT(onItemChanged(Akonadi::Item)));
+    QueryScheduler::install();
+
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
 }
 
 NoteQueries::NoteResult::Ptr NoteQueries::findAll() const
@@ -49,6 +52,7 @@ NoteQueries::NoteResult::Ptr NoteQueries::findAll() const
         {
             NoteQueries *self = const_cast<NoteQueries*>(this);
             self->m_findAll = self->createNoteQuery();
+            self->m_findAll->setDebugName(QStringLiteral("NoteQueries::findAll"));
         }
 
         m_findAll->setFetchFunction([this] (const NoteQuery::AddFunction &add) {
@@ -61,13 +65,9 @@ NoteQueries::NoteResult::Ptr NoteQueries::findAll() const
 
                 for (auto collection : job->collections()) {
                     ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
-
-                        for (auto item : job->items()) {
+                    job->streamItems([add] (const Akonadi::Item::List &items) {
+                        for (auto item : items)
                             add(item);
-                        }
                     });
                 }
             });
@@ -85,27 +85,28 @@ NoteQueries::NoteResult::Ptr NoteQueries::findAll() const
         m_findAll->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Note::Ptr &note) {
             return m_serializer->representsItem(note, item);
         });
+        m_findAll->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findAll->result();
 }
 
-void NoteQueries::onItemAdded(const Item &item)
+void NoteQueries::onItemsAdded(const Item::List &items)
 {
     foreach (const NoteQuery::Ptr &query, m_noteQueries)
-        query->onAdded(item);
+        query->onAddedBatch(items);
 }
 
-void NoteQueries::onItemRemoved(const Item &item)
+void NoteQueries::onItemsRemoved(const Item::List &items)
 {
     foreach (const NoteQuery::Ptr &query, m_noteQueries)
-        query->onRemoved(item);
+        query->onRemovedBatch(items);
 }
 
-void NoteQueries::onItemChanged(const Item &item)
+void NoteQueries::onItemsChanged(const Item::List &items)
 {
     foreach (const NoteQuery::Ptr &query, m_noteQueries)
-        query->onChanged(item);
+        query->onChangedBatch(items);
 }
 
 NoteQueries::NoteQuery::Ptr NoteQueries::createNoteQuery()
@@ -56,9 +56,9 @@ public:
     NoteResult::Ptr findAll() const Q_DECL_OVERRIDE;
 
 private slots:
-    void onItemAdded(const Akonadi::Item &item);
-    void onItemRemoved(const Akonadi::Item &item);
-    void onItemChanged(const Akonadi::Item &item);
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
 
 private:
     NoteQuery::Ptr createNoteQuery();
@@ -32,9 +32,11 @@
 using namespace Akonadi;
 
 NoteRepository::NoteRepository(const StorageInterface::Ptr &storage,
-                               const SerializerInterface::Ptr &serializer)
+                               const SerializerInterface::Ptr &serializer,
+                               const ItemWriteQueue::Ptr &writeQueue)
     : m_storage(storage),
-      m_serializer(serializer)
+      m_serializer(serializer),
+      m_writeQueue(writeQueue)
 {
 }
 
@@ -56,6 +58,8 @@ KJob *NoteRepository::save(Domain::Note::Ptr note)
     auto item = m_serializer->createItemFromNote(note);
 
     if (item.isValid()) {
+        if (m_writeQueue)
+            return m_writeQueue->updateItem(item);
         return m_storage->updateItem(item);
     } else {
         return m_storage->createItem(item, m_storage->defaultNoteCollection());
@@ -26,6 +26,7 @@
 
 #include "domain/noterepository.h"
 
+#include "akonadi/akonadiitemwritequeue.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
 
@@ -40,7 +41,8 @@ public:
     typedef QSharedPointer<NoteRepository> Ptr;
 
     NoteRepository(const StorageInterface::Ptr &storage,
-                   const SerializerInterface::Ptr &serializer);
+                   const SerializerInterface::Ptr &serializer,
+                   const ItemWriteQueue::Ptr &writeQueue = ItemWriteQueue::Ptr());
 
     bool isDefaultSource(Domain::DataSource::Ptr source) const Q_DECL_OVERRIDE;
     void setDefaultSource(Domain::DataSource::Ptr source) Q_DECL_OVERRIDE;
@@ -51,6 +53,7 @@ public:
 private:
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
+    ItemWriteQueue::Ptr m_writeQueue;
 };
 
 }
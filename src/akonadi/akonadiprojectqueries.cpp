@@ -26,20 +26,37 @@
 
 #include "akonadicollectionfetchjobinterface.h"
 #include "akonadiitemfetchjobinterface.h"
+#include "akonadiqueryscheduler.h"
 
-#include "utils/jobhandler.h"
+#include "utils/jobcontinuation.h"
 
 using namespace Akonadi;
 
-ProjectQueries::ProjectQueries(const StorageInterface::Ptr &storage, const SerializerInterface::Ptr &serializer, const MonitorInterface::Ptr &monitor)
+ProjectQueries::ProjectQueries(const StorageInterface::Ptr &storage, const SerializerInterface::Ptr &serializer, const MonitorInterface::Ptr &monitor,
+                               const RelationIndex::Ptr &index)
     : m_storage(storage),
       m_serializer(serializer),
-      m_monitor(monitor)
+      m_monitor(monitor),
+      m_index(index ? index : RelationIndex::Ptr::create(storage, serializer, monitor)),
+      m_selectedScope(CollectionScope::SelectedCollections)
 {
-    connect(m_monitor.data(), SIGNAL(itemAdded(Akonadi::Item)), this, SLOT(onItemAdded(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemRemoved(Akonadi::Item)), this, SLOT(onItemRemoved(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemChanged(Akonadi::Item)), this, SLOT(onItemChanged(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(collectionSelectionChanged(Akonadi::Collection)), this, SLOT(onCollectionSelectionChanged()));
+    QueryScheduler::install();
+
+    // Artifact queries are keyed by project uid, the index already
+    // processed the notification when we get it
+    auto relationIndex = m_index;
+    m_artifactRouter = ArtifactRouter::Ptr::create([relationIndex] (const Akonadi::Item &item, QStringList &keys) {
+        if (!relationIndex->item(item.id()).isValid())
+            return false;
+
+        keys << relationIndex->parentUid(item.id());
+        return true;
+    });
+
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(collectionSelectionChanged(Akonadi::Collection)), this, SLOT(onCollectionSelectionChanged(Akonadi::Collection)));
 }
 
 ProjectQueries::ProjectResult::Ptr ProjectQueries::findAll() const
@@ -48,31 +65,11 @@ ProjectQueries::ProjectResult::Ptr ProjectQueries::findAll() const
         {
             ProjectQueries *self = const_cast<ProjectQueries*>(this);
             self->m_findAll = self->createProjectQuery();
+            self->m_findAll->setDebugName(QStringLiteral("ProjectQueries::findAll"));
         }
 
         m_findAll->setFetchFunction([this] (const ProjectQuery::AddFunction &add) {
-            CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
-                                                                           StorageInterface::Recursive,
-                                                                           StorageInterface::Tasks);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
-                    return;
-
-                for (auto collection : job->collections()) {
-                    if (!m_serializer->isSelectedCollection(collection))
-                        continue;
-
-                    ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
-
-                        for (auto item : job->items()) {
-                            add(item);
-                        }
-                    });
-                }
-            });
+            m_selectedScope.fetchItems(m_storage, m_serializer, StorageInterface::Tasks, add);
         });
 
         m_findAll->setConvertFunction([this] (const Akonadi::Item &item) {
@@ -87,6 +84,7 @@ ProjectQueries::ProjectResult::Ptr ProjectQueries::findAll() const
         m_findAll->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Project::Ptr &project) {
             return m_serializer->representsItem(project, item);
         });
+        m_findAll->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findAll->result();
@@ -97,31 +95,78 @@ ProjectQueries::ArtifactResult::Ptr ProjectQueries::findTopLevelArtifacts(Domain
     Akonadi::Item item = m_serializer->createItemFromProject(project);
     if (!m_findTopLevel.contains(item.id())) {
         ArtifactQuery::Ptr query;
+        const QString uid = m_serializer->objectUid(project);
 
         {
             ProjectQueries *self = const_cast<ProjectQueries*>(this);
-            query = self->createArtifactQuery();
+            query = self->createArtifactQuery(uid);
+            query->setDebugName(QStringLiteral("ProjectQueries::findTopLevelArtifacts"));
             self->m_findTopLevel.insert(item.id(), query);
         }
 
-        query->setFetchFunction([this, item] (const ArtifactQuery::AddFunction &add) {
+        query->setFetchFunction([this, uid, item] (const ArtifactQuery::AddFunction &queryAdd) {
+            // Tasks get created in or moved to the collection of their
+            // project, notes stay where they are and point to their project
+            // through their related uid. So only the project collection and
+            // the notes collections are looked into, the index hands out the
+            // children of the project
+            auto index = m_index;
+            auto storage = m_storage;
+            auto serializer = m_serializer;
+            auto add = m_artifactRouter->trackedAdd(uid, queryAdd);
+            auto visitedIds = QSharedPointer<QSet<Akonadi::Collection::Id>>::create();
+            auto addChildren = [index, storage, serializer, uid, add, visitedIds] (const Akonadi::Collection &collection) {
+                if (visitedIds->contains(collection.id()))
+                    return;
+                visitedIds->insert(collection.id());
+
+                index->populateCollection(collection, [index, storage, serializer, uid, collection, add] (bool populated) {
+                    if (!populated) {
+                        // The index couldn't make it, look at the collection directly
+                        ItemFetchJobInterface *job = storage->fetchItems(collection);
+                        job->streamItems([serializer, uid, add] (const Akonadi::Item::List &items) {
+                            for (auto item : items) {
+                                if (serializer->relatedUidFromItem(item) == uid)
+                                    add(item);
+                            }
+                        });
+                        return;
+                    }
+
+                    for (auto child : index->childItems(uid)) {
+                        if (child.parentCollection().id() == collection.id())
+                            add(child);
+                    }
+                });
+            };
+
+            const Akonadi::Item indexedItem = index->item(item.id());
+            const auto projectCollection = indexedItem.isValid() ? indexedItem.parentCollection()
+                                                                 : item.parentCollection();
+            if (projectCollection.isValid()) {
+                addChildren(projectCollection);
+            } else {
+                ItemFetchJobInterface *job = m_storage->fetchItem(item);
+                Utils::JobContinuation::whenDone(job->kjob(), [job, addChildren] (KJob *kjob) {
+                    if (kjob->error() != KJob::NoError)
+                        return;
+
+                    Q_ASSERT(job->items().size() == 1);
+                    auto item = job->items()[0];
+                    Q_ASSERT(item.parentCollection().isValid());
+                    addChildren(item.parentCollection());
+                });
+            }
+
             CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
                                                                            StorageInterface::Recursive,
-                                                                           StorageInterface::Tasks | StorageInterface::Notes);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
+                                                                           StorageInterface::Notes);
+            Utils::JobContinuation::whenDone(job->kjob(), [job, addChildren] (KJob *kjob) {
+                if (kjob->error() != KJob::NoError)
                     return;
 
-                for (auto collection : job->collections()) {
-                    ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
-
-                        for (auto item : job->items())
-                            add(item);
-                    });
-                }
+                for (auto collection : job->collections())
+                    addChildren(collection);
             });
         });
         query->setConvertFunction([this] (const Akonadi::Item &item) {
@@ -150,42 +195,58 @@ ProjectQueries::ArtifactResult::Ptr ProjectQueries::findTopLevelArtifacts(Domain
         query->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Artifact::Ptr &artifact) {
             return m_serializer->representsItem(artifact, item);
         });
+        query->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findTopLevel.value(item.id())->result();
 }
 
-void ProjectQueries::onItemAdded(const Item &item)
+void ProjectQueries::onItemsAdded(const Item::List &items)
 {
+    const auto inScope = m_selectedScope.filter(items);
     foreach (const ProjectQuery::Ptr &query, m_projectQueries)
-        query->onAdded(item);
+        query->onAddedBatch(inScope);
 
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onAdded(item);
+    m_artifactRouter->onAdded(items);
 }
 
-void ProjectQueries::onItemRemoved(const Item &item)
+void ProjectQueries::onItemsRemoved(const Item::List &items)
 {
     foreach (const ProjectQuery::Ptr &query, m_projectQueries)
-        query->onRemoved(item);
+        query->onRemovedBatch(items);
 
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onRemoved(item);
+    m_artifactRouter->onRemoved(items);
 }
 
-void ProjectQueries::onItemChanged(const Item &item)
+void ProjectQueries::onItemsChanged(const Item::List &items)
 {
-    foreach (const ProjectQuery::Ptr &query, m_projectQueries)
-        query->onChanged(item);
+    // Projects moved to a deselected collection go away
+    Item::List outOfScope;
+    const auto inScope = m_selectedScope.filter(items, &outOfScope);
+    foreach (const ProjectQuery::Ptr &query, m_projectQueries) {
+        query->onChangedBatch(inScope);
+        if (!outOfScope.isEmpty())
+            query->onRemovedBatch(outOfScope);
+    }
 
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onChanged(item);
+    m_artifactRouter->onChanged(items);
 }
 
-void ProjectQueries::onCollectionSelectionChanged()
+void ProjectQueries::onCollectionSelectionChanged(const Collection &collection)
 {
-    foreach (const ProjectQuery::Ptr &query, m_projectQueries)
-        query->reset();
+    if (m_projectQueries.isEmpty())
+        return;
+
+    // Only the contents of the toggled collection get fetched
+    m_selectedScope.changeSelection(collection, m_storage, m_serializer,
+                                    [this] (const Akonadi::Item::List &items, bool selected) {
+        foreach (const ProjectQuery::Ptr &query, m_projectQueries) {
+            if (selected)
+                query->onChangedBatch(items);
+            else
+                query->onRemovedBatch(items);
+        }
+    });
 }
 
 ProjectQueries::ProjectQuery::Ptr ProjectQueries::createProjectQuery()
@@ -195,9 +256,9 @@ ProjectQueries::ProjectQuery::Ptr ProjectQueries::createProjectQuery()
     return query;
 }
 
-ProjectQueries::ArtifactQuery::Ptr ProjectQueries::createArtifactQuery()
+ProjectQueries::ArtifactQuery::Ptr ProjectQueries::createArtifactQuery(const QString &projectUid)
 {
     auto query = ProjectQueries::ArtifactQuery::Ptr::create();
-    m_artifactQueries << query;
+    m_artifactRouter->addQuery(projectUid, query);
     return query;
 }
@@ -28,7 +28,10 @@
 
 #include <AkonadiCore/Item>
 
+#include "akonadi/akonadicollectionscope.h"
 #include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadiqueryrouter.h"
+#include "akonadi/akonadirelationindex.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
 
@@ -49,33 +52,38 @@ public:
     typedef Domain::LiveQuery<Akonadi::Item, Domain::Artifact::Ptr> ArtifactQuery;
     typedef Domain::QueryResultProvider<Domain::Artifact::Ptr> ArtifactProvider;
     typedef Domain::QueryResult<Domain::Artifact::Ptr> ArtifactResult;
+    typedef QueryRouter<ArtifactQuery> ArtifactRouter;
 
     ProjectQueries(const StorageInterface::Ptr &storage,
                    const SerializerInterface::Ptr &serializer,
-                   const MonitorInterface::Ptr &monitor);
+                   const MonitorInterface::Ptr &monitor,
+                   const RelationIndex::Ptr &index = RelationIndex::Ptr());
 
     ProjectResult::Ptr findAll() const Q_DECL_OVERRIDE;
     ArtifactResult::Ptr findTopLevelArtifacts(Domain::Project::Ptr project) const Q_DECL_OVERRIDE;
 
 private slots:
-    void onItemAdded(const Akonadi::Item &item);
-    void onItemRemoved(const Akonadi::Item &item);
-    void onItemChanged(const Akonadi::Item &item);
-    void onCollectionSelectionChanged();
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
+    void onCollectionSelectionChanged(const Akonadi::Collection &collection);
 
 private:
     ProjectQuery::Ptr createProjectQuery();
-    ArtifactQuery::Ptr createArtifactQuery();
+    ArtifactQuery::Ptr createArtifactQuery(const QString &projectUid);
 
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
     MonitorInterface::Ptr m_monitor;
+    RelationIndex::Ptr m_index;
 
     ProjectQuery::Ptr m_findAll;
     ProjectQuery::List m_projectQueries;
+    // Scope of the queries showing the selected collections contents
+    CollectionScope m_selectedScope;
 
     QHash<Akonadi::Entity::Id, ArtifactQuery::Ptr> m_findTopLevel;
-    ArtifactQuery::List m_artifactQueries;
+    ArtifactRouter::Ptr m_artifactRouter;
 };
 
 }
@@ -31,9 +31,11 @@
 using namespace Akonadi;
 
 ProjectRepository::ProjectRepository(const StorageInterface::Ptr &storage,
-                                     const SerializerInterface::Ptr &serializer)
+                                     const SerializerInterface::Ptr &serializer,
+                                     const ItemWriteQueue::Ptr &writeQueue)
     : m_storage(storage),
-      m_serializer(serializer)
+      m_serializer(serializer),
+      m_writeQueue(writeQueue)
 {
 }
 
@@ -50,6 +52,8 @@ KJob *ProjectRepository::update(Domain::Project::Ptr project)
 {
     auto item = m_serializer->createItemFromProject(project);
     Q_ASSERT(item.isValid());
+    if (m_writeQueue)
+        return m_writeQueue->updateItem(item);
     return m_storage->updateItem(item);
 }
 
@@ -70,49 +74,51 @@ KJob *ProjectRepository::associate(Domain::Project::Ptr parent, Domain::Artifact
     Q_ASSERT(childItem.isValid());
 
     auto job = new Utils::CompositeJob();
-    ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(childItem);
-    job->install(fetchItemJob->kjob(), [fetchItemJob, parent, child, job, this] {
-        if (fetchItemJob->kjob()->error() != KJob::NoError)
-           return;
-
-        Q_ASSERT(fetchItemJob->items().size() == 1);
-        auto childItem = fetchItemJob->items().first();
-        m_serializer->updateItemProject(childItem, parent);
-
-        // Check collections to know if we need to move child
-        auto parentItem = m_serializer->createItemFromProject(parent);
-        ItemFetchJobInterface *fetchParentItemJob = m_storage->fetchItem(parentItem);
-        job->install(fetchParentItemJob->kjob(), [fetchParentItemJob, child, childItem, job, this] {
-            if (fetchParentItemJob->kjob()->error() != KJob::NoError)
-                return;
-
-            Q_ASSERT(fetchParentItemJob->items().size() == 1);
-            auto parentItem = fetchParentItemJob->items().first();
-
-            const int itemCollectionId = childItem.parentCollection().id();
-            const int parentCollectionId = parentItem.parentCollection().id();
-
-            if (child.objectCast<Domain::Task>()
-             && itemCollectionId != parentCollectionId) {
-                ItemFetchJobInterface *fetchChildrenItemJob = m_storage->fetchItems(childItem.parentCollection());
-                job->install(fetchChildrenItemJob->kjob(), [fetchChildrenItemJob, childItem, parentItem, job, this] {
-                    if (fetchChildrenItemJob->kjob()->error() != KJob::NoError)
-                        return;
-
-                    Item::List childItems = m_serializer->filterDescendantItems(fetchChildrenItemJob->items(), childItem);
-
-                    auto transaction = m_storage->createTransaction();
-                    m_storage->updateItem(childItem, transaction);
-                    childItems.push_front(childItem);
-                    m_storage->moveItems(childItems, parentItem.parentCollection(), transaction);
-                    job->addSubjob(transaction);
-                    transaction->start();
-                });
-            } else {
-                auto updateJob = m_storage->updateItem(childItem);
-                job->addSubjob(updateJob);
-                updateJob->start();
-            }
+    afterQueuedWrites(job, childItem, [childItem, parent, child, job, this] {
+        ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(childItem);
+        job->install(fetchItemJob->kjob(), [fetchItemJob, parent, child, job, this] {
+            if (fetchItemJob->kjob()->error() != KJob::NoError)
+               return;
+
+            Q_ASSERT(fetchItemJob->items().size() == 1);
+            auto childItem = fetchItemJob->items().first();
+            m_serializer->updateItemProject(childItem, parent);
+
+            // Check collections to know if we need to move child
+            auto parentItem = m_serializer->createItemFromProject(parent);
+            ItemFetchJobInterface *fetchParentItemJob = m_storage->fetchItem(parentItem);
+            job->install(fetchParentItemJob->kjob(), [fetchParentItemJob, child, childItem, job, this] {
+                if (fetchParentItemJob->kjob()->error() != KJob::NoError)
+                    return;
+
+                Q_ASSERT(fetchParentItemJob->items().size() == 1);
+                auto parentItem = fetchParentItemJob->items().first();
+
+                const int itemCollectionId = childItem.parentCollection().id();
+                const int parentCollectionId = parentItem.parentCollection().id();
+
+                if (child.objectCast<Domain::Task>()
+                 && itemCollectionId != parentCollectionId) {
+                    ItemFetchJobInterface *fetchChildrenItemJob = m_storage->fetchItems(childItem.parentCollection());
+                    job->install(fetchChildrenItemJob->kjob(), [fetchChildrenItemJob, childItem, parentItem, job, this] {
+                        if (fetchChildrenItemJob->kjob()->error() != KJob::NoError)
+                            return;
+
+                        Item::List childItems = m_serializer->filterDescendantItems(fetchChildrenItemJob->items(), childItem);
+
+                        auto transaction = m_storage->createTransaction();
+                        m_storage->updateItem(childItem, transaction);
+                        childItems.push_front(childItem);
+                        m_storage->moveItems(childItems, parentItem.parentCollection(), transaction);
+                        job->addSubjob(transaction);
+                        transaction->start();
+                    });
+                } else {
+                    auto updateJob = m_storage->updateItem(childItem);
+                    job->addSubjob(updateJob);
+                    updateJob->start();
+                }
+            });
         });
     });
 
@@ -130,20 +136,39 @@ KJob *ProjectRepository::dissociate(Domain::Artifact::Ptr child)
                          : Akonadi::Item();
     Q_ASSERT(childItem.isValid());
 
-    ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(childItem);
-    job->install(fetchItemJob->kjob(), [fetchItemJob, job, this] {
-        if (fetchItemJob->kjob()->error() != KJob::NoError)
-            return;
+    afterQueuedWrites(job, childItem, [childItem, job, this] {
+        ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(childItem);
+        job->install(fetchItemJob->kjob(), [fetchItemJob, job, this] {
+            if (fetchItemJob->kjob()->error() != KJob::NoError)
+                return;
 
-        Q_ASSERT(fetchItemJob->items().size() == 1);
-        auto childItem = fetchItemJob->items().first();
+            Q_ASSERT(fetchItemJob->items().size() == 1);
+            auto childItem = fetchItemJob->items().first();
 
-        m_serializer->removeItemParent(childItem);
+            m_serializer->removeItemParent(childItem);
 
-        auto updateJob = m_storage->updateItem(childItem);
-        job->addSubjob(updateJob);
-        updateJob->start();
+            auto updateJob = m_storage->updateItem(childItem);
+            job->addSubjob(updateJob);
+            updateJob->start();
+        });
     });
 
     return job;
 }
+
+void ProjectRepository::afterQueuedWrites(Utils::CompositeJob *job, const Item &item, const std::function<void()> &handler)
+{
+    // The queued snapshot of the item would undo what we're about to write
+    KJob *flushJob = m_writeQueue ? m_writeQueue->flushItems(Item::List() << item) : Q_NULLPTR;
+    if (!flushJob) {
+        handler();
+        return;
+    }
+
+    job->install(flushJob, [flushJob, handler] {
+        if (flushJob->error() != KJob::NoError)
+            return;
+
+        handler();
+    });
+}
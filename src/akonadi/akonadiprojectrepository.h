@@ -24,11 +24,18 @@
 #ifndef AKONADI_PROJECTREPOSITORY_H
 #define AKONADI_PROJECTREPOSITORY_H
 
+#include <functional>
+
 #include "domain/projectrepository.h"
 
+#include "akonadi/akonadiitemwritequeue.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
 
+namespace Utils {
+class CompositeJob;
+}
+
 namespace Akonadi {
 
 class ProjectRepository : public QObject, public Domain::ProjectRepository
@@ -38,7 +45,8 @@ public:
     typedef QSharedPointer<ProjectRepository> Ptr;
 
     ProjectRepository(const StorageInterface::Ptr &storage,
-                      const SerializerInterface::Ptr &serializer);
+                      const SerializerInterface::Ptr &serializer,
+                      const ItemWriteQueue::Ptr &writeQueue = ItemWriteQueue::Ptr());
 
     KJob *create(Domain::Project::Ptr project, Domain::DataSource::Ptr source) Q_DECL_OVERRIDE;
     KJob *update(Domain::Project::Ptr project) Q_DECL_OVERRIDE;
@@ -48,8 +56,13 @@ public:
     KJob *dissociate(Domain::Artifact::Ptr child) Q_DECL_OVERRIDE;
 
 private:
+    // Calls handler once the queued writes of item are done within job,
+    // right away if there are none
+    void afterQueuedWrites(Utils::CompositeJob *job, const Item &item, const std::function<void()> &handler);
+
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
+    ItemWriteQueue::Ptr m_writeQueue;
 };
 
 }
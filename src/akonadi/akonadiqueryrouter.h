@@ -0,0 +1,210 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#ifndef AKONADI_QUERYROUTER_H
+#define AKONADI_QUERYROUTER_H
+
+#include <functional>
+
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <AkonadiCore/Item>
+
+namespace Akonadi {
+
+// Dispatches item notifications only to the live queries which could be
+// affected by them. Global queries see every item, keyed queries (children
+// of a parent uid, items of a tag...) only see the items currently carrying
+// their key or which carried it the last time they were routed or fetched,
+// so that they can still drop the items leaving them.
+template<typename Query>
+class QueryRouter
+{
+public:
+    typedef QSharedPointer<QueryRouter<Query>> Ptr;
+    typedef typename Query::Ptr QueryPtr;
+    typedef typename Query::AddFunction AddFunction;
+
+    // Fills keys and returns true if they could be determined for item,
+    // otherwise it is routed to all the keyed queries
+    typedef std::function<bool(const Item &, QStringList &)> KeysFunction;
+
+    explicit QueryRouter(const KeysFunction &keys)
+        : m_keys(keys),
+          m_itemKeys(QSharedPointer<QHash<Item::Id, QStringList>>::create())
+    {
+    }
+
+    void addQuery(const QueryPtr &query)
+    {
+        m_globalQueries << query;
+    }
+
+    void addQuery(const QString &key, const QueryPtr &query)
+    {
+        m_keyedQueries << qMakePair(key, query);
+        m_keyCounts[key]++;
+    }
+
+    void removeQuery(const QueryPtr &query)
+    {
+        m_globalQueries.removeAll(query);
+
+        for (int i = 0; i < m_keyedQueries.size(); i++) {
+            if (m_keyedQueries.at(i).second != query)
+                continue;
+
+            const QString key = m_keyedQueries.takeAt(i).first;
+            if (--m_keyCounts[key] == 0)
+                m_keyCounts.remove(key);
+            i--;
+        }
+    }
+
+    // Wraps the add function of a keyed query fetch so that the items
+    // it finds get routed to it later on
+    AddFunction trackedAdd(const QString &key, const AddFunction &add)
+    {
+        auto itemKeys = m_itemKeys;
+        return [itemKeys, key, add] (const Item &item) {
+            auto &keys = (*itemKeys)[item.id()];
+            if (!keys.contains(key))
+                keys << key;
+            add(item);
+        };
+    }
+
+    void onAdded(const Item::List &items)
+    {
+        foreach (const auto &batch, route(items, false))
+            batch.first->onAddedBatch(batch.second);
+    }
+
+    void onRemoved(const Item::List &items)
+    {
+        foreach (const auto &batch, route(items, true))
+            batch.first->onRemovedBatch(batch.second);
+    }
+
+    void onChanged(const Item::List &items)
+    {
+        foreach (const auto &batch, route(items, false))
+            batch.first->onChangedBatch(batch.second);
+    }
+
+private:
+    typedef QList<QPair<QueryPtr, Item::List>> Batches;
+
+    Batches route(const Item::List &items, bool removed)
+    {
+        Batches batches;
+        foreach (const QueryPtr &query, m_globalQueries)
+            batches << qMakePair(query, items);
+
+        if (m_keyedQueries.isEmpty())
+            return batches;
+
+        QHash<QString, Item::List> itemsByKey;
+        QHash<QString, QSet<Item::Id>> idsByKey;
+        QSet<Item::Id> unknownIds;
+
+        foreach (const Item &item, items) {
+            const auto id = item.id();
+            QStringList keys = m_itemKeys->value(id);
+            // Got routed everywhere last time, so all the keyed queries
+            // need to hear about it again to drop it if needed
+            const bool wasUnknown = m_unknownIds.contains(id);
+
+            QStringList newKeys;
+            if (removed) {
+                m_itemKeys->remove(id);
+                m_unknownIds.remove(id);
+            } else if (!m_keys(item, newKeys)) {
+                m_unknownIds.insert(id);
+                unknownIds.insert(id);
+                continue;
+            } else {
+                QStringList trackedKeys;
+                foreach (const QString &key, newKeys) {
+                    if (!m_keyCounts.contains(key) || trackedKeys.contains(key))
+                        continue;
+                    trackedKeys << key;
+                    if (!keys.contains(key))
+                        keys << key;
+                }
+
+                if (trackedKeys.isEmpty())
+                    m_itemKeys->remove(id);
+                else
+                    m_itemKeys->insert(id, trackedKeys);
+                m_unknownIds.remove(id);
+            }
+
+            if (wasUnknown) {
+                unknownIds.insert(id);
+                continue;
+            }
+
+            foreach (const QString &key, keys) {
+                itemsByKey[key] << item;
+                idsByKey[key].insert(id);
+            }
+        }
+
+        foreach (const auto &keyedQuery, m_keyedQueries) {
+            if (!unknownIds.isEmpty()) {
+                // Keep the notification order for the items we couldn't route
+                Item::List queryItems;
+                const QSet<Item::Id> keyedIds = idsByKey.value(keyedQuery.first);
+                foreach (const Item &item, items) {
+                    if (unknownIds.contains(item.id()) || keyedIds.contains(item.id()))
+                        queryItems << item;
+                }
+                batches << qMakePair(keyedQuery.second, queryItems);
+            } else if (itemsByKey.contains(keyedQuery.first)) {
+                batches << qMakePair(keyedQuery.second, itemsByKey.value(keyedQuery.first));
+            }
+        }
+
+        return batches;
+    }
+
+    KeysFunction m_keys;
+
+    QList<QueryPtr> m_globalQueries;
+    QList<QPair<QString, QueryPtr>> m_keyedQueries;
+    QHash<QString, int> m_keyCounts;
+    // Items whose keys couldn't be determined, they got routed everywhere
+    QSet<Item::Id> m_unknownIds;
+
+    // Shared with the fetch functions which might outlive us
+    QSharedPointer<QHash<Item::Id, QStringList>> m_itemKeys;
+};
+
+}
+
+#endif // AKONADI_QUERYROUTER_H
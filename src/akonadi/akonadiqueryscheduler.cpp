@@ -0,0 +1,79 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include "akonadiqueryscheduler.h"
+
+#include "utils/jobhandler.h"
+#include "utils/timeslicer.h"
+#include "utils/tracer.h"
+
+using namespace Akonadi;
+
+void QueryScheduler::install()
+{
+    static const bool installed = [] {
+        Domain::QueryScheduler::setInstance(Domain::QueryScheduler::Ptr(new QueryScheduler));
+        return true;
+    }();
+    Q_UNUSED(installed);
+}
+
+void QueryScheduler::fetch(const void *owner, const QString &name, const Work &fetch)
+{
+    Utils::Tracer::Span span("query", "fetch");
+    span.setArg(QStringLiteral("query"), name);
+    span.setArg(QStringLiteral("owner"), Utils::Tracer::ownerId(owner));
+
+    Utils::JobHandler::OwnerScope scope(owner);
+    fetch();
+}
+
+void QueryScheduler::abandon(const void *owner)
+{
+    Utils::JobHandler::abandon(owner);
+}
+
+void QueryScheduler::post(const void *owner, const Work &work)
+{
+    Utils::TimeSlicer::post(owner, work);
+}
+
+int QueryScheduler::pendingCount(const void *owner) const
+{
+    return Utils::TimeSlicer::pendingCount(owner);
+}
+
+void QueryScheduler::promote(const void *owner)
+{
+    Utils::TimeSlicer::promote(owner);
+}
+
+void QueryScheduler::cancel(const void *owner)
+{
+    Utils::TimeSlicer::cancel(owner);
+}
+
+void QueryScheduler::release(const void *owner)
+{
+    Utils::TimeSlicer::release(owner);
+}
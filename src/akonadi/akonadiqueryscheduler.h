@@ -0,0 +1,53 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef AKONADI_QUERYSCHEDULER_H
+#define AKONADI_QUERYSCHEDULER_H
+
+#include "domain/queryscheduler.h"
+
+namespace Akonadi {
+
+// Schedules the live queries over our jobs: the jobs a fetch installs
+// through Utils::JobHandler belong to the query, the conversions go
+// through Utils::TimeSlicer and the fetches get traced
+class QueryScheduler : public Domain::QueryScheduler
+{
+public:
+    // Makes it the scheduler of the live queries, done by our queries
+    // before creating any
+    static void install();
+
+    void fetch(const void *owner, const QString &name, const Work &fetch) Q_DECL_OVERRIDE;
+    void abandon(const void *owner) Q_DECL_OVERRIDE;
+
+    void post(const void *owner, const Work &work) Q_DECL_OVERRIDE;
+    int pendingCount(const void *owner) const Q_DECL_OVERRIDE;
+    void promote(const void *owner) Q_DECL_OVERRIDE;
+    void cancel(const void *owner) Q_DECL_OVERRIDE;
+    void release(const void *owner) Q_DECL_OVERRIDE;
+};
+
+}
+
+#endif // AKONADI_QUERYSCHEDULER_H
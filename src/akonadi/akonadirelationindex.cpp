@@ -0,0 +1,319 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+
+#include "akonadirelationindex.h"
+
+#include <algorithm>
+
+#include <QQueue>
+
+#include <KJob>
+
+#include "akonadiitemfetchjobinterface.h"
+
+#include "utils/jobhandler.h"
+
+using namespace Akonadi;
+
+RelationIndex::RelationIndex(const StorageInterface::Ptr &storage,
+                             const SerializerInterface::Ptr &serializer,
+                             const MonitorInterface::Ptr &monitor)
+    : m_storage(storage),
+      m_serializer(serializer),
+      m_monitor(monitor)
+{
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsMoved(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRevisionChanged(Akonadi::Item::List)), this, SLOT(onItemsRevisionChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(collectionRemoved(Akonadi::Collection)), this, SLOT(onCollectionRemoved(Akonadi::Collection)));
+}
+
+bool RelationIndex::isCollectionPopulated(Collection::Id id) const
+{
+    return m_populatedCollections.contains(id);
+}
+
+void RelationIndex::populateCollection(const Collection &collection, const PopulatedFunction &callback)
+{
+    if (isCollectionPopulated(collection.id())) {
+        callback(true);
+        return;
+    }
+
+    const bool pending = m_pendingCallbacks.contains(collection.id());
+    m_pendingCallbacks[collection.id()] << callback;
+    if (pending)
+        return;
+
+    ItemFetchJobInterface *job = m_storage->fetchItems(collection);
+    job->setItemsHandler([this] (const Akonadi::Item::List &items) {
+        for (auto item : items)
+            indexItem(item);
+    });
+
+    // Shared by all the queries, none of them gets to abandon it
+    Utils::JobHandler::OwnerScope scope(Q_NULLPTR);
+    Utils::JobHandler::install(job->kjob(), [this, job, collection] {
+        const auto callbacks = m_pendingCallbacks.take(collection.id());
+        const bool populated = job->kjob()->error() == KJob::NoError;
+
+        if (populated) {
+            m_populatedCollections.insert(collection.id());
+            // Replayed in order, the latest version of the items wins
+            foreach (const auto &notification, m_notifications)
+                applyNotification(notification.first, notification.second);
+        } else {
+            // Only part of them made it, better not know them at all
+            foreach (Item::Id id, m_collectionItems.value(collection.id()))
+                unindexItem(id);
+            m_collectionItems.remove(collection.id());
+        }
+
+        if (m_pendingCallbacks.isEmpty())
+            m_notifications.clear();
+
+        for (auto callback : callbacks)
+            callback(populated);
+    });
+}
+
+Item RelationIndex::item(Item::Id id) const
+{
+    return m_items.value(id);
+}
+
+Item RelationIndex::currentItem(Item::Id id) const
+{
+    if (m_monitor->hasPendingItemChanges(id))
+        return Item();
+
+    return m_items.value(id);
+}
+
+Item::Id RelationIndex::itemIdForUid(const QString &uid) const
+{
+    const int id = m_uidIds.value(uid, -1);
+    return m_itemIdsByUid.value(id, -1);
+}
+
+QString RelationIndex::parentUid(Item::Id id) const
+{
+    const int uid = m_parentUidOfItems.value(id, -1);
+    return uid < 0 ? QString() : m_uids.at(uid);
+}
+
+Item::List RelationIndex::childItems(const QString &parentUid) const
+{
+    const int id = m_uidIds.value(parentUid, -1);
+    if (id < 0)
+        return Item::List();
+
+    // Sorted to get a stable order between runs
+    auto childIds = m_childIdsByUid.value(id).toList();
+    std::sort(childIds.begin(), childIds.end());
+
+    Item::List children;
+    foreach (Item::Id childId, childIds)
+        children << m_items.value(childId);
+    return children;
+}
+
+Item::List RelationIndex::descendantItems(Item::Id id) const
+{
+    if (!m_items.contains(id))
+        return Item::List();
+
+    const auto collectionId = m_items.value(id).parentCollection().id();
+
+    Item::List descendants;
+    QSet<Item::Id> visitedIds;
+    visitedIds.insert(id);
+    QQueue<Item::Id> queue;
+    queue.enqueue(id);
+
+    while (!queue.isEmpty()) {
+        const auto parentId = queue.dequeue();
+        if (!m_uidOfItems.contains(parentId))
+            continue;
+
+        // Sorted to get a stable order between runs
+        auto childIds = m_childIdsByUid.value(m_uidOfItems.value(parentId)).toList();
+        std::sort(childIds.begin(), childIds.end());
+
+        foreach (Item::Id childId, childIds) {
+            const auto child = m_items.value(childId);
+            if (visitedIds.contains(childId) || child.parentCollection().id() != collectionId)
+                continue;
+
+            visitedIds.insert(childId);
+            descendants << child;
+            queue.enqueue(childId);
+        }
+    }
+
+    return descendants;
+}
+
+Item::List RelationIndex::collectionItems(Collection::Id id) const
+{
+    // Sorted to get a stable order between runs
+    auto itemIds = m_collectionItems.value(id).toList();
+    std::sort(itemIds.begin(), itemIds.end());
+
+    Item::List items;
+    foreach (Item::Id itemId, itemIds)
+        items << m_items.value(itemId);
+    return items;
+}
+
+void RelationIndex::onItemsAdded(const Item::List &items)
+{
+    notify(ItemsAdded, items);
+}
+
+void RelationIndex::onItemsRemoved(const Item::List &items)
+{
+    notify(ItemsRemoved, items);
+}
+
+void RelationIndex::onItemsChanged(const Item::List &items)
+{
+    notify(ItemsChanged, items);
+}
+
+void RelationIndex::onItemsRevisionChanged(const Item::List &items)
+{
+    notify(ItemsRevisionChanged, items);
+}
+
+void RelationIndex::notify(NotificationType type, const Item::List &items)
+{
+    if (!m_pendingCallbacks.isEmpty())
+        m_notifications << qMakePair(type, items);
+
+    applyNotification(type, items);
+}
+
+void RelationIndex::applyNotification(NotificationType type, const Item::List &items)
+{
+    switch (type) {
+    case ItemsAdded:
+        foreach (const Item &item, items) {
+            if (isCollectionPopulated(item.parentCollection().id()))
+                indexItem(item);
+        }
+        break;
+    case ItemsRemoved:
+        foreach (const Item &item, items)
+            unindexItem(item.id());
+        break;
+    case ItemsChanged:
+        // Also covers moves, the items might have left a populated collection
+        foreach (const Item &item, items) {
+            if (isCollectionPopulated(item.parentCollection().id()))
+                indexItem(item);
+            else
+                unindexItem(item.id());
+        }
+        break;
+    case ItemsRevisionChanged:
+        // Nothing we index changed, only the copies need to stay current
+        foreach (const Item &item, items) {
+            auto it = m_items.find(item.id());
+            if (it != m_items.end())
+                it->setRevision(item.revision());
+        }
+        break;
+    }
+}
+
+void RelationIndex::onCollectionRemoved(const Collection &collection)
+{
+    m_populatedCollections.remove(collection.id());
+    foreach (Item::Id id, m_collectionItems.value(collection.id()))
+        unindexItem(id);
+    m_collectionItems.remove(collection.id());
+}
+
+int RelationIndex::uidId(const QString &uid)
+{
+    auto it = m_uidIds.constFind(uid);
+    if (it != m_uidIds.constEnd())
+        return *it;
+
+    const int id = m_uidIds.size();
+    m_uidIds.insert(uid, id);
+    m_uids << uid;
+    return id;
+}
+
+void RelationIndex::indexItem(const Item &item)
+{
+    unindexItem(item.id());
+
+    m_items.insert(item.id(), item);
+    m_collectionItems[item.parentCollection().id()].insert(item.id());
+
+    const QString uid = m_serializer->itemUid(item);
+    if (!uid.isEmpty()) {
+        const int id = uidId(uid);
+        m_uidOfItems.insert(item.id(), id);
+        m_itemIdsByUid.insert(id, item.id());
+    }
+
+    const QString parentUid = m_serializer->relatedUidFromItem(item);
+    if (!parentUid.isEmpty()) {
+        const int id = uidId(parentUid);
+        m_parentUidOfItems.insert(item.id(), id);
+        m_childIdsByUid[id].insert(item.id());
+    }
+}
+
+void RelationIndex::unindexItem(Item::Id id)
+{
+    auto it = m_items.find(id);
+    if (it == m_items.end())
+        return;
+
+    const Collection::Id collectionId = it->parentCollection().id();
+    m_collectionItems[collectionId].remove(id);
+    m_items.erase(it);
+
+    if (m_uidOfItems.contains(id)) {
+        const int uid = m_uidOfItems.take(id);
+        if (m_itemIdsByUid.value(uid) == id)
+            m_itemIdsByUid.remove(uid);
+    }
+
+    if (m_parentUidOfItems.contains(id)) {
+        const int parentUid = m_parentUidOfItems.take(id);
+        auto children = m_childIdsByUid.find(parentUid);
+        children->remove(id);
+        if (children->isEmpty())
+            m_childIdsByUid.erase(children);
+    }
+}
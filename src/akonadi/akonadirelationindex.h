@@ -0,0 +1,118 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#ifndef AKONADI_RELATIONINDEX_H
+#define AKONADI_RELATIONINDEX_H
+
+#include <functional>
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <AkonadiCore/Collection>
+#include <AkonadiCore/Item>
+
+#include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadiserializerinterface.h"
+#include "akonadi/akonadistorageinterface.h"
+
+namespace Akonadi {
+
+class RelationIndex : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<RelationIndex> Ptr;
+    typedef std::function<void(bool)> PopulatedFunction;
+
+    RelationIndex(const StorageInterface::Ptr &storage,
+                  const SerializerInterface::Ptr &serializer,
+                  const MonitorInterface::Ptr &monitor);
+
+    bool isCollectionPopulated(Collection::Id id) const;
+
+    // Fetches the items of collection once, callback is called with true
+    // as soon as the index knows all of them (immediately if it already
+    // does), with false if the fetch failed. The next call tries again then
+    void populateCollection(const Collection &collection, const PopulatedFunction &callback);
+
+    Item item(Item::Id id) const;
+    // Same as item() but invalid while the monitor holds back changes
+    // of the item, the copy is not recent enough to be written back then
+    Item currentItem(Item::Id id) const;
+    Item::Id itemIdForUid(const QString &uid) const;
+    QString parentUid(Item::Id id) const;
+    Item::List childItems(const QString &parentUid) const;
+    // Descendants of the given item living in the same collection
+    Item::List descendantItems(Item::Id id) const;
+    Item::List collectionItems(Collection::Id id) const;
+
+private slots:
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
+    void onItemsRevisionChanged(const Akonadi::Item::List &items);
+    void onCollectionRemoved(const Akonadi::Collection &collection);
+
+private:
+    enum NotificationType {
+        ItemsAdded,
+        ItemsRemoved,
+        ItemsChanged,
+        ItemsRevisionChanged
+    };
+
+    void notify(NotificationType type, const Item::List &items);
+    void applyNotification(NotificationType type, const Item::List &items);
+    int uidId(const QString &uid);
+    void indexItem(const Item &item);
+    void unindexItem(Item::Id id);
+
+    StorageInterface::Ptr m_storage;
+    SerializerInterface::Ptr m_serializer;
+    MonitorInterface::Ptr m_monitor;
+
+    QHash<QString, int> m_uidIds;
+    QStringList m_uids;
+    QHash<int, Item::Id> m_itemIdsByUid;
+    QHash<int, QSet<Item::Id>> m_childIdsByUid;
+
+    QHash<Item::Id, Item> m_items;
+    QHash<Item::Id, int> m_uidOfItems;
+    QHash<Item::Id, int> m_parentUidOfItems;
+
+    QHash<Collection::Id, QSet<Item::Id>> m_collectionItems;
+    QSet<Collection::Id> m_populatedCollections;
+    QHash<Collection::Id, QList<PopulatedFunction>> m_pendingCallbacks;
+    // Received while populating, the fetched items might predate them
+    QList<QPair<NotificationType, Item::List>> m_notifications;
+};
+
+}
+
+#endif // AKONADI_RELATIONINDEX_H
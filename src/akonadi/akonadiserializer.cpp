@@ -25,6 +25,8 @@
 
 #include "akonadiserializer.h"
 
+#include <QQueue>
+
 #include <AkonadiCore/Collection>
 #include <AkonadiCore/EntityDisplayAttribute>
 #include <AkonadiCore/Item>
@@ -298,6 +300,34 @@ QString Serializer::relatedUidFromItem(Akonadi::Item item)
     }
 }
 
+QString Serializer::itemUid(Item item)
+{
+    if (!isTaskItem(item))
+        return QString();
+
+    const auto todo = item.payload<KCalCore::Todo::Ptr>();
+    return todo->uid();
+}
+
+Akonadi::Item Serializer::cloneItem(Akonadi::Item item)
+{
+    // Payloads are shared between item copies, detach them so that
+    // modifying the clone leaves the original untouched
+    if (isTaskItem(item)) {
+        const auto todo = item.payload<KCalCore::Todo::Ptr>();
+        item.setPayload(KCalCore::Todo::Ptr(todo->clone()));
+
+    } else if (isNoteItem(item)) {
+        const auto message = item.payload<KMime::Message::Ptr>();
+        auto clone = KMime::Message::Ptr::create();
+        clone->setContent(message->encodedContent());
+        clone->parse();
+        item.setPayload(clone);
+    }
+
+    return item;
+}
+
 void Serializer::updateItemParent(Akonadi::Item item, Domain::Task::Ptr parent)
 {
     if (!isTaskItem(item))
@@ -353,26 +383,38 @@ Akonadi::Item::List Serializer::filterDescendantItems(const Akonadi::Item::List
     if (potentialChildren.isEmpty())
         return Akonadi::Item::List();
 
-    Akonadi::Item::List itemsToProcess = potentialChildren;
     Q_ASSERT(ancestorItem.isValid() && ancestorItem.hasPayload<KCalCore::Todo::Ptr>());
     KCalCore::Todo::Ptr todo = ancestorItem.payload<KCalCore::Todo::Ptr>();
 
-    const auto bound = std::partition(itemsToProcess.begin(), itemsToProcess.end(),
-                                      [ancestorItem, todo](Akonadi::Item currentItem) {
-                                          return (!currentItem.hasPayload<KCalCore::Todo::Ptr>()
-                                               || currentItem == ancestorItem
-                                               || currentItem.payload<KCalCore::Todo::Ptr>()->relatedTo() != todo->uid());
-                                      });
-
-    Akonadi::Item::List itemsRemoved;
-    std::copy(itemsToProcess.begin(), bound, std::back_inserter(itemsRemoved));
-    itemsToProcess.erase(itemsToProcess.begin(), bound);
-
-    auto result = std::accumulate(itemsToProcess.begin(), itemsToProcess.end(), Akonadi::Item::List(),
-                                 [this, itemsRemoved](Akonadi::Item::List result, Akonadi::Item currentItem) {
-                                     result << currentItem;
-                                     return result += filterDescendantItems(itemsRemoved, currentItem);
-                                 });
+    QHash<QString, Akonadi::Item::List> childrenByParentUid;
+    foreach (const Akonadi::Item &item, potentialChildren) {
+        if (item == ancestorItem || !item.hasPayload<KCalCore::Todo::Ptr>())
+            continue;
+
+        const QString relatedUid = item.payload<KCalCore::Todo::Ptr>()->relatedTo();
+        if (!relatedUid.isEmpty())
+            childrenByParentUid[relatedUid] << item;
+    }
+
+    // Breadth first walk, each uid is visited only once so cycles end the walk
+    Akonadi::Item::List result;
+    QSet<QString> visitedUids;
+    QQueue<QString> uidsToVisit;
+    visitedUids.insert(todo->uid());
+    uidsToVisit.enqueue(todo->uid());
+
+    while (!uidsToVisit.isEmpty()) {
+        const QString uid = uidsToVisit.dequeue();
+        foreach (const Akonadi::Item &child, childrenByParentUid.value(uid)) {
+            result << child;
+
+            const QString childUid = child.payload<KCalCore::Todo::Ptr>()->uid();
+            if (!childUid.isEmpty() && !visitedUids.contains(childUid)) {
+                visitedUids.insert(childUid);
+                uidsToVisit.enqueue(childUid);
+            }
+        }
+    }
 
     return result;
 }
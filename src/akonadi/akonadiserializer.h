@@ -58,6 +58,8 @@ public:
     Akonadi::Item createItemFromTask(Domain::Task::Ptr task) Q_DECL_OVERRIDE;
     bool isTaskChild(Domain::Task::Ptr task, Akonadi::Item item) Q_DECL_OVERRIDE;
     QString relatedUidFromItem(Akonadi::Item item) Q_DECL_OVERRIDE;
+    QString itemUid(Akonadi::Item item) Q_DECL_OVERRIDE;
+    Akonadi::Item cloneItem(Akonadi::Item item) Q_DECL_OVERRIDE;
     void updateItemParent(Akonadi::Item item, Domain::Task::Ptr parent) Q_DECL_OVERRIDE;
     void updateItemProject(Akonadi::Item item, Domain::Project::Ptr project) Q_DECL_OVERRIDE;
     void removeItemParent(Akonadi::Item item) Q_DECL_OVERRIDE;
@@ -25,6 +25,11 @@
 #include "akonadistorage.h"
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include <QPointer>
+#include <QTimer>
 
 #include <KCalCore/Todo>
 
@@ -47,67 +52,95 @@
 #include "akonadi/akonadicollectionfetchjobinterface.h"
 #include "akonadi/akonadicollectionsearchjobinterface.h"
 #include "akonadi/akonadiitemfetchjobinterface.h"
+#include "akonadi/akonadilockedserializerplugin.h"
 #include "akonadi/akonaditagfetchjobinterface.h"
 #include "akonadi/akonadistoragesettings.h"
 
+#include "utils/tracer.h"
+
 using namespace Akonadi;
 
+// Replaces the dummy parents in the ancestor chains with proper ones
+// full of juicy data, each chain being built only once
+static Collection::List reconstructAncestors(const Collection::List &collections, const Collection &root)
+{
+    QHash<Collection::Id, Collection> collectionsMap;
+    collectionsMap.insert(root.id(), root);
+    for (auto collection : collections)
+        collectionsMap.insert(collection.id(), collection);
+
+    QHash<Collection::Id, Collection> chains;
+    chains.insert(root.id(), root);
+
+    std::function<Collection(const Collection&)> reconstruct =
+    [&collectionsMap, &chains, &reconstruct] (const Collection &collection) -> Collection {
+        Q_ASSERT(collection.isValid());
+
+        auto it = chains.constFind(collection.id());
+        if (it != chains.constEnd())
+            return *it;
+
+        auto parent = collection.parentCollection();
+        auto result = collection;
+        result.setParentCollection(reconstruct(collectionsMap.value(parent.id())));
+        chains.insert(collection.id(), result);
+        return result;
+    };
+
+    Collection::List result;
+    result.reserve(collections.size());
+    std::transform(collections.begin(), collections.end(),
+                   std::back_inserter(result), reconstruct);
+    return result;
+}
+
+static bool hasAllowedMimeTypes(const Collection &collection, const QSet<QString> &allowedMimeTypes)
+{
+    const auto mimeTypes = collection.contentMimeTypes();
+    return std::any_of(mimeTypes.constBegin(), mimeTypes.constEnd(),
+                       [&allowedMimeTypes] (const QString &mimeType) {
+                           return allowedMimeTypes.contains(mimeType);
+                       });
+}
+
 class CollectionJob : public CollectionFetchJob, public CollectionFetchJobInterface
 {
 public:
     CollectionJob(const Collection &collection, Type type = FirstLevel, QObject *parent = Q_NULLPTR)
         : CollectionFetchJob(collection, type, parent),
-          m_collection(collection)
+          m_collection(collection),
+          m_collectionsComputed(false)
     {
     }
 
     Collection::List collections() const Q_DECL_OVERRIDE
     {
-        auto collections = CollectionFetchJob::collections();
+        if (m_collectionsComputed)
+            return m_collections;
 
-        // Memorize them to reconstruct the ancestor chain later
-        QMap<Collection::Id, Collection> collectionsMap;
-        collectionsMap[m_collection.id()] = m_collection;
-        for (auto collection : collections) {
-            collectionsMap[collection.id()] = collection;
-        }
+        auto collections = CollectionFetchJob::collections();
 
         // Why the hell isn't fetchScope() const and returning a reference???
         auto self = const_cast<CollectionJob*>(this);
         const auto allowedMimeTypes = self->fetchScope().contentMimeTypes().toSet();
 
+        // Filter after the reconstruction, the ancestors might not be allowed
+        collections = reconstructAncestors(collections, m_collection);
         collections.erase(std::remove_if(collections.begin(), collections.end(),
-                                         [allowedMimeTypes] (const Collection &collection) {
-                                            auto mimeTypes = collection.contentMimeTypes().toSet();
-                                            return mimeTypes.intersect(allowedMimeTypes).isEmpty();
+                                         [&allowedMimeTypes] (const Collection &collection) {
+                                            return !hasAllowedMimeTypes(collection, allowedMimeTypes);
                                          }),
                           collections.end());
 
-        // Replace the dummy parents in the ancestor chain with proper ones
-        // full of juicy data
-        std::function<Collection(const Collection&)> reconstructAncestors =
-        [collectionsMap, &reconstructAncestors, this] (const Collection &collection) -> Collection {
-            Q_ASSERT(collection.isValid());
-
-            if (collection == m_collection)
-                return collection;
-
-            auto parent = collection.parentCollection();
-            auto reconstructedParent = reconstructAncestors(collectionsMap[parent.id()]);
-
-            auto result = collection;
-            result.setParentCollection(reconstructedParent);
-            return result;
-        };
-
-        std::transform(collections.begin(), collections.end(),
-                       collections.begin(), reconstructAncestors);
-
-        return collections;
+        m_collections = collections;
+        m_collectionsComputed = true;
+        return m_collections;
     }
 
 private:
     const Collection m_collection;
+    mutable Collection::List m_collections;
+    mutable bool m_collectionsComputed;
 };
 
 class CollectionSearchJob : public CollectionFetchJob, public CollectionSearchJobInterface
@@ -117,58 +150,149 @@ public:
         : CollectionFetchJob(Akonadi::Collection::root(),
                              CollectionJob::Recursive,
                              parent),
-          m_collectionName(collectionName)
+          m_collectionName(collectionName),
+          m_collectionsComputed(false)
     {
     }
 
     Collection::List collections() const Q_DECL_OVERRIDE
     {
-        auto collections = CollectionFetchJob::collections();
+        if (m_collectionsComputed)
+            return m_collections;
 
-        // Memorize them to reconstruct the ancestor chain later
-        QMap<Collection::Id, Collection> collectionsMap;
-        collectionsMap[Akonadi::Collection::root().id()] = Akonadi::Collection::root();
-        for (auto collection : collections) {
-            collectionsMap[collection.id()] = collection;
-        }
+        auto collections = CollectionFetchJob::collections();
 
         // Why the hell isn't fetchScope() const and returning a reference???
         auto self = const_cast<CollectionSearchJob*>(this);
         const auto allowedMimeTypes = self->fetchScope().contentMimeTypes().toSet();
 
+        collections = reconstructAncestors(collections, Akonadi::Collection::root());
         collections.erase(std::remove_if(collections.begin(), collections.end(),
-                                         [allowedMimeTypes, this] (const Collection &collection) {
-                                            auto mimeTypes = collection.contentMimeTypes().toSet();
-                                            return mimeTypes.intersect(allowedMimeTypes).isEmpty()
+                                         [&allowedMimeTypes, this] (const Collection &collection) {
+                                            return !hasAllowedMimeTypes(collection, allowedMimeTypes)
                                                 || !collection.displayName().contains(m_collectionName, Qt::CaseInsensitive);
                                          }),
                           collections.end());
 
-        // Replace the dummy parents in the ancestor chain with proper ones
-        // full of juicy data
-        std::function<Collection(const Collection&)> reconstructAncestors =
-        [collectionsMap, &reconstructAncestors, this] (const Collection &collection) -> Collection {
-            Q_ASSERT(collection.isValid());
+        m_collections = collections;
+        m_collectionsComputed = true;
+        return m_collections;
+    }
 
-            if (collection == Akonadi::Collection::root())
-                return collection;
+private:
+    QString m_collectionName;
+    mutable Collection::List m_collections;
+    mutable bool m_collectionsComputed;
+};
 
-            auto parent = collection.parentCollection();
-            auto reconstructedParent = reconstructAncestors(collectionsMap[parent.id()]);
+// Our own fetch jobs start on their own like the Akonadi ones do, and
+// whatever runs for them carries on without them once they get killed.
+// Like with the Akonadi ones the result never comes from start(), whoever
+// starts the job might not be waiting for it yet.
+class SelfStartingJob : public KJob
+{
+public:
+    SelfStartingJob()
+        : m_started(false)
+    {
+        setCapabilities(KJob::Killable);
+        QMetaObject::invokeMethod(this, "start", Qt::QueuedConnection);
+    }
 
-            auto result = collection;
-            result.setParentCollection(reconstructedParent);
-            return result;
-        };
+    // Might also be started explicitly, e.g. through exec()
+    void start() Q_DECL_OVERRIDE
+    {
+        if (m_started)
+            return;
+        m_started = true;
+        doStart();
+    }
 
-        std::transform(collections.begin(), collections.end(),
-                       collections.begin(), reconstructAncestors);
+protected:
+    virtual void doStart() = 0;
 
-        return collections;
+    bool doKill() Q_DECL_OVERRIDE
+    {
+        return true;
     }
 
 private:
-    QString m_collectionName;
+    bool m_started;
+};
+
+// Answers collection fetches or searches from a collection tree, the
+// first one to run lists all the collections to populate it
+template<typename Interface>
+class CachedCollectionJob : public SelfStartingJob, public Interface
+{
+public:
+    typedef std::function<Collection::List(const CollectionTree::Ptr &)> CollectFunction;
+
+    CachedCollectionJob(const CollectionTree::Ptr &tree,
+                        CollectionFetchScope::ListFilter listFilter,
+                        const CollectFunction &collect)
+        : m_tree(tree),
+          m_listFilter(listFilter),
+          m_collect(collect)
+    {
+    }
+
+    Collection::List collections() const Q_DECL_OVERRIDE
+    {
+        return m_collections;
+    }
+
+protected:
+    void doStart() Q_DECL_OVERRIDE
+    {
+        if (m_tree->isPopulated()) {
+            QTimer::singleShot(0, this, [this] { onTreePopulated(true); });
+            return;
+        }
+
+        QPointer<CachedCollectionJob> self(this);
+        const bool mustList = m_tree->waitForPopulation([self] (bool success) {
+            if (self)
+                self->onTreePopulated(success);
+        });
+
+        if (!mustList)
+            return;
+
+        auto tree = m_tree;
+        auto job = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive);
+        auto scope = job->fetchScope();
+        scope.setContentMimeTypes(QStringList() << NoteUtils::noteMimeType() << KCalCore::Todo::todoMimeType());
+        scope.setIncludeStatistics(true);
+        scope.setAncestorRetrieval(CollectionFetchScope::All);
+        scope.setListFilter(m_listFilter);
+        job->setFetchScope(scope);
+        QObject::connect(job, &KJob::result, tree.data(), [tree, job] {
+            if (job->error() != KJob::NoError)
+                tree->setPopulationFailed();
+            else
+                tree->setCollections(job->collections());
+        });
+    }
+
+private:
+    void onTreePopulated(bool success)
+    {
+        if (!success) {
+            setError(KJob::UserDefinedError);
+            setErrorText(QStringLiteral("Couldn't list the collections"));
+            emitResult();
+            return;
+        }
+
+        m_collections = m_collect(m_tree);
+        emitResult();
+    }
+
+    CollectionTree::Ptr m_tree;
+    const CollectionFetchScope::ListFilter m_listFilter;
+    const CollectFunction m_collect;
+    Collection::List m_collections;
 };
 
 class ItemJob : public ItemFetchJob, public ItemFetchJobInterface
@@ -177,6 +301,268 @@ public:
     using ItemFetchJob::ItemFetchJob;
 
     Item::List items() const Q_DECL_OVERRIDE { return ItemFetchJob::items(); }
+
+    void setItemsHandler(const ItemsHandler &handler) Q_DECL_OVERRIDE
+    {
+        Q_ASSERT(handler);
+        Q_ASSERT(!m_handler);
+
+        m_handler = handler;
+        setDeliveryOption(ItemFetchJob::EmitItemsInBatches);
+        connect(this, &ItemFetchJob::itemsReceived, this, [this] (const Akonadi::Item::List &items) {
+            m_handler(items);
+        });
+    }
+
+private:
+    ItemsHandler m_handler;
+};
+
+static ItemFetchScope itemFetchScope()
+{
+    ItemFetchScope scope;
+    scope.fetchFullPayload();
+    scope.fetchAllAttributes();
+    scope.setFetchTags(true);
+    scope.tagFetchScope().setFetchIdOnly(false);
+    scope.setAncestorRetrieval(ItemFetchScope::All);
+    return scope;
+}
+
+static void configureItemFetchJob(ItemJob *job)
+{
+    job->setFetchScope(itemFetchScope());
+}
+
+// Fetches the items of a collection through the fetch worker, only the
+// delivery of the decoded batches happens on our thread
+class ThreadedItemJob : public SelfStartingJob, public ItemFetchJobInterface
+{
+public:
+    ThreadedItemJob(const ItemFetchWorker::Ptr &worker, const Collection &collection)
+        : m_worker(worker),
+          m_collection(collection),
+          m_requestId(-1)
+    {
+    }
+
+    ~ThreadedItemJob()
+    {
+        if (m_requestId >= 0)
+            m_worker->cancel(m_requestId);
+    }
+
+    Item::List items() const Q_DECL_OVERRIDE
+    {
+        return m_items;
+    }
+
+    void setItemsHandler(const ItemsHandler &handler) Q_DECL_OVERRIDE
+    {
+        Q_ASSERT(handler);
+        Q_ASSERT(!m_handler);
+
+        m_handler = handler;
+    }
+
+protected:
+    void doStart() Q_DECL_OVERRIDE
+    {
+        // Only called while we're around, the destructor cancels the request
+        m_requestId = m_worker->fetchItems(m_collection,
+                                           [this] (const Akonadi::Item::List &items) {
+                                               if (m_handler)
+                                                   m_handler(items);
+                                               else
+                                                   m_items << items;
+                                           },
+                                           [this] (int error, const QString &errorText) {
+                                               if (error != KJob::NoError) {
+                                                   setError(error);
+                                                   setErrorText(errorText);
+                                               }
+                                               emitResult();
+                                           });
+    }
+
+private:
+    ItemFetchWorker::Ptr m_worker;
+    const Collection m_collection;
+    int m_requestId;
+    ItemsHandler m_handler;
+    Item::List m_items;
+};
+
+// Answers item fetches of a collection from an item cache, the first
+// fetch of a collection lists all its items to fill the cache, through
+// the fetch worker if any, while the fetches of a stale collection only
+// bring back the items which changed
+class CachedItemJob : public SelfStartingJob, public ItemFetchJobInterface
+{
+public:
+    CachedItemJob(const ItemCache::Ptr &cache,
+                  const ItemFetchWorker::Ptr &worker,
+                  const Collection &collection)
+        : m_cache(cache),
+          m_worker(worker),
+          m_collection(collection)
+    {
+    }
+
+    Item::List items() const Q_DECL_OVERRIDE
+    {
+        return m_items;
+    }
+
+    void setItemsHandler(const ItemsHandler &handler) Q_DECL_OVERRIDE
+    {
+        Q_ASSERT(handler);
+        Q_ASSERT(!m_handler);
+
+        m_handler = handler;
+    }
+
+protected:
+    void doStart() Q_DECL_OVERRIDE
+    {
+        const auto id = m_collection.id();
+        if (m_cache->isFetching(id))
+            waitForFetch();
+        else if (!m_cache->isCached(id))
+            fetchAllItems();
+        else if (m_cache->isStale(id))
+            fetchOutdatedItems();
+        else
+            QTimer::singleShot(0, this, [this, id] { finish(m_cache->items(id)); });
+    }
+
+private:
+    // Another job is already on it, we get the items once it's done
+    void waitForFetch()
+    {
+        const auto id = m_collection.id();
+        auto cache = m_cache;
+
+        QPointer<CachedItemJob> self(this);
+        cache->waitForFetch(id, [self, cache, id] (bool success) {
+            if (!self)
+                return;
+
+            if (!success) {
+                self->setError(KJob::UserDefinedError);
+                self->setErrorText(QStringLiteral("Couldn't fetch the items"));
+                self->emitResult();
+                return;
+            }
+
+            self->finish(cache->items(id));
+        });
+    }
+
+    void fetchAllItems()
+    {
+        const auto id = m_collection.id();
+        auto cache = m_cache;
+        cache->beginFetch(id);
+
+        QPointer<CachedItemJob> self(this);
+        auto fetchedItems = QSharedPointer<Item::List>::create();
+
+        ItemFetchJobInterface *job = Q_NULLPTR;
+        if (m_worker) {
+            job = new ThreadedItemJob(m_worker, m_collection);
+        } else {
+            auto itemJob = new ItemJob(m_collection);
+            configureItemFetchJob(itemJob);
+            job = itemJob;
+        }
+
+        // Still deliver the items in batches while they arrive
+        job->setItemsHandler([self, fetchedItems] (const Item::List &items) {
+            *fetchedItems << items;
+            if (self && self->m_handler)
+                self->m_handler(items);
+        });
+        // The cache is filled even if nobody waits for the items anymore
+        QObject::connect(job->kjob(), &KJob::result, cache.data(), [self, cache, id, job, fetchedItems] {
+            if (job->kjob()->error() != KJob::NoError) {
+                cache->cancelFetch(id);
+                if (self)
+                    self->fail(job->kjob());
+                return;
+            }
+
+            cache->setItems(id, *fetchedItems);
+            if (self)
+                self->finish(*fetchedItems, false);
+        });
+    }
+
+    void fetchOutdatedItems()
+    {
+        const auto id = m_collection.id();
+        auto cache = m_cache;
+        cache->beginFetch(id);
+
+        QPointer<CachedItemJob> self(this);
+
+        // Without payload nor attributes we only get the ids and revisions
+        auto listJob = new ItemFetchJob(m_collection);
+        QObject::connect(listJob, &KJob::result, cache.data(), [self, cache, id, listJob] {
+            if (listJob->error() != KJob::NoError) {
+                cache->cancelFetch(id);
+                if (self)
+                    self->fail(listJob);
+                return;
+            }
+
+            const auto listedItems = listJob->items();
+            const auto outdatedItems = cache->outdatedItems(id, listedItems);
+            if (outdatedItems.isEmpty()) {
+                cache->updateItems(id, listedItems, Item::List());
+                if (self)
+                    self->finish(cache->items(id));
+                return;
+            }
+
+            auto job = new ItemJob(outdatedItems);
+            configureItemFetchJob(job);
+            QObject::connect(job, &KJob::result, cache.data(), [self, cache, id, listedItems, job] {
+                if (job->error() != KJob::NoError) {
+                    cache->cancelFetch(id);
+                    if (self)
+                        self->fail(job);
+                    return;
+                }
+
+                cache->updateItems(id, listedItems, job->items());
+                if (self)
+                    self->finish(cache->items(id));
+            });
+        });
+    }
+
+    void finish(const Item::List &items, bool deliver = true)
+    {
+        if (!m_handler)
+            m_items = items;
+        else if (deliver && !items.isEmpty())
+            m_handler(items);
+        emitResult();
+    }
+
+    void fail(KJob *job)
+    {
+        setError(job->error());
+        setErrorText(job->errorText());
+        emitResult();
+    }
+
+    ItemCache::Ptr m_cache;
+    ItemFetchWorker::Ptr m_worker;
+    const Collection m_collection;
+    ItemsHandler m_handler;
+    Item::List m_items;
 };
 
 class TagJob : public TagFetchJob, public TagFetchJobInterface
@@ -187,8 +573,71 @@ public:
     Tag::List tags() const Q_DECL_OVERRIDE { return TagFetchJob::tags(); }
 };
 
-Storage::Storage()
+static QVariantMap traceArgs(const char *key, qint64 value)
 {
+    QVariantMap args;
+    args.insert(QString::fromLatin1(key), value);
+    return args;
+}
+
+static QVariantMap traceArgs(const char *key1, qint64 value1, const char *key2, qint64 value2)
+{
+    auto args = traceArgs(key1, value1);
+    args.insert(QString::fromLatin1(key2), value2);
+    return args;
+}
+
+// Traced from creation, Akonadi jobs don't wait to be started and
+// queue on the server, so the span covers the latency we see
+static KJob *traced(KJob *job, const char *name, const QVariantMap &args = QVariantMap())
+{
+    Utils::Tracer::traceJob(job, "storage", name, args);
+    return job;
+}
+
+static int resultCount(ItemFetchJobInterface *job)
+{
+    return job->items().size();
+}
+
+static int resultCount(CollectionFetchJobInterface *job)
+{
+    return job->collections().size();
+}
+
+static int resultCount(CollectionSearchJobInterface *job)
+{
+    return job->collections().size();
+}
+
+static int resultCount(TagFetchJobInterface *job)
+{
+    return job->tags().size();
+}
+
+template<typename Interface>
+static Interface *tracedFetch(Interface *job, const char *name, const QVariantMap &args = QVariantMap())
+{
+    Utils::Tracer::traceJob(job->kjob(), "storage", name, args, [job] (KJob *) {
+        return traceArgs("count", resultCount(job));
+    });
+    return job;
+}
+
+Storage::Storage(const MonitorInterface::Ptr &monitor, Features features)
+{
+    if (!monitor)
+        return;
+
+    if (features & Caches) {
+        m_collectionTree = CollectionTree::Ptr::create(monitor);
+        m_searchTree = CollectionTree::Ptr::create(monitor, CollectionTree::AllCollections);
+        m_itemCache = ItemCache::Ptr::create(monitor);
+    }
+
+    // Without the locked plugin the payloads can only be dealt with here
+    if ((features & FetchWorker) && LockedSerializerPlugin::install())
+        m_itemFetchWorker = ItemFetchWorker::Ptr::create(itemFetchScope());
 }
 
 Storage::~Storage()
@@ -207,57 +656,66 @@ Collection Storage::defaultNoteCollection()
 
 KJob *Storage::createItem(Item item, Collection collection)
 {
-    return new ItemCreateJob(item, collection);
+    return traced(new ItemCreateJob(item, collection), "createItem",
+                  traceArgs("collection", collection.id()));
 }
 
 KJob *Storage::updateItem(Item item, QObject *parent)
 {
-    return new ItemModifyJob(item, parent);
+    return traced(new ItemModifyJob(item, parent), "updateItem",
+                  traceArgs("item", item.id()));
 }
 
 KJob *Storage::removeItem(Item item)
 {
-    return new ItemDeleteJob(item);
+    return traced(new ItemDeleteJob(item), "removeItem",
+                  traceArgs("item", item.id()));
 }
 
 KJob *Storage::removeItems(Item::List items, QObject *parent)
 {
-    return new ItemDeleteJob(items, parent);
+    return traced(new ItemDeleteJob(items, parent), "removeItems",
+                  traceArgs("items", items.size()));
 }
 
 KJob *Storage::moveItem(Item item, Collection collection, QObject *parent)
 {
-    return new ItemMoveJob(item, collection, parent);
+    return traced(new ItemMoveJob(item, collection, parent), "moveItem",
+                  traceArgs("item", item.id(), "collection", collection.id()));
 }
 
 KJob *Storage::moveItems(Item::List items, Collection collection, QObject *parent)
 {
-    return new ItemMoveJob(items, collection, parent);
+    return traced(new ItemMoveJob(items, collection, parent), "moveItems",
+                  traceArgs("items", items.size(), "collection", collection.id()));
 }
 
 KJob *Storage::updateCollection(Collection collection, QObject *parent)
 {
-    return new CollectionModifyJob(collection, parent);
+    return traced(new CollectionModifyJob(collection, parent), "updateCollection",
+                  traceArgs("collection", collection.id()));
 }
 
 KJob *Storage::createTransaction()
 {
-    return new TransactionSequence();
+    return traced(new TransactionSequence(), "transaction");
 }
 
 KJob *Storage::createTag(Tag tag)
 {
-    return new TagCreateJob(tag);
+    return traced(new TagCreateJob(tag), "createTag");
 }
 
 KJob *Storage::updateTag(Tag tag)
 {
-    return new TagModifyJob(tag);
+    return traced(new TagModifyJob(tag), "updateTag",
+                  traceArgs("tag", tag.id()));
 }
 
 KJob *Storage::removeTag(Tag tag)
 {
-    return new Akonadi::TagDeleteJob(tag);
+    return traced(new Akonadi::TagDeleteJob(tag), "removeTag",
+                  traceArgs("tag", tag.id()));
 }
 
 CollectionFetchJobInterface *Storage::fetchCollections(Collection collection, StorageInterface::FetchDepth depth, FetchContentTypes types)
@@ -271,6 +729,23 @@ CollectionFetchJobInterface *Storage::fetchCollections(Collection collection, St
 
     Q_ASSERT(!contentMimeTypes.isEmpty());
 
+    const auto args = traceArgs("collection", collection.id(), "depth", depth);
+
+    if (m_collectionTree && depth == Recursive) {
+        const auto allowedMimeTypes = contentMimeTypes.toSet();
+        auto job = new CachedCollectionJob<CollectionFetchJobInterface>(m_collectionTree,
+                                                                        CollectionFetchScope::Display,
+                                                                        [collection, allowedMimeTypes] (const CollectionTree::Ptr &tree) {
+            Collection::List result;
+            foreach (const Collection &descendant, tree->descendants(collection.id())) {
+                if (hasAllowedMimeTypes(descendant, allowedMimeTypes))
+                    result << descendant;
+            }
+            return result;
+        });
+        return tracedFetch<CollectionFetchJobInterface>(job, "fetchCollections", args);
+    }
+
     auto job = new CollectionJob(collection, jobTypeFromDepth(depth));
 
     auto scope = job->fetchScope();
@@ -280,7 +755,7 @@ CollectionFetchJobInterface *Storage::fetchCollections(Collection collection, St
     scope.setListFilter(Akonadi::CollectionFetchScope::Display);
     job->setFetchScope(scope);
 
-    return job;
+    return tracedFetch<CollectionFetchJobInterface>(job, "fetchCollections", args);
 }
 
 CollectionSearchJobInterface *Storage::searchCollections(QString collectionName)
@@ -288,6 +763,21 @@ CollectionSearchJobInterface *Storage::searchCollections(QString collectionName)
     QStringList contentMimeTypes;
     contentMimeTypes << NoteUtils::noteMimeType() << KCalCore::Todo::todoMimeType();
 
+    if (m_searchTree) {
+        const auto allowedMimeTypes = contentMimeTypes.toSet();
+        auto job = new CachedCollectionJob<CollectionSearchJobInterface>(m_searchTree,
+                                                                         CollectionFetchScope::NoFilter,
+                                                                         [collectionName, allowedMimeTypes] (const CollectionTree::Ptr &tree) {
+            Collection::List result;
+            foreach (const Collection &collection, tree->search(collectionName)) {
+                if (hasAllowedMimeTypes(collection, allowedMimeTypes))
+                    result << collection;
+            }
+            return result;
+        });
+        return tracedFetch<CollectionSearchJobInterface>(job, "searchCollections");
+    }
+
     auto job = new CollectionSearchJob(collectionName);
 
     auto scope = job->fetchScope();
@@ -297,17 +787,25 @@ CollectionSearchJobInterface *Storage::searchCollections(QString collectionName)
     scope.setListFilter(Akonadi::CollectionFetchScope::NoFilter);
     job->setFetchScope(scope);
 
-    return job;
+    return tracedFetch<CollectionSearchJobInterface>(job, "searchCollections");
 }
 
 
 ItemFetchJobInterface *Storage::fetchItems(Collection collection)
 {
+    const auto args = traceArgs("collection", collection.id());
+
+    if (m_itemCache)
+        return tracedFetch<ItemFetchJobInterface>(new CachedItemJob(m_itemCache, m_itemFetchWorker, collection), "fetchItems", args);
+
+    if (m_itemFetchWorker)
+        return tracedFetch<ItemFetchJobInterface>(new ThreadedItemJob(m_itemFetchWorker, collection), "fetchItems", args);
+
     auto job = new ItemJob(collection);
 
     configureItemFetchJob(job);
 
-    return job;
+    return tracedFetch<ItemFetchJobInterface>(job, "fetchItems", args);
 }
 
 ItemFetchJobInterface *Storage::fetchItem(Akonadi::Item item)
@@ -316,7 +814,16 @@ ItemFetchJobInterface *Storage::fetchItem(Akonadi::Item item)
 
     configureItemFetchJob(job);
 
-    return job;
+    return tracedFetch<ItemFetchJobInterface>(job, "fetchItem", traceArgs("item", item.id()));
+}
+
+ItemFetchJobInterface *Storage::fetchItemList(Akonadi::Item::List items)
+{
+    auto job = new ItemJob(items);
+
+    configureItemFetchJob(job);
+
+    return tracedFetch<ItemFetchJobInterface>(job, "fetchItemList", traceArgs("items", items.size()));
 }
 
 ItemFetchJobInterface *Storage::fetchTagItems(Tag tag)
@@ -325,12 +832,12 @@ ItemFetchJobInterface *Storage::fetchTagItems(Tag tag)
 
     configureItemFetchJob(job);
 
-    return job;
+    return tracedFetch<ItemFetchJobInterface>(job, "fetchTagItems", traceArgs("tag", tag.id()));
 }
 
 TagFetchJobInterface *Storage::fetchTags()
 {
-    return new TagJob;
+    return tracedFetch<TagFetchJobInterface>(new TagJob, "fetchTags");
 }
 
 CollectionFetchJob::Type Storage::jobTypeFromDepth(StorageInterface::FetchDepth depth)
@@ -354,14 +861,3 @@ CollectionFetchJob::Type Storage::jobTypeFromDepth(StorageInterface::FetchDepth
 
     return jobType;
 }
-
-void Storage::configureItemFetchJob(ItemJob *job)
-{
-    auto scope = job->fetchScope();
-    scope.fetchFullPayload();
-    scope.fetchAllAttributes();
-    scope.setFetchTags(true);
-    scope.tagFetchScope().setFetchIdOnly(false);
-    scope.setAncestorRetrieval(ItemFetchScope::All);
-    job->setFetchScope(scope);
-}
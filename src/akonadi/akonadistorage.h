@@ -28,13 +28,30 @@
 
 #include <AkonadiCore/CollectionFetchJob>
 
-class ItemJob;
+#include "akonadi/akonadicollectiontree.h"
+#include "akonadi/akonadiitemcache.h"
+#include "akonadi/akonadiitemfetchworker.h"
+#include "akonadi/akonadimonitorinterface.h"
+
 namespace Akonadi {
 
 class Storage : public StorageInterface
 {
 public:
-    Storage();
+    enum Feature {
+        NoFeature = 0,
+        // Recursive collection fetches, searches and collection item
+        // fetches served from caches kept up to date with the monitor
+        Caches = 1,
+        // The items of the collections fetched on a worker thread
+        FetchWorker = 2,
+        AllFeatures = Caches | FetchWorker
+    };
+    Q_DECLARE_FLAGS(Features, Feature)
+
+    // Without a monitor everything goes straight to the server
+    explicit Storage(const MonitorInterface::Ptr &monitor = MonitorInterface::Ptr(),
+                     Features features = AllFeatures);
     virtual ~Storage();
 
     Akonadi::Collection defaultTaskCollection() Q_DECL_OVERRIDE;
@@ -59,14 +76,22 @@ public:
     CollectionSearchJobInterface *searchCollections(QString collectionName) Q_DECL_OVERRIDE;
     ItemFetchJobInterface *fetchItems(Akonadi::Collection collection) Q_DECL_OVERRIDE;
     ItemFetchJobInterface *fetchItem(Akonadi::Item item) Q_DECL_OVERRIDE;
+    ItemFetchJobInterface *fetchItemList(Akonadi::Item::List items) Q_DECL_OVERRIDE;
     ItemFetchJobInterface *fetchTagItems(Akonadi::Tag tag) Q_DECL_OVERRIDE;
     TagFetchJobInterface *fetchTags() Q_DECL_OVERRIDE;
 
 private:
     CollectionFetchJob::Type jobTypeFromDepth(StorageInterface::FetchDepth depth);
-    void configureItemFetchJob(ItemJob *job);
+
+    CollectionTree::Ptr m_collectionTree;
+    // Also knows the collections which aren't displayed, to search them
+    CollectionTree::Ptr m_searchTree;
+    ItemCache::Ptr m_itemCache;
+    ItemFetchWorker::Ptr m_itemFetchWorker;
 };
 
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Akonadi::Storage::Features)
+
 #endif // AKONADI_STORAGE_H
@@ -83,6 +83,7 @@ public:
     virtual CollectionSearchJobInterface *searchCollections(QString collectionName) = 0;
     virtual ItemFetchJobInterface *fetchItems(Akonadi::Collection collection) = 0;
     virtual ItemFetchJobInterface *fetchItem(Akonadi::Item item) = 0;
+    virtual ItemFetchJobInterface *fetchItemList(Akonadi::Item::List items) = 0;
     virtual ItemFetchJobInterface *fetchTagItems(Akonadi::Tag tag) = 0;
     virtual TagFetchJobInterface *fetchTags() = 0;
 };
@@ -0,0 +1,362 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+
+#include "akonaditagindex.h"
+
+#include <algorithm>
+
+#include <KJob>
+
+#include "akonadicollectionfetchjobinterface.h"
+#include "akonadiserializerinterface.h"
+
+#include "utils/jobhandler.h"
+#include "utils/paralleljob.h"
+
+using namespace Akonadi;
+
+TagIndex::TagIndex(const StorageInterface::Ptr &storage,
+                   const RelationIndex::Ptr &relationIndex,
+                   const MonitorInterface::Ptr &monitor)
+    : m_storage(storage),
+      m_relationIndex(relationIndex),
+      m_monitor(monitor),
+      m_populated(false),
+      m_populating(false),
+      m_populatingCount(0),
+      m_populateFailed(false)
+{
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsMoved(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRevisionChanged(Akonadi::Item::List)), this, SLOT(onItemsRevisionChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsTagsChanged(Akonadi::Item::List,QSet<Akonadi::Tag>,QSet<Akonadi::Tag>)),
+            this, SLOT(onItemsTagsChanged(Akonadi::Item::List,QSet<Akonadi::Tag>,QSet<Akonadi::Tag>)));
+    connect(m_monitor.data(), SIGNAL(tagAdded(Akonadi::Tag)), this, SLOT(onTagAdded(Akonadi::Tag)));
+    connect(m_monitor.data(), SIGNAL(tagRemoved(Akonadi::Tag)), this, SLOT(onTagRemoved(Akonadi::Tag)));
+    connect(m_monitor.data(), SIGNAL(tagChanged(Akonadi::Tag)), this, SLOT(onTagChanged(Akonadi::Tag)));
+    connect(m_monitor.data(), SIGNAL(collectionRemoved(Akonadi::Collection)), this, SLOT(onCollectionRemoved(Akonadi::Collection)));
+}
+
+bool TagIndex::isPopulated() const
+{
+    return m_populated;
+}
+
+void TagIndex::populate(const PopulatedFunction &callback)
+{
+    if (m_populated) {
+        callback(true);
+        return;
+    }
+
+    const bool pending = !m_pendingCallbacks.isEmpty();
+    m_pendingCallbacks << callback;
+    if (pending)
+        return;
+
+    // Shared by all the queries, none of them gets to abandon it
+    Utils::JobHandler::OwnerScope scope(Q_NULLPTR);
+    CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
+                                                                   StorageInterface::Recursive,
+                                                                   StorageInterface::Tasks | StorageInterface::Notes);
+    Utils::JobHandler::install(job->kjob(), [this, job] {
+        if (job->kjob()->error() != KJob::NoError) {
+            notifyPopulated(false);
+            return;
+        }
+
+        m_collectionsToPopulate = job->collections();
+        m_populating = true;
+        m_populateFailed = false;
+        populateNextCollections();
+    });
+}
+
+void TagIndex::populateNextCollections()
+{
+    // Bound like the parallel jobs, the collections might already be
+    // populated though and call back right away
+    while (!m_collectionsToPopulate.isEmpty() && m_populatingCount < Utils::ParallelJob::defaultMaxRunningJobs()) {
+        const auto collection = m_collectionsToPopulate.takeFirst();
+        m_populatingCount++;
+        m_relationIndex->populateCollection(collection, [this, collection] (bool populated) {
+            m_populatingCount--;
+            if (populated) {
+                foreach (const Item &item, m_relationIndex->collectionItems(collection.id()))
+                    indexItem(item);
+            } else {
+                m_populateFailed = true;
+            }
+            populateNextCollections();
+        });
+    }
+
+    if (m_populating && m_populatingCount == 0 && m_collectionsToPopulate.isEmpty()) {
+        m_populating = false;
+        notifyPopulated(!m_populateFailed);
+    }
+}
+
+void TagIndex::notifyPopulated(bool populated)
+{
+    m_populated = populated;
+
+    const auto callbacks = m_pendingCallbacks;
+    m_pendingCallbacks.clear();
+    for (auto callback : callbacks)
+        callback(populated);
+}
+
+Item::List TagIndex::taggedItems(Tag::Id id) const
+{
+    // Sorted to get a stable order between runs
+    auto itemIds = m_taggedItems.value(id).toList();
+    std::sort(itemIds.begin(), itemIds.end());
+
+    Item::List items;
+    foreach (Item::Id itemId, itemIds)
+        items << m_items.value(itemId);
+    return items;
+}
+
+bool TagIndex::hasContextTags(const Item &item) const
+{
+    return hasTagOfType(item, m_contextMask, SerializerInterface::contextTagType());
+}
+
+bool TagIndex::hasPlainTags(const Item &item) const
+{
+    return hasTagOfType(item, m_plainMask, Akonadi::Tag::PLAIN);
+}
+
+void TagIndex::onItemsAdded(const Item::List &items)
+{
+    foreach (const Item &item, items)
+        indexItem(item);
+}
+
+void TagIndex::onItemsRemoved(const Item::List &items)
+{
+    foreach (const Item &item, items)
+        unindexItem(item.id());
+}
+
+void TagIndex::onItemsChanged(const Item::List &items)
+{
+    // We can't tell if the tags changed, they're cheap to index again
+    foreach (const Item &item, items)
+        indexItem(item);
+}
+
+void TagIndex::onItemsRevisionChanged(const Item::List &items)
+{
+    // The tags didn't change, only the copies need to stay current
+    foreach (const Item &item, items) {
+        auto it = m_items.find(item.id());
+        if (it != m_items.end())
+            it->setRevision(item.revision());
+    }
+}
+
+void TagIndex::onItemsTagsChanged(const Item::List &items, const QSet<Tag> &addedTags, const QSet<Tag> &removedTags)
+{
+    // Both sets are empty when a tag got removed, the items then only
+    // come with the tags they have left
+    if (addedTags.isEmpty() && removedTags.isEmpty()) {
+        onItemsChanged(items);
+        return;
+    }
+
+    foreach (const Item &item, items) {
+        foreach (const Tag &tag, removedTags) {
+            if (m_tagBits.contains(tag.id()))
+                setItemTagBit(item.id(), m_tagBits.value(tag.id()), false);
+        }
+
+        foreach (const Tag &tag, addedTags)
+            setItemTagBit(item.id(), tagBit(tag), true);
+
+        if (m_itemTags.value(item.id()).count(true) == 0)
+            unindexItem(item.id());
+        else
+            m_items.insert(item.id(), item);
+    }
+}
+
+void TagIndex::onTagAdded(const Tag &tag)
+{
+    tagBit(tag);
+}
+
+void TagIndex::onTagRemoved(const Tag &tag)
+{
+    if (!m_tagBits.contains(tag.id()))
+        return;
+
+    const int bit = m_tagBits.value(tag.id());
+    foreach (Item::Id id, m_taggedItems.value(tag.id())) {
+        setItemTagBit(id, bit, false);
+        if (m_itemTags.value(id).count(true) == 0)
+            unindexItem(id);
+        else
+            m_items[id].clearTag(tag);
+    }
+
+    m_tagBits.remove(tag.id());
+    m_bitTags[bit] = -1;
+    m_contextMask.clearBit(bit);
+    m_plainMask.clearBit(bit);
+    m_freeBits << bit;
+}
+
+void TagIndex::onTagChanged(const Tag &tag)
+{
+    if (m_tagBits.contains(tag.id()))
+        updateTagType(m_tagBits.value(tag.id()), tag);
+}
+
+void TagIndex::onCollectionRemoved(const Collection &collection)
+{
+    QList<Item::Id> removedIds;
+    foreach (const Item &item, m_items) {
+        if (item.parentCollection().id() == collection.id())
+            removedIds << item.id();
+    }
+
+    foreach (Item::Id id, removedIds)
+        unindexItem(id);
+}
+
+int TagIndex::tagBit(const Tag &tag)
+{
+    auto it = m_tagBits.constFind(tag.id());
+    if (it != m_tagBits.constEnd()) {
+        if (!tag.type().isEmpty())
+            updateTagType(*it, tag);
+        return *it;
+    }
+
+    int bit;
+    if (!m_freeBits.isEmpty()) {
+        bit = m_freeBits.takeLast();
+        m_bitTags[bit] = tag.id();
+    } else {
+        bit = m_bitTags.size();
+        m_bitTags << tag.id();
+        m_contextMask.resize(m_bitTags.size());
+        m_plainMask.resize(m_bitTags.size());
+    }
+
+    m_tagBits.insert(tag.id(), bit);
+    updateTagType(bit, tag);
+    return bit;
+}
+
+void TagIndex::updateTagType(int bit, const Tag &tag)
+{
+    m_contextMask.setBit(bit, tag.type() == SerializerInterface::contextTagType());
+    m_plainMask.setBit(bit, tag.type() == Akonadi::Tag::PLAIN);
+}
+
+bool TagIndex::hasTagOfType(const Item &item, const QBitArray &mask, const QByteArray &type) const
+{
+    auto it = m_itemTags.constFind(item.id());
+    if (it == m_itemTags.constEnd()) {
+        // Unknown or not tagged, only the latter is cheap to tell
+        const auto tags = item.tags();
+        return std::any_of(tags.constBegin(), tags.constEnd(),
+                           [type] (const Akonadi::Tag &tag) { return tag.type() == type; });
+    }
+
+    // The item bits never outgrow the masks
+    QBitArray bits = mask;
+    bits.truncate(it->size());
+    bits &= *it;
+    return bits.count(true) > 0;
+}
+
+void TagIndex::indexItem(const Item &item)
+{
+    unindexItem(item.id());
+
+    const auto tags = item.tags();
+    if (tags.isEmpty())
+        return;
+
+    foreach (const Tag &tag, tags)
+        setItemTagBit(item.id(), tagBit(tag), true);
+    m_items.insert(item.id(), item);
+}
+
+void TagIndex::unindexItem(Item::Id id)
+{
+    m_items.remove(id);
+
+    const QBitArray bits = m_itemTags.take(id);
+    for (int bit = 0; bit < bits.size(); ++bit) {
+        if (!bits.testBit(bit))
+            continue;
+
+        auto items = m_taggedItems.find(m_bitTags.at(bit));
+        if (items == m_taggedItems.end())
+            continue;
+
+        items->remove(id);
+        if (items->isEmpty())
+            m_taggedItems.erase(items);
+    }
+}
+
+void TagIndex::setItemTagBit(Item::Id id, int bit, bool tagged)
+{
+    auto bits = m_itemTags.find(id);
+    if (bits == m_itemTags.end()) {
+        if (!tagged)
+            return;
+        bits = m_itemTags.insert(id, QBitArray());
+    }
+
+    if (bits->size() <= bit) {
+        if (!tagged)
+            return;
+        bits->resize(bit + 1);
+    }
+
+    bits->setBit(bit, tagged);
+
+    const Tag::Id tagId = m_bitTags.at(bit);
+    if (tagged) {
+        m_taggedItems[tagId].insert(id);
+    } else {
+        auto items = m_taggedItems.find(tagId);
+        if (items != m_taggedItems.end()) {
+            items->remove(id);
+            if (items->isEmpty())
+                m_taggedItems.erase(items);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#ifndef AKONADI_TAGINDEX_H
+#define AKONADI_TAGINDEX_H
+
+#include <functional>
+
+#include <QBitArray>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+
+#include <AkonadiCore/Collection>
+#include <AkonadiCore/Item>
+#include <AkonadiCore/Tag>
+
+#include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadirelationindex.h"
+#include "akonadi/akonadistorageinterface.h"
+
+namespace Akonadi {
+
+// Tag to items index. Each tag seen gets a bit and each tagged item the
+// set of bits of its tags, so that finding the items of a tag or telling
+// if an item carries a context or a plain tag needs no server round trip
+// nor going through the tags of the item.
+class TagIndex : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<TagIndex> Ptr;
+    typedef std::function<void(bool)> PopulatedFunction;
+
+    TagIndex(const StorageInterface::Ptr &storage,
+             const RelationIndex::Ptr &relationIndex,
+             const MonitorInterface::Ptr &monitor);
+
+    bool isPopulated() const;
+
+    // Indexes the items of all the task and note collections once, they
+    // come from the relation index so each collection is fetched only
+    // once for both. callback is called with true as soon as the index
+    // knows all of them (immediately if it already does), with false if
+    // a fetch failed. The next call tries again then
+    void populate(const PopulatedFunction &callback);
+
+    Item::List taggedItems(Tag::Id id) const;
+    // Also answer for items we don't know, from the tags they carry
+    bool hasContextTags(const Item &item) const;
+    bool hasPlainTags(const Item &item) const;
+
+private slots:
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
+    void onItemsRevisionChanged(const Akonadi::Item::List &items);
+    void onItemsTagsChanged(const Akonadi::Item::List &items,
+                            const QSet<Akonadi::Tag> &addedTags,
+                            const QSet<Akonadi::Tag> &removedTags);
+    void onTagAdded(const Akonadi::Tag &tag);
+    void onTagRemoved(const Akonadi::Tag &tag);
+    void onTagChanged(const Akonadi::Tag &tag);
+    void onCollectionRemoved(const Akonadi::Collection &collection);
+
+private:
+    void populateNextCollections();
+    void notifyPopulated(bool populated);
+    int tagBit(const Tag &tag);
+    void updateTagType(int bit, const Tag &tag);
+    bool hasTagOfType(const Item &item, const QBitArray &mask, const QByteArray &type) const;
+    void indexItem(const Item &item);
+    void unindexItem(Item::Id id);
+    void setItemTagBit(Item::Id id, int bit, bool tagged);
+
+    StorageInterface::Ptr m_storage;
+    RelationIndex::Ptr m_relationIndex;
+    MonitorInterface::Ptr m_monitor;
+
+    QHash<Tag::Id, int> m_tagBits;
+    QList<Tag::Id> m_bitTags;
+    QList<int> m_freeBits;
+    QBitArray m_contextMask;
+    QBitArray m_plainMask;
+
+    // Only the tagged items are kept
+    QHash<Item::Id, Item> m_items;
+    QHash<Item::Id, QBitArray> m_itemTags;
+    QHash<Tag::Id, QSet<Item::Id>> m_taggedItems;
+
+    bool m_populated;
+    QList<PopulatedFunction> m_pendingCallbacks;
+    // Collections left to populate, a few at a time
+    bool m_populating;
+    Collection::List m_collectionsToPopulate;
+    int m_populatingCount;
+    bool m_populateFailed;
+};
+
+}
+
+#endif // AKONADI_TAGINDEX_H
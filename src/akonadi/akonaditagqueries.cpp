@@ -23,27 +23,40 @@
 
 #include "akonaditagqueries.h"
 
-
 #include "akonadicollectionfetchjobinterface.h"
 #include "akonadiitemfetchjobinterface.h"
+#include "akonadiqueryscheduler.h"
 #include "akonaditagfetchjobinterface.h"
 
 #include "utils/jobhandler.h"
 
 using namespace Akonadi;
 
-TagQueries::TagQueries(const StorageInterface::Ptr &storage, const SerializerInterface::Ptr &serializer, const MonitorInterface::Ptr &monitor)
+TagQueries::TagQueries(const StorageInterface::Ptr &storage,
+                       const SerializerInterface::Ptr &serializer,
+                       const MonitorInterface::Ptr &monitor,
+                       const TagIndex::Ptr &tagIndex)
     : m_storage(storage),
       m_serializer(serializer),
-      m_monitor(monitor)
+      m_monitor(monitor),
+      m_tagIndex(tagIndex)
 {
+    QueryScheduler::install();
+
+    // Artifact queries are keyed by tag id
+    m_artifactRouter = ArtifactRouter::Ptr::create([] (const Akonadi::Item &item, QStringList &keys) {
+        foreach (const Akonadi::Tag &tag, item.tags())
+            keys << QString::number(tag.id());
+        return true;
+    });
+
     connect(m_monitor.data(), SIGNAL(tagAdded(Akonadi::Tag)), this, SLOT(onTagAdded(Akonadi::Tag)));
     connect(m_monitor.data(), SIGNAL(tagRemoved(Akonadi::Tag)), this, SLOT(onTagRemoved(Akonadi::Tag)));
     connect(m_monitor.data(), SIGNAL(tagChanged(Akonadi::Tag)), this, SLOT(onTagChanged(Akonadi::Tag)));
 
-    connect(m_monitor.data(), SIGNAL(itemAdded(Akonadi::Item)), this, SLOT(onItemAdded(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemRemoved(Akonadi::Item)), this, SLOT(onItemRemoved(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemChanged(Akonadi::Item)), this, SLOT(onItemChanged(Akonadi::Item)));
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
 }
 
 TagQueries::TagResult::Ptr TagQueries::findAll() const
@@ -52,6 +65,7 @@ TagQueries::TagResult::Ptr TagQueries::findAll() const
         {
             TagQueries *self = const_cast<TagQueries*>(this);
             self->m_findAll = self->createTagQuery();
+            self->m_findAll->setDebugName(QStringLiteral("TagQueries::findAll"));
         }
 
         m_findAll->setFetchFunction([this] (const TagQuery::AddFunction &add) {
@@ -87,28 +101,53 @@ TagQueries::ArtifactResult::Ptr TagQueries::findTopLevelArtifacts(Domain::Tag::P
         ArtifactQuery::Ptr query;
         {
             TagQueries *self = const_cast<TagQueries*>(this);
-            query = self->createArtifactQuery();
+            query = self->createArtifactQuery(akonadiTag.id());
+            query->setDebugName(QStringLiteral("TagQueries::findTopLevelArtifacts"));
             self->m_findTopLevel.insert(akonadiTag.id(), query);
         }
 
-        query->setFetchFunction([this, akonadiTag] (const ArtifactQuery::AddFunction &add) {
-            CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
-                                                                           StorageInterface::Recursive,
-                                                                           StorageInterface::Tasks | StorageInterface::Notes);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
-                    return;
+        query->setFetchFunction([this, akonadiTag] (const ArtifactQuery::AddFunction &queryAdd) {
+            auto add = m_artifactRouter->trackedAdd(QString::number(akonadiTag.id()), queryAdd);
+
+            if (m_tagIndex) {
+                // Might be populated after we're gone, so only what's needed is captured
+                auto tagIndex = m_tagIndex;
+                auto storage = m_storage;
+                tagIndex->populate([tagIndex, storage, akonadiTag, add] (bool populated) {
+                    if (!populated) {
+                        // Still worth asking the server
+                        ItemFetchJobInterface *job = storage->fetchTagItems(akonadiTag);
+                        job->streamItems([add] (const Akonadi::Item::List &items) {
+                            for (auto item : items)
+                                add(item);
+                        });
+                        return;
+                    }
+
+                    for (auto item : tagIndex->taggedItems(akonadiTag.id()))
+                        add(item);
+                });
+                return;
+            }
 
-                for (auto collection : job->collections()) {
-                    ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
+            // Let the server find the tagged items, we scan all
+            // the collections only if it can't answer
+            auto receivedIds = QSharedPointer<QSet<Akonadi::Item::Id>>::create();
 
-                        for (auto item : job->items())
-                            add(item);
-                    });
+            ItemFetchJobInterface *job = m_storage->fetchTagItems(akonadiTag);
+            job->streamItems([add, receivedIds] (const Akonadi::Item::List &items) {
+                for (auto item : items) {
+                    receivedIds->insert(item.id());
+                    add(item);
                 }
+            }, [this, job, add, receivedIds] {
+                if (job->kjob()->error() == KJob::NoError)
+                    return;
+
+                fetchAllArtifacts([add, receivedIds] (const Akonadi::Item &item) {
+                    if (!receivedIds->contains(item.id()))
+                        add(item);
+                });
             });
         });
         query->setConvertFunction([this] (const Akonadi::Item &item) {
@@ -132,11 +171,13 @@ TagQueries::ArtifactResult::Ptr TagQueries::findTopLevelArtifacts(Domain::Tag::P
             }
         });
         query->setPredicateFunction([this, tag] (const Akonadi::Item &item) {
-            return m_serializer->isTagChild(tag, item);
+            return m_serializer->isTagChild(tag, item)
+                && (m_serializer->isTaskItem(item) || m_serializer->isNoteItem(item));
         });
         query->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Artifact::Ptr &artifact) {
             return m_serializer->representsItem(artifact, item);
         });
+        query->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findTopLevel.value(akonadiTag.id())->result();
@@ -160,22 +201,38 @@ void TagQueries::onTagChanged(const Tag &tag)
         query->onChanged(tag);
 }
 
-void TagQueries::onItemAdded(const Item &item)
+void TagQueries::onItemsAdded(const Item::List &items)
+{
+    m_artifactRouter->onAdded(items);
+}
+
+void TagQueries::onItemsRemoved(const Item::List &items)
 {
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onAdded(item);
+    m_artifactRouter->onRemoved(items);
 }
 
-void TagQueries::onItemRemoved(const Item &item)
+void TagQueries::onItemsChanged(const Item::List &items)
 {
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onRemoved(item);
+    m_artifactRouter->onChanged(items);
 }
 
-void TagQueries::onItemChanged(const Item &item)
+void TagQueries::fetchAllArtifacts(const ArtifactQuery::AddFunction &add) const
 {
-    foreach (const ArtifactQuery::Ptr &query, m_artifactQueries)
-        query->onChanged(item);
+    CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
+                                                                   StorageInterface::Recursive,
+                                                                   StorageInterface::Tasks | StorageInterface::Notes);
+    Utils::JobHandler::install(job->kjob(), [this, job, add] {
+        if (job->kjob()->error() != KJob::NoError)
+            return;
+
+        for (auto collection : job->collections()) {
+            ItemFetchJobInterface *job = m_storage->fetchItems(collection);
+            job->streamItems([add] (const Akonadi::Item::List &items) {
+                for (auto item : items)
+                    add(item);
+            });
+        }
+    });
 }
 
 TagQueries::TagQuery::Ptr TagQueries::createTagQuery()
@@ -185,9 +242,9 @@ TagQueries::TagQuery::Ptr TagQueries::createTagQuery()
     return query;
 }
 
-TagQueries::ArtifactQuery::Ptr TagQueries::createArtifactQuery()
+TagQueries::ArtifactQuery::Ptr TagQueries::createArtifactQuery(Akonadi::Tag::Id tagId)
 {
     auto query = TagQueries::ArtifactQuery::Ptr::create();
-    m_artifactQueries << query;
+    m_artifactRouter->addQuery(QString::number(tagId), query);
     return query;
 }
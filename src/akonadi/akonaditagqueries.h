@@ -30,8 +30,10 @@
 #include <AkonadiCore/Item>
 
 #include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadiqueryrouter.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
+#include "akonadi/akonaditagindex.h"
 
 #include "domain/livequery.h"
 
@@ -54,10 +56,12 @@ public:
     typedef Domain::LiveQuery<Akonadi::Item, Domain::Artifact::Ptr> ArtifactQuery;
     typedef Domain::QueryResultProvider<Domain::Artifact::Ptr> ArtifactProvider;
     typedef Domain::QueryResult<Domain::Artifact::Ptr> ArtifactResult;
+    typedef QueryRouter<ArtifactQuery> ArtifactRouter;
 
     TagQueries(const StorageInterface::Ptr &storage,
                const SerializerInterface::Ptr &serializer,
-               const MonitorInterface::Ptr &monitor);
+               const MonitorInterface::Ptr &monitor,
+               const TagIndex::Ptr &tagIndex = TagIndex::Ptr());
 
     TagResult::Ptr findAll() const Q_DECL_OVERRIDE;
     ArtifactResult::Ptr findTopLevelArtifacts(Domain::Tag::Ptr tag) const Q_DECL_OVERRIDE;
@@ -67,23 +71,26 @@ private slots:
     void onTagRemoved(const Akonadi::Tag &tag);
     void onTagChanged(const Akonadi::Tag &tag);
 
-    void onItemAdded(const Akonadi::Item &item);
-    void onItemRemoved(const Akonadi::Item &item);
-    void onItemChanged(const Akonadi::Item &item);
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
 
 private:
+    void fetchAllArtifacts(const ArtifactQuery::AddFunction &add) const;
+
     TagQuery::Ptr createTagQuery();
-    ArtifactQuery::Ptr createArtifactQuery();
+    ArtifactQuery::Ptr createArtifactQuery(Akonadi::Tag::Id tagId);
 
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
     MonitorInterface::Ptr m_monitor;
+    TagIndex::Ptr m_tagIndex;
 
     TagQuery::Ptr m_findAll;
     TagQuery::List m_tagQueries;
 
     QHash<Akonadi::Tag::Id, ArtifactQuery::Ptr> m_findTopLevel;
-    ArtifactQuery::List m_artifactQueries;
+    ArtifactRouter::Ptr m_artifactRouter;
 };
 
 } // akonadi namespace
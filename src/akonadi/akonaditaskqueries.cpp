@@ -26,22 +26,40 @@
 
 #include "akonadicollectionfetchjobinterface.h"
 #include "akonadiitemfetchjobinterface.h"
+#include "akonadiqueryscheduler.h"
 
 #include "utils/datetime.h"
-#include "utils/jobhandler.h"
+#include "utils/jobcontinuation.h"
 
 using namespace Akonadi;
 
 TaskQueries::TaskQueries(const StorageInterface::Ptr &storage,
                          const SerializerInterface::Ptr &serializer,
-                         const MonitorInterface::Ptr &monitor)
+                         const MonitorInterface::Ptr &monitor,
+                         const RelationIndex::Ptr &index)
     : m_storage(storage),
       m_serializer(serializer),
-      m_monitor(monitor)
+      m_monitor(monitor),
+      m_index(index ? index : RelationIndex::Ptr::create(storage, serializer, monitor)),
+      m_selectedScope(CollectionScope::SelectedCollections)
 {
-    connect(m_monitor.data(), SIGNAL(itemAdded(Akonadi::Item)), this, SLOT(onItemAdded(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemRemoved(Akonadi::Item)), this, SLOT(onItemRemoved(Akonadi::Item)));
-    connect(m_monitor.data(), SIGNAL(itemChanged(Akonadi::Item)), this, SLOT(onItemChanged(Akonadi::Item)));
+    QueryScheduler::install();
+
+    // Children queries are keyed by parent uid, the index already
+    // processed the notification when we get it
+    auto relationIndex = m_index;
+    m_router = TaskRouter::Ptr::create([relationIndex] (const Akonadi::Item &item, QStringList &keys) {
+        if (!relationIndex->item(item.id()).isValid())
+            return false;
+
+        keys << relationIndex->parentUid(item.id());
+        return true;
+    });
+
+    connect(m_monitor.data(), SIGNAL(itemsAdded(Akonadi::Item::List)), this, SLOT(onItemsAdded(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsRemoved(Akonadi::Item::List)), this, SLOT(onItemsRemoved(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)), this, SLOT(onItemsChanged(Akonadi::Item::List)));
+    connect(m_monitor.data(), SIGNAL(collectionSelectionChanged(Akonadi::Collection)), this, SLOT(onCollectionSelectionChanged(Akonadi::Collection)));
 }
 
 TaskQueries::TaskResult::Ptr TaskQueries::findAll() const
@@ -49,29 +67,12 @@ TaskQueries::TaskResult::Ptr TaskQueries::findAll() const
     if (!m_findAll) {
         {
             TaskQueries *self = const_cast<TaskQueries*>(this);
-            self->m_findAll = self->createTaskQuery();
+            self->m_findAll = self->createSelectedTaskQuery();
+            self->m_findAll->setDebugName(QStringLiteral("TaskQueries::findAll"));
         }
 
         m_findAll->setFetchFunction([this] (const TaskQuery::AddFunction &add) {
-            CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
-                                                                           StorageInterface::Recursive,
-                                                                           StorageInterface::Tasks);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
-                    return;
-
-                for (auto collection : job->collections()) {
-                    ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
-
-                        for (auto item : job->items()) {
-                            add(item);
-                        }
-                    });
-                }
-            });
+            m_selectedScope.fetchItems(m_storage, m_serializer, StorageInterface::Tasks, add);
         });
 
         m_findAll->setConvertFunction([this] (const Akonadi::Item &item) {
@@ -86,6 +87,7 @@ TaskQueries::TaskResult::Ptr TaskQueries::findAll() const
         m_findAll->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Task::Ptr &task) {
             return m_serializer->representsItem(task, item);
         });
+        m_findAll->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findAll->result();
@@ -95,31 +97,56 @@ TaskQueries::TaskResult::Ptr TaskQueries::findChildren(Domain::Task::Ptr task) c
 {
     Akonadi::Item item = m_serializer->createItemFromTask(task);   
     if (!m_findChildren.contains(item.id())) {
-        TaskQuery::Ptr query;
+        TaskQuery::Ptr query = TaskQuery::Ptr::create();
+        query->setDebugName(QStringLiteral("TaskQueries::findChildren"));
+        const QString uid = m_serializer->objectUid(task);
 
         {
             TaskQueries *self = const_cast<TaskQueries*>(this);
-            query = self->createTaskQuery();
+            self->m_router->addQuery(uid, query);
             self->m_findChildren.insert(item.id(), query);
         }
 
-        query->setFetchFunction([this, item] (const TaskQuery::AddFunction &add) {
+        query->setFetchFunction([this, uid, item] (const TaskQuery::AddFunction &queryAdd) {
+            // Jobs might finish after we're gone, so only shared pointers are captured
+            auto index = m_index;
+            auto storage = m_storage;
+            auto serializer = m_serializer;
+            auto add = m_router->trackedAdd(uid, queryAdd);
+            auto addChildren = [index, storage, serializer, uid, add] (const Akonadi::Collection &collection) {
+                index->populateCollection(collection, [index, storage, serializer, uid, add, collection] (bool populated) {
+                    if (!populated) {
+                        // The index couldn't make it, look at the collection directly
+                        ItemFetchJobInterface *job = storage->fetchItems(collection);
+                        job->streamItems([serializer, uid, add] (const Akonadi::Item::List &items) {
+                            for (auto item : items) {
+                                if (serializer->relatedUidFromItem(item) == uid)
+                                    add(item);
+                            }
+                        });
+                        return;
+                    }
+
+                    for (auto child : index->childItems(uid))
+                        add(child);
+                });
+            };
+
+            const Akonadi::Item indexedItem = index->item(item.id());
+            if (indexedItem.isValid()) {
+                addChildren(indexedItem.parentCollection());
+                return;
+            }
+
             ItemFetchJobInterface *job = m_storage->fetchItem(item);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
+            Utils::JobContinuation::whenDone(job->kjob(), [job, addChildren] (KJob *kjob) {
+                if (kjob->error() != KJob::NoError)
                     return;
 
                 Q_ASSERT(job->items().size() == 1);
                 auto item = job->items()[0];
                 Q_ASSERT(item.parentCollection().isValid());
-                ItemFetchJobInterface *job = m_storage->fetchItems(item.parentCollection());
-                Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                    if (job->kjob()->error() != KJob::NoError)
-                        return;
-
-                    for (auto item : job->items())
-                        add(item);
-                });
+                addChildren(item.parentCollection());
             });
         });
         query->setConvertFunction([this] (const Akonadi::Item &item) {
@@ -134,6 +161,7 @@ TaskQueries::TaskResult::Ptr TaskQueries::findChildren(Domain::Task::Ptr task) c
         query->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Task::Ptr &task) {
             return m_serializer->representsItem(task, item);
         });
+        query->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findChildren.value(item.id())->result();
@@ -144,29 +172,12 @@ TaskQueries::TaskResult::Ptr TaskQueries::findTopLevel() const
     if (!m_findTopLevel) {
         {
             TaskQueries *self = const_cast<TaskQueries*>(this);
-            self->m_findTopLevel = self->createTaskQuery();
+            self->m_findTopLevel = self->createSelectedTaskQuery();
+            self->m_findTopLevel->setDebugName(QStringLiteral("TaskQueries::findTopLevel"));
         }
 
         m_findTopLevel->setFetchFunction([this] (const TaskQuery::AddFunction &add) {
-            CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
-                                                                           StorageInterface::Recursive,
-                                                                           StorageInterface::Tasks);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
-                    return;
-
-                for (auto collection : job->collections()) {
-                    ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
-
-                        for (auto item : job->items()) {
-                            add(item);
-                        }
-                    });
-                }
-            });
+            m_selectedScope.fetchItems(m_storage, m_serializer, StorageInterface::Tasks, add);
         });
 
         m_findTopLevel->setConvertFunction([this] (const Akonadi::Item &item) {
@@ -181,6 +192,7 @@ TaskQueries::TaskResult::Ptr TaskQueries::findTopLevel() const
         m_findTopLevel->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Task::Ptr &task) {
             return m_serializer->representsItem(task, item);
         });
+        m_findTopLevel->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findTopLevel->result();
@@ -192,25 +204,22 @@ TaskQueries::TaskResult::Ptr TaskQueries::findWorkdayTopLevel() const
         {
             TaskQueries *self = const_cast<TaskQueries*>(this);
             self->m_findWorkdayTopLevel = self->createTaskQuery();
+            self->m_findWorkdayTopLevel->setDebugName(QStringLiteral("TaskQueries::findWorkdayTopLevel"));
         }
 
         m_findWorkdayTopLevel->setFetchFunction([this] (const TaskQuery::AddFunction &add) {
             CollectionFetchJobInterface *job = m_storage->fetchCollections(Akonadi::Collection::root(),
                                                                            StorageInterface::Recursive,
                                                                            StorageInterface::Tasks);
-            Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                if (job->kjob()->error() != KJob::NoError)
+            Utils::JobContinuation::whenDone(job->kjob(), [this, job, add] (KJob *kjob) {
+                if (kjob->error() != KJob::NoError)
                     return;
 
                 for (auto collection : job->collections()) {
                     ItemFetchJobInterface *job = m_storage->fetchItems(collection);
-                    Utils::JobHandler::install(job->kjob(), [this, job, add] {
-                        if (job->kjob()->error() != KJob::NoError)
-                            return;
-
-                        for (auto item : job->items()) {
+                    job->streamItems([add] (const Akonadi::Item::List &items) {
+                        for (auto item : items)
                             add(item);
-                        }
                     });
                 }
             });
@@ -246,6 +255,7 @@ TaskQueries::TaskResult::Ptr TaskQueries::findWorkdayTopLevel() const
         m_findWorkdayTopLevel->setRepresentsFunction([this] (const Akonadi::Item &item, const Domain::Task::Ptr &task) {
             return m_serializer->representsItem(task, item);
         });
+        m_findWorkdayTopLevel->setKeyFunction([] (const Akonadi::Item &item) { return item.id(); });
     }
 
     return m_findWorkdayTopLevel->result();
@@ -258,32 +268,71 @@ TaskQueries::ContextResult::Ptr TaskQueries::findContexts(Domain::Task::Ptr task
     return ContextResult::Ptr();
 }
 
-void TaskQueries::onItemAdded(const Item &item)
+void TaskQueries::onItemsAdded(const Item::List &items)
 {
-    foreach (const TaskQuery::Ptr &query, m_taskQueries)
-        query->onAdded(item);
+    m_router->onAdded(items);
+
+    const auto inScope = m_selectedScope.filter(items);
+    foreach (const TaskQuery::Ptr &query, m_selectedQueries)
+        query->onAddedBatch(inScope);
 }
 
-void TaskQueries::onItemRemoved(const Item &item)
+void TaskQueries::onItemsRemoved(const Item::List &items)
 {
-    foreach (const TaskQuery::Ptr &query, m_taskQueries)
-        query->onRemoved(item);
+    m_router->onRemoved(items);
+
+    foreach (const TaskQuery::Ptr &query, m_selectedQueries)
+        query->onRemovedBatch(items);
 
-    if (m_findChildren.contains(item.id())) {
-        auto query = m_findChildren.take(item.id());
-        m_taskQueries.removeAll(query);
+    foreach (const Item &item, items) {
+        if (m_findChildren.contains(item.id())) {
+            auto query = m_findChildren.take(item.id());
+            m_router->removeQuery(query);
+        }
     }
 }
 
-void TaskQueries::onItemChanged(const Item &item)
+void TaskQueries::onItemsChanged(const Item::List &items)
 {
-    foreach (const TaskQuery::Ptr &query, m_taskQueries)
-        query->onChanged(item);
+    m_router->onChanged(items);
+
+    // Tasks moved to a deselected collection go away
+    Item::List outOfScope;
+    const auto inScope = m_selectedScope.filter(items, &outOfScope);
+    foreach (const TaskQuery::Ptr &query, m_selectedQueries) {
+        query->onChangedBatch(inScope);
+        if (!outOfScope.isEmpty())
+            query->onRemovedBatch(outOfScope);
+    }
+}
+
+void TaskQueries::onCollectionSelectionChanged(const Collection &collection)
+{
+    if (m_selectedQueries.isEmpty())
+        return;
+
+    // Only the contents of the toggled collection get fetched
+    m_selectedScope.changeSelection(collection, m_storage, m_serializer,
+                                    [this] (const Akonadi::Item::List &items, bool selected) {
+        foreach (const TaskQuery::Ptr &query, m_selectedQueries) {
+            if (selected)
+                query->onChangedBatch(items);
+            else
+                query->onRemovedBatch(items);
+        }
+    });
 }
 
 TaskQueries::TaskQuery::Ptr TaskQueries::createTaskQuery()
 {
     auto query = TaskQueries::TaskQuery::Ptr::create();
-    m_taskQueries << query;
+    m_router->addQuery(query);
+    return query;
+}
+
+TaskQueries::TaskQuery::Ptr TaskQueries::createSelectedTaskQuery()
+{
+    auto query = TaskQueries::TaskQuery::Ptr::create();
+    m_selectedQueries << query;
     return query;
 }
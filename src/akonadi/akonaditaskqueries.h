@@ -31,7 +31,10 @@
 #include <QHash>
 #include <AkonadiCore/Item>
 
+#include "akonadi/akonadicollectionscope.h"
 #include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadiqueryrouter.h"
+#include "akonadi/akonadirelationindex.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
 
@@ -52,13 +55,15 @@ public:
     typedef Domain::LiveQuery<Akonadi::Item, Domain::Task::Ptr> TaskQuery;
     typedef Domain::QueryResultProvider<Domain::Task::Ptr> TaskProvider;
     typedef Domain::QueryResult<Domain::Task::Ptr> TaskResult;
+    typedef QueryRouter<TaskQuery> TaskRouter;
 
     typedef Domain::QueryResultProvider<Domain::Context::Ptr> ContextProvider;
     typedef Domain::QueryResult<Domain::Context::Ptr> ContextResult;
 
     TaskQueries(const StorageInterface::Ptr &storage,
                 const SerializerInterface::Ptr &serializer,
-                const MonitorInterface::Ptr &monitor);
+                const MonitorInterface::Ptr &monitor,
+                const RelationIndex::Ptr &index = RelationIndex::Ptr());
 
     TaskResult::Ptr findAll() const Q_DECL_OVERRIDE;
     TaskResult::Ptr findChildren(Domain::Task::Ptr task) const Q_DECL_OVERRIDE;
@@ -67,22 +72,29 @@ public:
     ContextResult::Ptr findContexts(Domain::Task::Ptr task) const Q_DECL_OVERRIDE;
 
 private slots:
-    void onItemAdded(const Akonadi::Item &item);
-    void onItemRemoved(const Akonadi::Item &item);
-    void onItemChanged(const Akonadi::Item &item);
+    void onItemsAdded(const Akonadi::Item::List &items);
+    void onItemsRemoved(const Akonadi::Item::List &items);
+    void onItemsChanged(const Akonadi::Item::List &items);
+    void onCollectionSelectionChanged(const Akonadi::Collection &collection);
 
 private:
     TaskQuery::Ptr createTaskQuery();
+    TaskQuery::Ptr createSelectedTaskQuery();
 
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
     MonitorInterface::Ptr m_monitor;
+    RelationIndex::Ptr m_index;
 
     TaskQuery::Ptr m_findAll;
     QHash<Akonadi::Entity::Id, TaskQuery::Ptr> m_findChildren;
     TaskQuery::Ptr m_findTopLevel;
     TaskQuery::Ptr m_findWorkdayTopLevel;
-    TaskQuery::List m_taskQueries;
+    TaskRouter::Ptr m_router;
+
+    // Queries showing the selected collections contents, and their scope
+    TaskQuery::List m_selectedQueries;
+    CollectionScope m_selectedScope;
 };
 
 }
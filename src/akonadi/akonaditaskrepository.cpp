@@ -24,6 +24,8 @@
 
 #include "akonaditaskrepository.h"
 
+#include <QSharedPointer>
+
 #include <AkonadiCore/Item>
 
 #include "akonadicollectionfetchjobinterface.h"
@@ -31,17 +33,32 @@
 #include "akonadistoragesettings.h"
 
 #include "utils/compositejob.h"
+#include "utils/jobcontinuation.h"
+#include "utils/paralleljob.h"
 
 using namespace Akonadi;
 using namespace Utils;
 
 TaskRepository::TaskRepository(const StorageInterface::Ptr &storage,
                                const SerializerInterface::Ptr &serializer,
-                               const MessagingInterface::Ptr &messaging)
+                               const MessagingInterface::Ptr &messaging,
+                               const RelationIndex::Ptr &index,
+                               const MonitorInterface::Ptr &monitor,
+                               const ItemWriteQueue::Ptr &writeQueue)
     : m_storage(storage),
       m_serializer(serializer),
-      m_messaging(messaging)
+      m_messaging(messaging),
+      m_index(index),
+      m_monitor(monitor),
+      m_writeQueue(writeQueue)
 {
+    connect(&StorageSettings::instance(), SIGNAL(defaultTaskCollectionChanged(Akonadi::Collection)),
+            this, SLOT(onDefaultTaskCollectionChanged()));
+
+    if (m_monitor) {
+        connect(m_monitor.data(), SIGNAL(collectionRemoved(Akonadi::Collection)), this, SLOT(onCollectionChanged(Akonadi::Collection)));
+        connect(m_monitor.data(), SIGNAL(collectionChanged(Akonadi::Collection)), this, SLOT(onCollectionChanged(Akonadi::Collection)));
+    }
 }
 
 bool TaskRepository::isDefaultSource(Domain::DataSource::Ptr source) const
@@ -59,8 +76,13 @@ void TaskRepository::setDefaultSource(Domain::DataSource::Ptr source)
 
 KJob *TaskRepository::createItem(const Item &item)
 {
+    // Quick adds come in bursts, no need to look for the collection each time
+    if (m_targetCollection.isValid())
+        return m_storage->createItem(item, m_targetCollection);
+
     const Akonadi::Collection defaultCollection = m_storage->defaultTaskCollection();
     if (defaultCollection.isValid()) {
+        setTargetCollection(defaultCollection);
         return m_storage->createItem(item, defaultCollection);
     } else {
         auto job = new CompositeJob();
@@ -78,6 +100,7 @@ KJob *TaskRepository::createItem(const Item &item)
                 return c.rights() == Akonadi::Collection::AllRights;
             });
             Q_ASSERT(col.isValid());
+            setTargetCollection(col);
             auto createJob = m_storage->createItem(item, col);
             job->addSubjob(createJob);
             createJob->start();
@@ -135,6 +158,8 @@ KJob *TaskRepository::update(Domain::Task::Ptr task)
 {
     auto item = m_serializer->createItemFromTask(task);
     Q_ASSERT(item.isValid());
+    if (m_writeQueue)
+        return m_writeQueue->updateItem(item);
     return m_storage->updateItem(item);
 }
 
@@ -169,53 +194,192 @@ KJob *TaskRepository::remove(Domain::Task::Ptr task)
     return compositeJob;
 }
 
-KJob *TaskRepository::associate(Domain::Task::Ptr parent, Domain::Task::Ptr child)
+KJob *TaskRepository::removeTasks(Domain::Task::List tasks)
 {
-    auto childItem = m_serializer->createItemFromTask(child);
+    Item::List items;
+    foreach (const auto &task, tasks) {
+        auto item = m_serializer->createItemFromTask(task);
+        Q_ASSERT(item.isValid());
+        items << item;
+    }
 
-    auto job = new CompositeJob();
-    ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(childItem);
-    job->install(fetchItemJob->kjob(), [fetchItemJob, parent, job, this] {
-        if (fetchItemJob->kjob()->error() != KJob::NoError)
+    auto compositeJob = new CompositeJob();
+    ItemFetchJobInterface *fetchItemsJob = m_storage->fetchItemList(items);
+    compositeJob->install(fetchItemsJob->kjob(), [fetchItemsJob, compositeJob, this] {
+        if (fetchItemsJob->kjob()->error() != KJob::NoError)
            return;
 
-        Q_ASSERT(fetchItemJob->items().size() == 1);
-        auto childItem = fetchItemJob->items().first();
-        m_serializer->updateItemParent(childItem, parent);
+        QHash<Collection::Id, Item::List> itemsByCollection;
+        foreach (const auto &item, fetchItemsJob->items())
+            itemsByCollection[item.parentCollection().id()] << item;
+
+        auto removedItems = QSharedPointer<Item::List>::create();
+        auto fetchCollectionItemsJobs = new ParallelJob();
+        // Created as the previous ones are done, they start on their own
+        foreach (const auto &collectionItems, itemsByCollection) {
+            const auto collection = collectionItems.first().parentCollection();
+            fetchCollectionItemsJobs->addDependentJob(QList<KJob*>(), [collection, this] {
+                return m_storage->fetchItems(collection)->kjob();
+            }, [collectionItems, removedItems, this] (KJob *kjob) {
+                if (kjob->error() != KJob::NoError)
+                    return;
+
+                auto fetchCollectionItemsJob = dynamic_cast<ItemFetchJobInterface*>(kjob);
+                const auto potentialChildren = fetchCollectionItemsJob->items();
+                foreach (const auto &item, collectionItems) {
+                    *removedItems << m_serializer->filterDescendantItems(potentialChildren, item);
+                    *removedItems << item;
+                }
+            });
+        }
 
-        // Check collections to know if we need to move child
-        auto parentItem = m_serializer->createItemFromTask(parent);
-        ItemFetchJobInterface *fetchParentItemJob = m_storage->fetchItem(parentItem);
-        job->install(fetchParentItemJob->kjob(), [fetchParentItemJob, childItem, job, this] {
-            if (fetchParentItemJob->kjob()->error() != KJob::NoError)
+        compositeJob->install(fetchCollectionItemsJobs, [fetchCollectionItemsJobs, removedItems, compositeJob, this] {
+            if (fetchCollectionItemsJobs->error() != KJob::NoError)
                 return;
 
-            Q_ASSERT(fetchParentItemJob->items().size() == 1);
-            auto parentItem = fetchParentItemJob->items().first();
+            // Selected tasks might be descendants of each other
+            QSet<Item::Id> removedIds;
+            Item::List itemsToRemove;
+            foreach (const auto &item, *removedItems) {
+                if (removedIds.contains(item.id()))
+                    continue;
+                removedIds.insert(item.id());
+                itemsToRemove << item;
+            }
+
+            auto removeJob = m_storage->removeItems(itemsToRemove);
+            compositeJob->addSubjob(removeJob);
+            removeJob->start();
+        });
+    });
 
-            const int itemCollectionId = childItem.parentCollection().id();
-            const int parentCollectionId = parentItem.parentCollection().id();
+    return compositeJob;
+}
 
-            if (itemCollectionId != parentCollectionId) {
-                ItemFetchJobInterface *fetchChildrenItemJob = m_storage->fetchItems(childItem.parentCollection());
-                job->install(fetchChildrenItemJob->kjob(), [fetchChildrenItemJob, childItem, parentItem, job, this] {
-                    if (fetchChildrenItemJob->kjob()->error() != KJob::NoError)
-                        return;
+KJob *TaskRepository::associate(Domain::Task::Ptr parent, Domain::Task::Ptr child)
+{
+    auto job = new CompositeJob();
+    const auto items = Item::List() << m_serializer->createItemFromTask(child)
+                                    << m_serializer->createItemFromTask(parent);
 
-                    Item::List childItems = m_serializer->filterDescendantItems(fetchChildrenItemJob->items(), childItem);
+    // Both are needed to know if child has to move, no need to wait for one to get the other
+    withCurrentItems(job, items, [parent, job, this] (const Item::List &currentItems) {
+        auto childItem = currentItems.at(0);
+        const auto parentItem = currentItems.at(1);
+        m_serializer->updateItemParent(childItem, parent);
 
-                    auto transaction = m_storage->createTransaction();
+        const int itemCollectionId = childItem.parentCollection().id();
+        const int parentCollectionId = parentItem.parentCollection().id();
+
+        if (itemCollectionId != parentCollectionId) {
+            withDescendantItems(job, childItem, [childItem, parentItem, job, this] (Item::List childItems) {
+                auto transaction = m_storage->createTransaction();
+                m_storage->updateItem(childItem, transaction);
+                childItems.push_front(childItem);
+                m_storage->moveItems(childItems, parentItem.parentCollection(), transaction);
+                job->addSubjob(transaction);
+                transaction->start();
+            });
+        } else {
+            auto updateJob = m_storage->updateItem(childItem);
+            job->addSubjob(updateJob);
+            updateJob->start();
+        }
+    });
+
+    return job;
+}
+
+KJob *TaskRepository::associateChildren(Domain::Task::Ptr parent, Domain::Task::List children)
+{
+    const auto parentItem = m_serializer->createItemFromTask(parent);
+    const auto parentId = parentItem.id();
+
+    Item::List items;
+    items << parentItem;
+    foreach (const auto &child, children)
+        items << m_serializer->createItemFromTask(child);
+
+    auto job = new CompositeJob();
+    afterQueuedWrites(job, items, [items, parent, parentId, job, this] (bool) {
+        ItemFetchJobInterface *fetchItemsJob = m_storage->fetchItemList(items);
+        job->install(fetchItemsJob->kjob(), [fetchItemsJob, parent, parentId, job, this] {
+            if (fetchItemsJob->kjob()->error() != KJob::NoError)
+                return;
+
+            Item parentItem;
+            Item::List childItems;
+            foreach (auto item, fetchItemsJob->items()) {
+                if (item.id() == parentId) {
+                    parentItem = item;
+                } else {
+                    m_serializer->updateItemParent(item, parent);
+                    childItems << item;
+                }
+            }
+            Q_ASSERT(parentItem.isValid());
+
+            // Group the children which need to follow the parent in its collection
+            const auto parentCollectionId = parentItem.parentCollection().id();
+            QHash<Collection::Id, Item::List> childItemsToMove;
+            foreach (const auto &childItem, childItems) {
+                const auto collectionId = childItem.parentCollection().id();
+                if (collectionId != parentCollectionId)
+                    childItemsToMove[collectionId] << childItem;
+            }
+
+            if (childItemsToMove.isEmpty()) {
+                auto transaction = m_storage->createTransaction();
+                foreach (const auto &childItem, childItems)
                     m_storage->updateItem(childItem, transaction);
-                    childItems.push_front(childItem);
-                    m_storage->moveItems(childItems, parentItem.parentCollection(), transaction);
-                    job->addSubjob(transaction);
-                    transaction->start();
+                job->addSubjob(transaction);
+                transaction->start();
+                return;
+            }
+
+            auto movedItems = QSharedPointer<Item::List>::create();
+            auto fetchCollectionItemsJobs = new ParallelJob();
+            foreach (const auto &movedChildItems, childItemsToMove) {
+                const auto collection = movedChildItems.first().parentCollection();
+                fetchCollectionItemsJobs->addDependentJob(QList<KJob*>(), [collection, this] {
+                    return m_storage->fetchItems(collection)->kjob();
+                }, [movedChildItems, movedItems, this] (KJob *kjob) {
+                    if (kjob->error() != KJob::NoError)
+                        return;
+
+                    auto fetchCollectionItemsJob = dynamic_cast<ItemFetchJobInterface*>(kjob);
+                    const auto collectionItems = fetchCollectionItemsJob->items();
+                    foreach (const auto &childItem, movedChildItems) {
+                        *movedItems << childItem;
+                        *movedItems << m_serializer->filterDescendantItems(collectionItems, childItem);
+                    }
                 });
-            } else {
-                auto updateJob = m_storage->updateItem(childItem);
-                job->addSubjob(updateJob);
-                updateJob->start();
             }
+
+            job->install(fetchCollectionItemsJobs, [fetchCollectionItemsJobs, childItems, parentItem, movedItems, job, this] {
+                // The error of a failed fetch is carried by fetchCollectionItemsJobs
+                // and from there by job, moving only part of the children would
+                // leave the others behind
+                if (fetchCollectionItemsJobs->error() != KJob::NoError)
+                    return;
+
+                // A dropped child might also be the descendant of another one
+                QSet<Item::Id> movedIds;
+                Item::List itemsToMove;
+                foreach (const auto &item, *movedItems) {
+                    if (movedIds.contains(item.id()))
+                        continue;
+                    movedIds.insert(item.id());
+                    itemsToMove << item;
+                }
+
+                auto transaction = m_storage->createTransaction();
+                foreach (const auto &childItem, childItems)
+                    m_storage->updateItem(childItem, transaction);
+                m_storage->moveItems(itemsToMove, parentItem.parentCollection(), transaction);
+                job->addSubjob(transaction);
+                transaction->start();
+            });
         });
     });
 
@@ -225,15 +389,7 @@ KJob *TaskRepository::associate(Domain::Task::Ptr parent, Domain::Task::Ptr chil
 KJob *TaskRepository::dissociate(Domain::Task::Ptr child)
 {
     auto job = new CompositeJob();
-    auto childItem = m_serializer->createItemFromTask(child);
-    ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(childItem);
-    job->install(fetchItemJob->kjob(), [fetchItemJob, job, this] {
-        if (fetchItemJob->kjob()->error() != KJob::NoError)
-            return;
-
-        Q_ASSERT(fetchItemJob->items().size() == 1);
-        auto childItem = fetchItemJob->items().first();
-
+    withCurrentItem(job, m_serializer->createItemFromTask(child), [job, this] (Item childItem) {
         m_serializer->removeItemParent(childItem);
 
         auto updateJob = m_storage->updateItem(childItem);
@@ -247,15 +403,7 @@ KJob *TaskRepository::dissociate(Domain::Task::Ptr child)
 KJob *TaskRepository::dissociateAll(Domain::Task::Ptr child)
 {
     auto job = new CompositeJob();
-    auto childItem = m_serializer->createItemFromTask(child);
-    ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(childItem);
-    job->install(fetchItemJob->kjob(), [fetchItemJob, job, this] {
-        if (fetchItemJob->kjob()->error() != KJob::NoError)
-            return;
-
-        Q_ASSERT(fetchItemJob->items().size() == 1);
-        auto childItem = fetchItemJob->items().first();
-
+    withCurrentItem(job, m_serializer->createItemFromTask(child), [job, this] (Item childItem) {
         m_serializer->removeItemParent(childItem);
         m_serializer->clearItem(&childItem);
 
@@ -282,3 +430,116 @@ KJob *TaskRepository::delegate(Domain::Task::Ptr task, Domain::Task::Delegate de
     m_messaging->sendDelegationMessage(item);
     return Q_NULLPTR;
 }
+
+void TaskRepository::afterQueuedWrites(CompositeJob *job, const Item::List &items, const FlushedFunction &handler)
+{
+    KJob *flushJob = m_writeQueue ? m_writeQueue->flushItems(items) : Q_NULLPTR;
+    if (!flushJob) {
+        handler(false);
+        return;
+    }
+
+    job->install(flushJob, [flushJob, handler] {
+        if (flushJob->error() != KJob::NoError)
+            return;
+
+        handler(true);
+    });
+}
+
+void TaskRepository::withCurrentItem(CompositeJob *job, const Item &item, const ItemFunction &handler)
+{
+    afterQueuedWrites(job, Item::List() << item, [job, item, handler, this] (bool flushed) {
+        // The index follows the monitor, unless it still holds back changes
+        // of the item what it has is as recent as what the server would give
+        // us. It didn't hear about what just got flushed though
+        const auto cachedItem = (m_index && !flushed) ? m_index->currentItem(item.id()) : Item();
+        if (cachedItem.isValid()) {
+            handler(m_serializer->cloneItem(cachedItem));
+            return;
+        }
+
+        ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(item);
+        job->install(fetchItemJob->kjob(), [fetchItemJob, handler] {
+            if (fetchItemJob->kjob()->error() != KJob::NoError)
+               return;
+
+            Q_ASSERT(fetchItemJob->items().size() == 1);
+            handler(fetchItemJob->items().first());
+        });
+    });
+}
+
+void TaskRepository::withCurrentItems(CompositeJob *job, const Item::List &items, const ItemListFunction &handler)
+{
+    afterQueuedWrites(job, items, [job, items, handler, this] (bool flushed) {
+        // Filled as the fetches finish, they're gone by the time all are done
+        auto currentItems = QSharedPointer<Item::List>::create(items);
+        auto failed = QSharedPointer<bool>::create(false);
+        QHash<KJob*, QPair<int, ItemFetchJobInterface*>> fetches;
+        QList<KJob*> jobs;
+
+        for (int i = 0; i < items.size(); i++) {
+            // The index didn't hear about what just got flushed
+            const auto cachedItem = (m_index && !flushed) ? m_index->currentItem(items.at(i).id()) : Item();
+            if (cachedItem.isValid()) {
+                (*currentItems)[i] = m_serializer->cloneItem(cachedItem);
+                continue;
+            }
+
+            ItemFetchJobInterface *fetchItemJob = m_storage->fetchItem(items.at(i));
+            fetches.insert(fetchItemJob->kjob(), qMakePair(i, fetchItemJob));
+            jobs << fetchItemJob->kjob();
+        }
+
+        // The join finishes after handler, it keeps job open until handler added its jobs
+        KJob *joinJob = Utils::JobContinuation::whenAll(jobs, [currentItems, failed, fetches] (KJob *fetchJob) {
+            if (fetchJob->error() != KJob::NoError) {
+                *failed = true;
+                return;
+            }
+
+            const auto fetch = fetches.value(fetchJob);
+            Q_ASSERT(fetch.second->items().size() == 1);
+            (*currentItems)[fetch.first] = fetch.second->items().first();
+        }, [currentItems, failed, handler] {
+            if (!*failed)
+                handler(*currentItems);
+        });
+        job->addSubjob(joinJob);
+    });
+}
+
+void TaskRepository::withDescendantItems(CompositeJob *job, const Item &item, const ItemListFunction &handler)
+{
+    if (m_index && m_index->isCollectionPopulated(item.parentCollection().id())) {
+        handler(m_index->descendantItems(item.id()));
+        return;
+    }
+
+    ItemFetchJobInterface *fetchCollectionItemsJob = m_storage->fetchItems(item.parentCollection());
+    job->install(fetchCollectionItemsJob->kjob(), [fetchCollectionItemsJob, item, handler, this] {
+        if (fetchCollectionItemsJob->kjob()->error() != KJob::NoError)
+            return;
+
+        handler(m_serializer->filterDescendantItems(fetchCollectionItemsJob->items(), item));
+    });
+}
+
+void TaskRepository::onDefaultTaskCollectionChanged()
+{
+    m_targetCollection = Collection();
+}
+
+void TaskRepository::onCollectionChanged(const Collection &collection)
+{
+    // Might have been moved, made read-only or removed
+    if (collection.id() == m_targetCollection.id())
+        m_targetCollection = Collection();
+}
+
+void TaskRepository::setTargetCollection(const Collection &collection)
+{
+    if (m_monitor)
+        m_targetCollection = collection;
+}
@@ -24,15 +24,24 @@
 #ifndef AKONADI_TASKREPOSITORY_H
 #define AKONADI_TASKREPOSITORY_H
 
+#include <functional>
+
 #include "domain/taskrepository.h"
 
 #include <AkonadiCore/Collection>
 #include <AkonadiCore/Item>
 
+#include "akonadi/akonadiitemwritequeue.h"
 #include "akonadi/akonadimessaginginterface.h"
+#include "akonadi/akonadimonitorinterface.h"
+#include "akonadi/akonadirelationindex.h"
 #include "akonadi/akonadiserializerinterface.h"
 #include "akonadi/akonadistorageinterface.h"
 
+namespace Utils {
+class CompositeJob;
+}
+
 namespace Akonadi {
 
 class TaskRepository : public QObject, public Domain::TaskRepository
@@ -43,7 +52,10 @@ public:
 
     TaskRepository(const StorageInterface::Ptr &storage,
                    const SerializerInterface::Ptr &serializer,
-                   const MessagingInterface::Ptr &messaging);
+                   const MessagingInterface::Ptr &messaging,
+                   const RelationIndex::Ptr &index = RelationIndex::Ptr(),
+                   const MonitorInterface::Ptr &monitor = MonitorInterface::Ptr(),
+                   const ItemWriteQueue::Ptr &writeQueue = ItemWriteQueue::Ptr());
 
     virtual bool isDefaultSource(Domain::DataSource::Ptr source) const Q_DECL_OVERRIDE;
     virtual void setDefaultSource(Domain::DataSource::Ptr source) Q_DECL_OVERRIDE;
@@ -55,19 +67,49 @@ public:
 
     virtual KJob *update(Domain::Task::Ptr task) Q_DECL_OVERRIDE;
     virtual KJob *remove(Domain::Task::Ptr task) Q_DECL_OVERRIDE;
+    virtual KJob *removeTasks(Domain::Task::List tasks) Q_DECL_OVERRIDE;
 
     virtual KJob *associate(Domain::Task::Ptr parent, Domain::Task::Ptr child) Q_DECL_OVERRIDE;
+    virtual KJob *associateChildren(Domain::Task::Ptr parent, Domain::Task::List children) Q_DECL_OVERRIDE;
     virtual KJob *dissociate(Domain::Task::Ptr child) Q_DECL_OVERRIDE;
     virtual KJob *dissociateAll(Domain::Task::Ptr child) Q_DECL_OVERRIDE;
 
     virtual KJob *delegate(Domain::Task::Ptr task, Domain::Task::Delegate delegate) Q_DECL_OVERRIDE;
 
+private slots:
+    void onDefaultTaskCollectionChanged();
+    void onCollectionChanged(const Akonadi::Collection &collection);
+
 private:
     StorageInterface::Ptr m_storage;
     SerializerInterface::Ptr m_serializer;
     MessagingInterface::Ptr m_messaging;
+    RelationIndex::Ptr m_index;
+    MonitorInterface::Ptr m_monitor;
+    ItemWriteQueue::Ptr m_writeQueue;
+
+    // Where new tasks go, only kept when the monitor can tell us it's stale
+    Akonadi::Collection m_targetCollection;
 
     KJob *createItem(const Akonadi::Item &item);
+    void setTargetCollection(const Akonadi::Collection &collection);
+
+    typedef std::function<void(const Akonadi::Item &)> ItemFunction;
+    typedef std::function<void(const Akonadi::Item::List &)> ItemListFunction;
+    typedef std::function<void(bool)> FlushedFunction;
+
+    // Writes bypassing the write queue go through it, handler is called
+    // right away with false when nothing is queued for the items, and
+    // with true once the queued writes are done within job otherwise
+    void afterQueuedWrites(Utils::CompositeJob *job, const Akonadi::Item::List &items, const FlushedFunction &handler);
+
+    // Both call handler right away when the relation index knows about
+    // the collection of item, and after a fetch done within job otherwise.
+    // Queued writes of the items are done first, see afterQueuedWrites()
+    void withCurrentItem(Utils::CompositeJob *job, const Akonadi::Item &item, const ItemFunction &handler);
+    // Fetches the items the index doesn't know all at once
+    void withCurrentItems(Utils::CompositeJob *job, const Akonadi::Item::List &items, const ItemListFunction &handler);
+    void withDescendantItems(Utils::CompositeJob *job, const Akonadi::Item &item, const ItemListFunction &handler);
 };
 
 }
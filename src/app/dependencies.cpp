@@ -37,10 +37,13 @@
 #include "akonadi/akonaditaskqueries.h"
 #include "akonadi/akonaditaskrepository.h"
 
+#include "akonadi/akonadiitemwritequeue.h"
 #include "akonadi/akonadimessaging.h"
 #include "akonadi/akonadimonitorimpl.h"
+#include "akonadi/akonadirelationindex.h"
 #include "akonadi/akonadiserializer.h"
 #include "akonadi/akonadistorage.h"
+#include "akonadi/akonaditagindex.h"
 
 #include "presentation/applicationmodel.h"
 
@@ -55,18 +58,39 @@ void App::initializeDependencies()
     deps.add<Akonadi::MessagingInterface, Akonadi::Messaging, Utils::DependencyManager::UniqueInstance>();
     deps.add<Akonadi::MonitorInterface, Akonadi::MonitorImpl, Utils::DependencyManager::UniqueInstance>();
     deps.add<Akonadi::SerializerInterface, Akonadi::Serializer, Utils::DependencyManager::UniqueInstance>();
-    deps.add<Akonadi::StorageInterface, Akonadi::Storage, Utils::DependencyManager::UniqueInstance>();
+    deps.add<Akonadi::StorageInterface,
+             Akonadi::Storage(Akonadi::MonitorInterface*),
+             Utils::DependencyManager::UniqueInstance>();
+
+    deps.add<Akonadi::RelationIndex,
+             Akonadi::RelationIndex(Akonadi::StorageInterface*,
+                                    Akonadi::SerializerInterface*,
+                                    Akonadi::MonitorInterface*),
+             Utils::DependencyManager::UniqueInstance>();
+
+    deps.add<Akonadi::TagIndex,
+             Akonadi::TagIndex(Akonadi::StorageInterface*,
+                               Akonadi::RelationIndex*,
+                               Akonadi::MonitorInterface*),
+             Utils::DependencyManager::UniqueInstance>();
+
+    deps.add<Akonadi::ItemWriteQueue,
+             Akonadi::ItemWriteQueue(Akonadi::StorageInterface*,
+                                     Akonadi::MonitorInterface*),
+             Utils::DependencyManager::UniqueInstance>();
 
 
     deps.add<Domain::ArtifactQueries,
              Akonadi::ArtifactQueries(Akonadi::StorageInterface*,
                                       Akonadi::SerializerInterface*,
-                                      Akonadi::MonitorInterface*)>();
+                                      Akonadi::MonitorInterface*,
+                                      Akonadi::TagIndex*)>();
 
     deps.add<Domain::ContextQueries,
              Akonadi::ContextQueries(Akonadi::StorageInterface*,
                                      Akonadi::SerializerInterface*,
-                                     Akonadi::MonitorInterface*)>();
+                                     Akonadi::MonitorInterface*,
+                                     Akonadi::TagIndex*)>();
 
     deps.add<Domain::ContextRepository,
              Akonadi::ContextRepository(Akonadi::StorageInterface*,
@@ -88,21 +112,25 @@ void App::initializeDependencies()
 
     deps.add<Domain::NoteRepository,
              Akonadi::NoteRepository(Akonadi::StorageInterface*,
-                                     Akonadi::SerializerInterface*)>();
+                                     Akonadi::SerializerInterface*,
+                                     Akonadi::ItemWriteQueue*)>();
 
     deps.add<Domain::ProjectQueries,
              Akonadi::ProjectQueries(Akonadi::StorageInterface*,
                                      Akonadi::SerializerInterface*,
-                                     Akonadi::MonitorInterface*)>();
+                                     Akonadi::MonitorInterface*,
+                                     Akonadi::RelationIndex*)>();
 
     deps.add<Domain::ProjectRepository,
              Akonadi::ProjectRepository(Akonadi::StorageInterface*,
-                                        Akonadi::SerializerInterface*)>();
+                                        Akonadi::SerializerInterface*,
+                                        Akonadi::ItemWriteQueue*)>();
 
     deps.add<Domain::TagQueries,
              Akonadi::TagQueries(Akonadi::StorageInterface*,
                                  Akonadi::SerializerInterface*,
-                                 Akonadi::MonitorInterface*)>();
+                                 Akonadi::MonitorInterface*,
+                                 Akonadi::TagIndex*)>();
 
     deps.add<Domain::TagRepository,
              Akonadi::TagRepository(Akonadi::StorageInterface*,
@@ -111,12 +139,16 @@ void App::initializeDependencies()
     deps.add<Domain::TaskQueries,
              Akonadi::TaskQueries(Akonadi::StorageInterface*,
                                   Akonadi::SerializerInterface*,
-                                  Akonadi::MonitorInterface*)>();
+                                  Akonadi::MonitorInterface*,
+                                  Akonadi::RelationIndex*)>();
 
     deps.add<Domain::TaskRepository,
              Akonadi::TaskRepository(Akonadi::StorageInterface*,
                                      Akonadi::SerializerInterface*,
-                                     Akonadi::MessagingInterface*)>();
+                                     Akonadi::MessagingInterface*,
+                                     Akonadi::RelationIndex*,
+                                     Akonadi::MonitorInterface*,
+                                     Akonadi::ItemWriteQueue*)>();
 
 
     deps.add<Presentation::ApplicationModel,
@@ -44,6 +44,7 @@
 #include "presentation/applicationmodel.h"
 
 #include "utils/dependencymanager.h"
+#include "utils/timeslicer.h"
 
 #include "dependencies.h"
 
@@ -52,8 +53,8 @@
 int main(int argc, char **argv)
 {
     App::initializeDependencies();
-
     QApplication app(argc, argv);
+    Utils::TimeSlicer::setEnabled(true);
 
     KSharedConfig::Ptr config = KSharedConfig::openConfig("zanshin-migratorrc");
     KConfigGroup group = config->group("Migrations");
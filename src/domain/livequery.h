@@ -25,7 +25,12 @@
 #ifndef DOMAIN_LIVEQUERY_H
 #define DOMAIN_LIVEQUERY_H
 
+#include <algorithm>
+
+#include <QHash>
+
 #include "queryresult.h"
+#include "queryscheduler.h"
 
 namespace Domain {
 
@@ -47,9 +52,18 @@ public:
     typedef std::function<OutputType(const InputType &)> ConvertFunction;
     typedef std::function<void(const InputType &, OutputType &)> UpdateFunction;
     typedef std::function<bool(const InputType &, const OutputType &)> RepresentsFunction;
+    typedef std::function<qint64(const InputType &)> KeyFunction;
+
+    LiveQuery()
+        : m_scheduler(QueryScheduler::instance()),
+          m_ownerToken(QSharedPointer<int>::create(0))
+    {
+    }
 
     ~LiveQuery()
     {
+        m_scheduler->abandon(this);
+        m_scheduler->release(this);
         clear();
     }
 
@@ -57,17 +71,42 @@ public:
     {
         typename Provider::Ptr provider(m_provider.toStrongRef());
 
+        // Whoever asks last is most likely about to display the results
+        m_scheduler->promote(this);
+
         if (provider)
             return Result::create(provider);
 
-        provider = Provider::Ptr::create();
+        // Once the last result is gone nobody cares about the fetch anymore
+        const void *owner = this;
+        QWeakPointer<int> ownerToken = m_ownerToken;
+        auto scheduler = m_scheduler;
+        provider = typename Provider::Ptr(new Provider, [owner, ownerToken, scheduler] (Provider *provider) {
+            delete provider;
+            if (ownerToken) {
+                scheduler->abandon(owner);
+                scheduler->cancel(owner);
+            }
+        });
         m_provider = provider.toWeakRef();
+        m_outputKeys.clear();
 
         doFetch();
 
         return Result::create(provider);
     }
 
+    // Tells the query apart in traces
+    void setDebugName(const QString &debugName)
+    {
+        m_debugName = debugName;
+    }
+
+    QString debugName() const
+    {
+        return m_debugName;
+    }
+
     void setFetchFunction(const FetchFunction &fetch)
     {
         m_fetch = fetch;
@@ -93,13 +132,77 @@ public:
         m_represents = represents;
     }
 
+    // Optional, an output only representing inputs with the key of the
+    // input it got converted from, the batches then look the inputs up
+    // instead of comparing each of them to each output
+    void setKeyFunction(const KeyFunction &key)
+    {
+        m_key = key;
+    }
+
     void reset()
     {
+        m_scheduler->abandon(this);
+        m_scheduler->cancel(this);
         clear();
         doFetch();
     }
 
+    // The notifications wait for the fetched inputs still queued, if any
     void onAdded(const InputType &input)
+    {
+        if (m_scheduler->pendingCount(this) > 0)
+            m_scheduler->post(this, [this, input] { applyAdded(input); });
+        else
+            applyAdded(input);
+    }
+
+    void onChanged(const InputType &input)
+    {
+        if (m_scheduler->pendingCount(this) > 0)
+            m_scheduler->post(this, [this, input] { applyChanged(input); });
+        else
+            applyChanged(input);
+    }
+
+    void onRemoved(const InputType &input)
+    {
+        if (m_scheduler->pendingCount(this) > 0)
+            m_scheduler->post(this, [this, input] { applyRemoved(input); });
+        else
+            applyRemoved(input);
+    }
+
+    // Batched variants of the above, inputs are expected to be distinct
+    template<typename InputList>
+    void onAddedBatch(const InputList &inputs)
+    {
+        if (m_scheduler->pendingCount(this) > 0)
+            m_scheduler->post(this, [this, inputs] { applyAddedBatch(inputs); });
+        else
+            applyAddedBatch(inputs);
+    }
+
+    template<typename InputList>
+    void onChangedBatch(const InputList &inputs)
+    {
+        if (m_scheduler->pendingCount(this) > 0)
+            m_scheduler->post(this, [this, inputs] { applyChangedBatch(inputs); });
+        else
+            applyChangedBatch(inputs);
+    }
+
+    template<typename InputList>
+    void onRemovedBatch(const InputList &inputs)
+    {
+        if (m_scheduler->pendingCount(this) > 0)
+            m_scheduler->post(this, [this, inputs] { applyRemovedBatch(inputs); });
+        else
+            applyRemovedBatch(inputs);
+    }
+
+private:
+    void applyAdded(const InputType &input)
     {
         typename Provider::Ptr provider(m_provider.toStrongRef());
 
@@ -107,10 +210,10 @@ public:
             return;
 
         if (m_predicate(input))
-            provider->append(m_convert(input));
+            appendOutput(provider, input);
     }
 
-    void onChanged(const InputType &input)
+    void applyChanged(const InputType &input)
     {
         typename Provider::Ptr provider(m_provider.toStrongRef());
 
@@ -121,7 +224,7 @@ public:
             for (int i = 0; i < provider->data().size(); i++) {
                 auto output = provider->data().at(i);
                 if (m_represents(input, output)) {
-                    provider->removeAt(i);
+                    removeOutput(provider, i);
                     i--;
                 }
             }
@@ -139,12 +242,12 @@ public:
             }
 
             if (!found) {
-                provider->append(m_convert(input));
+                appendOutput(provider, input);
             }
         }
     }
 
-    void onRemoved(const InputType &input)
+    void applyRemoved(const InputType &input)
     {
         typename Provider::Ptr provider(m_provider.toStrongRef());
 
@@ -154,26 +257,146 @@ public:
         for (int i = 0; i < provider->data().size(); i++) {
             auto output = provider->data().at(i);
             if (m_represents(input, output)) {
-                provider->removeAt(i);
+                removeOutput(provider, i);
                 i--;
             }
         }
     }
 
-private:
-    void doFetch()
+    template<typename InputList>
+    void applyAddedBatch(const InputList &inputs)
     {
         typename Provider::Ptr provider(m_provider.toStrongRef());
 
         if (!provider)
             return;
 
-        auto addFunction = [this, provider] (const InputType &input) {
+        foreach (const InputType &input, inputs) {
             if (m_predicate(input))
-                provider->append(m_convert(input));
+                appendOutput(provider, input);
+        }
+    }
+
+    template<typename InputList>
+    void applyChangedBatch(const InputList &inputs)
+    {
+        typename Provider::Ptr provider(m_provider.toStrongRef());
+
+        if (!provider)
+            return;
+
+        QList<bool> matches;
+        QList<bool> found;
+        foreach (const InputType &input, inputs) {
+            matches << m_predicate(input);
+            found << false;
+        }
+
+        const bool keyed = hasOutputKeys(provider);
+        QHash<qint64, int> inputIndexes;
+        if (keyed) {
+            for (int inputIndex = 0; inputIndex < inputs.size(); inputIndex++)
+                inputIndexes.insert(m_key(inputs.at(inputIndex)), inputIndex);
+        }
+
+        for (int i = 0; i < provider->data().size(); i++) {
+            auto output = provider->data().at(i);
+
+            int inputIndex = inputs.size();
+            if (keyed) {
+                const int candidate = inputIndexes.value(m_outputKeys.at(i), -1);
+                if (candidate >= 0 && m_represents(inputs.at(candidate), output))
+                    inputIndex = candidate;
+            } else {
+                inputIndex = 0;
+                for (; inputIndex < inputs.size(); inputIndex++) {
+                    if (m_represents(inputs.at(inputIndex), output))
+                        break;
+                }
+            }
+
+            if (inputIndex == inputs.size())
+                continue;
+
+            if (!matches.at(inputIndex)) {
+                removeOutput(provider, i);
+                i--;
+            } else {
+                m_update(inputs.at(inputIndex), output);
+                provider->replace(i, output);
+                found[inputIndex] = true;
+            }
+        }
+
+        for (int inputIndex = 0; inputIndex < inputs.size(); inputIndex++) {
+            if (matches.at(inputIndex) && !found.at(inputIndex))
+                appendOutput(provider, inputs.at(inputIndex));
+        }
+    }
+
+    template<typename InputList>
+    void applyRemovedBatch(const InputList &inputs)
+    {
+        typename Provider::Ptr provider(m_provider.toStrongRef());
+
+        if (!provider)
+            return;
+
+        const bool keyed = hasOutputKeys(provider);
+        QMultiHash<qint64, int> inputIndexes;
+        if (keyed) {
+            for (int inputIndex = 0; inputIndex < inputs.size(); inputIndex++)
+                inputIndexes.insert(m_key(inputs.at(inputIndex)), inputIndex);
+        }
+
+        for (int i = 0; i < provider->data().size(); i++) {
+            auto output = provider->data().at(i);
+            const auto represents = [this, &output] (const InputType &input) { return m_represents(input, output); };
+
+            bool removed = false;
+            if (keyed) {
+                foreach (int inputIndex, inputIndexes.values(m_outputKeys.at(i))) {
+                    if (represents(inputs.at(inputIndex))) {
+                        removed = true;
+                        break;
+                    }
+                }
+            } else {
+                removed = std::any_of(inputs.begin(), inputs.end(), represents);
+            }
+
+            if (removed) {
+                removeOutput(provider, i);
+                i--;
+            }
+        }
+    }
+
+    void doFetch()
+    {
+        typename Provider::Ptr provider(m_provider.toStrongRef());
+
+        if (!provider)
+            return;
+
+        // Converted a few at a time if the scheduler spreads them, the
+        // fetch doesn't keep the provider alive. Shared jobs might also
+        // call back after we're gone
+        typename Provider::WeakPtr weakProvider = provider;
+        QWeakPointer<int> ownerToken = m_ownerToken;
+        auto addFunction = [this, weakProvider, ownerToken] (const InputType &input) {
+            if (weakProvider.isNull() || ownerToken.isNull())
+                return;
+
+            m_scheduler->post(this, [this, weakProvider, input] {
+                typename Provider::Ptr provider(weakProvider.toStrongRef());
+                if (provider && m_predicate(input))
+                    appendOutput(provider, input);
+            });
         };
 
-        m_fetch(addFunction);
+        // What the fetch starts belongs to us, to drop it with the results
+        m_scheduler->fetch(this, m_debugName, [this, addFunction] { m_fetch(addFunction); });
     }
 
     void clear()
@@ -185,6 +408,28 @@ private:
 
         while (!provider->data().isEmpty())
             provider->removeFirst();
+        m_outputKeys.clear();
+    }
+
+    void appendOutput(const typename Provider::Ptr &provider, const InputType &input)
+    {
+        provider->append(m_convert(input));
+        if (m_key)
+            m_outputKeys << m_key(input);
+    }
+
+    void removeOutput(const typename Provider::Ptr &provider, int index)
+    {
+        const bool keyed = hasOutputKeys(provider);
+        provider->removeAt(index);
+        if (keyed)
+            m_outputKeys.removeAt(index);
+    }
+
+    // Lost track if the key function got set after some outputs were there
+    bool hasOutputKeys(const typename Provider::Ptr &provider) const
+    {
+        return m_key && m_outputKeys.size() == provider->data().size();
     }
 
     FetchFunction m_fetch;
@@ -192,8 +437,15 @@ private:
     ConvertFunction m_convert;
     UpdateFunction m_update;
     RepresentsFunction m_represents;
+    KeyFunction m_key;
+    QString m_debugName;
+    QueryScheduler::Ptr m_scheduler;
 
     typename Provider::WeakPtr m_provider;
+    // Keys of the inputs the outputs got converted from, same order
+    QList<qint64> m_outputKeys;
+    // Tells the provider deleter whether we're still around
+    QSharedPointer<int> m_ownerToken;
 };
 
 
@@ -0,0 +1,70 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef DOMAIN_QUERYSCHEDULER_H
+#define DOMAIN_QUERYSCHEDULER_H
+
+#include <functional>
+
+#include <QSharedPointer>
+#include <QString>
+
+namespace Domain {
+
+// Runs the work of the live queries, each query being the owner of its
+// work. This one runs everything right away and has nothing to abandon,
+// the storage layer installs one which knows about its fetches
+class QueryScheduler
+{
+public:
+    typedef QSharedPointer<QueryScheduler> Ptr;
+    typedef std::function<void()> Work;
+
+    QueryScheduler();
+    virtual ~QueryScheduler();
+
+    // The scheduler of the live queries created from now on
+    static Ptr instance();
+    static void setInstance(const Ptr &scheduler);
+
+    // Whatever fetch starts belongs to owner, abandon() drops it
+    virtual void fetch(const void *owner, const QString &name, const Work &fetch);
+    virtual void abandon(const void *owner);
+
+    // Work of owner which can wait, it runs in the order it was posted
+    virtual void post(const void *owner, const Work &work);
+    virtual int pendingCount(const void *owner) const;
+    // The owner is about to display its results
+    virtual void promote(const void *owner);
+    // Drops the work of owner still waiting for its turn
+    virtual void cancel(const void *owner);
+    // Also forgets about owner, to call once it goes away
+    virtual void release(const void *owner);
+
+private:
+    Q_DISABLE_COPY(QueryScheduler)
+};
+
+}
+
+#endif // DOMAIN_QUERYSCHEDULER_H
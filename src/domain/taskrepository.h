@@ -52,8 +52,10 @@ public:
 
     virtual KJob *update(Task::Ptr task) = 0;
     virtual KJob *remove(Task::Ptr task) = 0;
+    virtual KJob *removeTasks(Task::List tasks) = 0;
 
     virtual KJob *associate(Task::Ptr parent, Task::Ptr child) = 0;
+    virtual KJob *associateChildren(Task::Ptr parent, Task::List children) = 0;
     virtual KJob *dissociate(Task::Ptr child) = 0;
     virtual KJob *dissociateAll(Task::Ptr child) = 0;
 
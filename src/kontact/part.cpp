@@ -44,6 +44,7 @@
 #include "widgets/pageview.h"
 
 #include "utils/dependencymanager.h"
+#include "utils/timeslicer.h"
 
 K_PLUGIN_FACTORY(PartFactory, registerPlugin<Part>();)
 K_EXPORT_PLUGIN(PartFactory(App::getAboutData()))
@@ -52,6 +53,7 @@ Part::Part(QWidget *parentWidget, QObject *parent, const QVariantList &)
     : KParts::ReadOnlyPart(parent)
 {
     App::initializeDependencies();
+    Utils::TimeSlicer::setEnabled(true);
 
     setComponentData(App::getAboutData());
 
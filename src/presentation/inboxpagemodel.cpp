@@ -69,6 +69,19 @@ void InboxPageModel::removeItem(const QModelIndex &index)
     }
 }
 
+void InboxPageModel::removeItems(const QModelIndexList &indexes)
+{
+    removeTasksAtOnce(indexes);
+}
+
+QString InboxPageModel::removeTasksErrorMessage(const QStringList &titles) const
+{
+    if (titles.size() == 1)
+        return tr("Cannot remove task %1 from Inbox").arg(titles.first());
+    else
+        return tr("Cannot remove tasks %1 from Inbox").arg(titles.join(", "));
+}
+
 QAbstractItemModel *InboxPageModel::createCentralListModel()
 {
     auto query = [this](const Domain::Artifact::Ptr &artifact) -> Domain::QueryResultInterface<Domain::Artifact::Ptr>::Ptr {
@@ -43,8 +43,10 @@ public:
 
     Domain::Task::Ptr addTask(const QString &title) Q_DECL_OVERRIDE;
     void removeItem(const QModelIndex &index) Q_DECL_OVERRIDE;
+    void removeItems(const QModelIndexList &indexes) Q_DECL_OVERRIDE;
 
 private:
+    QString removeTasksErrorMessage(const QStringList &titles) const Q_DECL_OVERRIDE;
     QAbstractItemModel *createCentralListModel() Q_DECL_OVERRIDE;
 
     Domain::ArtifactQueries::Ptr m_artifactQueries;
@@ -24,6 +24,8 @@
 
 #include "pagemodel.h"
 
+#include "presentation/querytreemodelbase.h"
+
 using namespace Presentation;
 
 PageModel::PageModel(const Domain::TaskQueries::Ptr &taskQueries,
@@ -45,6 +47,45 @@ QAbstractItemModel *PageModel::centralListModel()
     return m_centralListModel;
 }
 
+void PageModel::removeItems(const QModelIndexList &indexes)
+{
+    foreach (const QModelIndex &index, indexes)
+        removeItem(index);
+}
+
+Domain::Task::List PageModel::tasksFromIndexes(const QModelIndexList &indexes) const
+{
+    Domain::Task::List tasks;
+    foreach (const QModelIndex &index, indexes) {
+        auto artifact = index.data(QueryTreeModelBase::ObjectRole).value<Domain::Artifact::Ptr>();
+        if (auto task = artifact.objectCast<Domain::Task>())
+            tasks << task;
+    }
+    return tasks;
+}
+
+void PageModel::removeTasksAtOnce(const QModelIndexList &indexes)
+{
+    const auto tasks = tasksFromIndexes(indexes);
+    if (tasks.isEmpty())
+        return;
+
+    QStringList titles;
+    foreach (const auto &task, tasks)
+        titles << task->title();
+
+    const auto job = taskRepository()->removeTasks(tasks);
+    installHandler(job, removeTasksErrorMessage(titles));
+}
+
+QString PageModel::removeTasksErrorMessage(const QStringList &titles) const
+{
+    if (titles.size() == 1)
+        return tr("Cannot remove task %1").arg(titles.first());
+    else
+        return tr("Cannot remove tasks %1").arg(titles.join(", "));
+}
+
 Domain::TaskQueries::Ptr PageModel::taskQueries() const
 {
     return m_taskQueries;
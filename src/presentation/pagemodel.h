@@ -25,7 +25,9 @@
 #ifndef PRESENTATION_PAGEMODEL_H
 #define PRESENTATION_PAGEMODEL_H
 
+#include <QModelIndexList>
 #include <QObject>
+#include <QStringList>
 
 #include "domain/noterepository.h"
 #include "domain/taskqueries.h"
@@ -34,8 +36,6 @@
 #include "presentation/metatypes.h"
 #include "presentation/errorhandlingmodelbase.h"
 
-class QModelIndex;
-
 namespace Presentation {
 
 class PageModel : public QObject, public ErrorHandlingModelBase
@@ -53,8 +53,18 @@ public:
 public slots:
     virtual Domain::Task::Ptr addTask(const QString &title) = 0;
     virtual void removeItem(const QModelIndex &index) = 0;
+    // Removes the items one at a time by default
+    virtual void removeItems(const QModelIndexList &indexes);
 
 protected:
+    Domain::Task::List tasksFromIndexes(const QModelIndexList &indexes) const;
+
+    // For pages deleting their tasks outright, removes the selected
+    // ones with a single job
+    void removeTasksAtOnce(const QModelIndexList &indexes);
+    // Shown when removeTasksAtOnce() fails
+    virtual QString removeTasksErrorMessage(const QStringList &titles) const;
+
     Domain::TaskQueries::Ptr taskQueries() const;
 
     Domain::TaskRepository::Ptr taskRepository() const;
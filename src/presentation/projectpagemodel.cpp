@@ -76,6 +76,19 @@ void ProjectPageModel::removeItem(const QModelIndex &index)
     }
 }
 
+void ProjectPageModel::removeItems(const QModelIndexList &indexes)
+{
+    removeTasksAtOnce(indexes);
+}
+
+QString ProjectPageModel::removeTasksErrorMessage(const QStringList &titles) const
+{
+    if (titles.size() == 1)
+        return tr("Cannot remove task %1 from project %2").arg(titles.first()).arg(m_project->name());
+    else
+        return tr("Cannot remove tasks %1 from project %2").arg(titles.join(", ")).arg(m_project->name());
+}
+
 QAbstractItemModel *ProjectPageModel::createCentralListModel()
 {
     auto query = [this](const Domain::Artifact::Ptr &artifact) -> Domain::QueryResultInterface<Domain::Artifact::Ptr>::Ptr {
@@ -162,12 +175,20 @@ QAbstractItemModel *ProjectPageModel::createCentralListModel()
             return false;
         }
 
+        Domain::Task::List childTasks;
+        QStringList childTitles;
         foreach(const Domain::Artifact::Ptr &droppedArtifact, droppedArtifacts) {
             auto childTask = droppedArtifact.objectCast<Domain::Task>();
-            const auto job = taskRepository()->associate(parentTask, childTask);
-            installHandler(job, tr("Cannot move task %1 as a sub-task of %2").arg(childTask->title()).arg(parentTask->title()));
+            childTasks << childTask;
+            childTitles << childTask->title();
         }
 
+        const auto job = taskRepository()->associateChildren(parentTask, childTasks);
+        if (childTasks.size() == 1)
+            installHandler(job, tr("Cannot move task %1 as a sub-task of %2").arg(childTitles.first()).arg(parentTask->title()));
+        else
+            installHandler(job, tr("Cannot move tasks %1 as sub-tasks of %2").arg(childTitles.join(", ")).arg(parentTask->title()));
+
         return true;
     };
 
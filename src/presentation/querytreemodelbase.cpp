@@ -29,6 +29,8 @@
 
 #include <algorithm>
 
+#include "utils/tracer.h"
+
 using namespace Presentation;
 
 QueryTreeNodeBase::QueryTreeNodeBase(QueryTreeNodeBase *parent, QueryTreeModelBase *model)
@@ -97,6 +99,8 @@ void QueryTreeNodeBase::beginInsertRows(const QModelIndex &parent, int first, in
 
 void QueryTreeNodeBase::endInsertRows()
 {
+    // Views do their work while being notified
+    Utils::Tracer::Span span("model", "rowsInserted");
     m_model->endInsertRows();
 }
 
@@ -107,11 +111,13 @@ void QueryTreeNodeBase::beginRemoveRows(const QModelIndex &parent, int first, in
 
 void QueryTreeNodeBase::endRemoveRows()
 {
+    Utils::Tracer::Span span("model", "rowsRemoved");
     m_model->endRemoveRows();
 }
 
 void QueryTreeNodeBase::emitDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
 {
+    Utils::Tracer::Span span("model", "dataChanged");
     emit m_model->dataChanged(topLeft, bottomRight);
 }
 
@@ -69,6 +69,19 @@ void WorkdayPageModel::removeItem(const QModelIndex &index)
     }
 }
 
+void WorkdayPageModel::removeItems(const QModelIndexList &indexes)
+{
+    removeTasksAtOnce(indexes);
+}
+
+QString WorkdayPageModel::removeTasksErrorMessage(const QStringList &titles) const
+{
+    if (titles.size() == 1)
+        return tr("Cannot remove task %1 from Workday").arg(titles.first());
+    else
+        return tr("Cannot remove tasks %1 from Workday").arg(titles.join(", "));
+}
+
 QAbstractItemModel *WorkdayPageModel::createCentralListModel()
 {
     auto query = [this](const Domain::Artifact::Ptr &artifact) -> Domain::QueryResultInterface<Domain::Artifact::Ptr>::Ptr {
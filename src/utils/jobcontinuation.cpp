@@ -0,0 +1,162 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include "jobcontinuation.h"
+
+#include <QPointer>
+#include <QTimer>
+
+#include "jobhandler.h"
+
+using namespace Utils;
+
+class JoinJob : public KJob
+{
+    Q_OBJECT
+public:
+    JoinJob(const JobHandler::ResultHandlerWithJob &handler,
+            const JobContinuation::Continuation &continuation)
+        : KJob(),
+          m_handler(handler),
+          m_continuation(continuation),
+          m_owner(JobHandler::currentOwner()),
+          m_pendingCount(0),
+          m_done(false)
+    {
+        setCapabilities(Killable);
+    }
+
+    void start() Q_DECL_OVERRIDE
+    {
+    }
+
+    void join(const QList<KJob*> &jobs, int timeout)
+    {
+        if (jobs.isEmpty()) {
+            m_done = true;
+            runContinuation();
+            // Whoever waits for us didn't get the chance to connect yet
+            QTimer::singleShot(0, this, SLOT(onEmptyJoin()));
+            return;
+        }
+
+        if (timeout > 0)
+            QTimer::singleShot(timeout, this, SLOT(onTimeout()));
+
+        // The jobs belong to the join, so that it can drop them
+        m_pendingCount = jobs.size();
+        QPointer<JoinJob> self(this);
+        JobHandler::OwnerScope scope(this);
+        foreach (KJob *job, jobs) {
+            JobHandler::install(job, [self] (KJob *job) {
+                if (self)
+                    self->onJobDone(job);
+            });
+        }
+    }
+
+protected:
+    bool doKill() Q_DECL_OVERRIDE
+    {
+        cancel();
+        return true;
+    }
+
+private slots:
+    void onTimeout()
+    {
+        if (m_done)
+            return;
+
+        cancel();
+        setError(JobContinuation::TimedOutError);
+        setErrorText(QStringLiteral("Timed out"));
+        emitResult();
+    }
+
+    void onEmptyJoin()
+    {
+        emitResult();
+    }
+
+private:
+    void onJobDone(KJob *job)
+    {
+        if (m_done)
+            return;
+
+        if (job->error() != KJob::NoError && error() == KJob::NoError) {
+            setError(job->error());
+            setErrorText(job->errorText());
+        }
+
+        {
+            JobHandler::OwnerScope scope(m_owner);
+            m_handler(job);
+        }
+
+        if (--m_pendingCount == 0) {
+            m_done = true;
+            runContinuation();
+            emitResult();
+        }
+    }
+
+    void runContinuation()
+    {
+        JobHandler::OwnerScope scope(m_owner);
+        m_continuation();
+    }
+
+    void cancel()
+    {
+        m_done = true;
+        JobHandler::abandon(this);
+    }
+
+    JobHandler::ResultHandlerWithJob m_handler;
+    JobContinuation::Continuation m_continuation;
+    const void *m_owner;
+    int m_pendingCount;
+    bool m_done;
+};
+
+KJob *JobContinuation::whenAll(const QList<KJob*> &jobs,
+                               const JobHandler::ResultHandlerWithJob &handler,
+                               const Continuation &continuation,
+                               int timeout)
+{
+    auto join = new JoinJob(handler, continuation);
+    JobHandler::install(join, [] {});
+    join->join(jobs, timeout);
+    return join;
+}
+
+KJob *JobContinuation::whenDone(KJob *job,
+                                const JobHandler::ResultHandlerWithJob &continuation,
+                                int timeout)
+{
+    return whenAll(QList<KJob*>() << job, continuation, [] {}, timeout);
+}
+
+#include "jobcontinuation.moc"
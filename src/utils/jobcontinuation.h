@@ -0,0 +1,74 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef UTILS_JOBCONTINUATION_H
+#define UTILS_JOBCONTINUATION_H
+
+#include <functional>
+
+#include <QList>
+
+#include <KJob>
+
+#include "jobhandler.h"
+
+namespace Utils {
+
+namespace JobContinuation
+{
+    typedef std::function<void()> Continuation;
+
+    enum Error {
+        TimedOutError = KJob::UserDefinedError + 1
+    };
+
+    // Starts all the jobs at once, calls handler with each of them as it's
+    // done, failed or not, and continuation once the last of them is. The
+    // jobs get deleted once done, so whatever continuation needs from them
+    // has to be collected by handler.
+    //
+    // The returned job stands for the whole join. It finishes right after
+    // continuation got called, so holding a composite job open with it is
+    // enough for continuation to add more jobs there, and carries the error
+    // of the first job which failed. With a timeout in milliseconds it
+    // fails with TimedOutError if the jobs aren't all done by then. Killing
+    // it, emitting its result, cancels the join. Continuation won't be
+    // called after a timeout or a cancellation and the killable jobs get
+    // killed.
+    //
+    // Like with JobHandler the join belongs to the current owner, handler
+    // and continuation run on its behalf and abandoning it cancels the join.
+    KJob *whenAll(const QList<KJob*> &jobs,
+                  const JobHandler::ResultHandlerWithJob &handler,
+                  const Continuation &continuation,
+                  int timeout = 0);
+
+    // Same for a single job, continuation is called with it once it's done
+    KJob *whenDone(KJob *job,
+                   const JobHandler::ResultHandlerWithJob &continuation,
+                   int timeout = 0);
+}
+
+}
+
+#endif // UTILS_JOBCONTINUATION_H
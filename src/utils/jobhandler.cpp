@@ -36,13 +36,22 @@ class JobHandlerInstance : public QObject
     Q_OBJECT
 public:
     JobHandlerInstance()
-        : QObject() {}
+        : QObject(), m_currentOwner(Q_NULLPTR) {}
+
+    void adopt(KJob *job)
+    {
+        if (m_currentOwner)
+            m_owners.insert(job, m_currentOwner);
+    }
 
 private slots:
     void handleJobResult(KJob *job)
     {
         Q_ASSERT(m_handlers.contains(job) || m_handlersWithJob.contains(job));
 
+        const void *previousOwner = m_currentOwner;
+        m_currentOwner = m_owners.take(job);
+
         for (auto handler : m_handlers.take(job)) {
             handler();
         }
@@ -50,11 +59,15 @@ private slots:
         for (auto handler : m_handlersWithJob.take(job)) {
             handler(job);
         }
+
+        m_currentOwner = previousOwner;
     }
 
 public:
     QHash<KJob *, QList<JobHandler::ResultHandler>> m_handlers;
     QHash<KJob *, QList<JobHandler::ResultHandlerWithJob>> m_handlersWithJob;
+    QHash<KJob *, const void *> m_owners;
+    const void *m_currentOwner;
 };
 
 Q_GLOBAL_STATIC(JobHandlerInstance, jobHandlerInstance)
@@ -64,6 +77,7 @@ void JobHandler::install(KJob *job, const ResultHandler &handler)
     auto self = jobHandlerInstance();
     QObject::connect(job, SIGNAL(result(KJob*)), self, SLOT(handleJobResult(KJob*)), Qt::UniqueConnection);
     self->m_handlers[job] << handler;
+    self->adopt(job);
     job->start();
 }
 
@@ -72,9 +86,47 @@ void JobHandler::install(KJob *job, const ResultHandlerWithJob &handler)
     auto self = jobHandlerInstance();
     QObject::connect(job, SIGNAL(result(KJob*)), self, SLOT(handleJobResult(KJob*)), Qt::UniqueConnection);
     self->m_handlersWithJob[job] << handler;
+    self->adopt(job);
     job->start();
 }
 
+const void *JobHandler::currentOwner()
+{
+    return jobHandlerInstance()->m_currentOwner;
+}
+
+void JobHandler::setCurrentOwner(const void *owner)
+{
+    jobHandlerInstance()->m_currentOwner = owner;
+}
+
+JobHandler::OwnerScope::OwnerScope(const void *owner)
+    : m_previousOwner(currentOwner())
+{
+    setCurrentOwner(owner);
+}
+
+JobHandler::OwnerScope::~OwnerScope()
+{
+    setCurrentOwner(m_previousOwner);
+}
+
+void JobHandler::abandon(const void *owner)
+{
+    auto self = jobHandlerInstance();
+    foreach (KJob *job, self->m_owners.keys(owner)) {
+        self->m_owners.remove(job);
+        self->m_handlers.remove(job);
+        self->m_handlersWithJob.remove(job);
+        QObject::disconnect(job, SIGNAL(result(KJob*)), self, SLOT(handleJobResult(KJob*)));
+
+        // Killing a running Akonadi job would reset its whole session,
+        // those are only left alone
+        if (job->capabilities() & KJob::Killable)
+            job->kill(KJob::Quietly);
+    }
+}
+
 int JobHandler::jobCount()
 {
     auto self = jobHandlerInstance();
@@ -27,6 +27,8 @@
 
 #include <functional>
 
+#include <QtGlobal>
+
 class KJob;
 
 namespace Utils {
@@ -39,6 +41,25 @@ namespace JobHandler
     void install(KJob *job, const ResultHandler &handler);
     void install(KJob *job, const ResultHandlerWithJob &handler);
 
+    // Jobs installed while an owner is current belong to it, so do the
+    // jobs installed from their handlers
+    const void *currentOwner();
+    void setCurrentOwner(const void *owner);
+
+    // Makes owner current until going out of scope
+    class OwnerScope
+    {
+    public:
+        explicit OwnerScope(const void *owner);
+        ~OwnerScope();
+
+    private:
+        Q_DISABLE_COPY(OwnerScope)
+        const void *m_previousOwner;
+    };
+    // Drops the handlers of the jobs of owner, the killable ones get killed
+    void abandon(const void *owner);
+
     int jobCount();
 }
 
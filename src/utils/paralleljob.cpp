@@ -0,0 +1,196 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include "paralleljob.h"
+
+using namespace Utils;
+
+int ParallelJob::defaultMaxRunningJobs()
+{
+    return 4;
+}
+
+ParallelJob::ParallelJob(QObject *parent)
+    : ParallelJob(defaultMaxRunningJobs(), parent)
+{
+}
+
+ParallelJob::ParallelJob(int maxRunningJobs, QObject *parent)
+    : KCompositeJob(parent),
+      m_maxRunningJobs(qMax(1, maxRunningJobs)),
+      m_started(false),
+      m_startScheduled(false)
+{
+}
+
+int ParallelJob::maxRunningJobs() const
+{
+    return m_maxRunningJobs;
+}
+
+bool ParallelJob::addSubjob(KJob *job)
+{
+    if (!KCompositeJob::addSubjob(job))
+        return false;
+
+    m_waitingJobs << job;
+    scheduleStart();
+    return true;
+}
+
+bool ParallelJob::addDependentJob(const QList<KJob*> &dependencies, const JobFactory &factory,
+                                  const JobHandler::ResultHandlerWithJob &handler)
+{
+    Q_ASSERT(factory);
+
+    const auto jobs = subjobs();
+    foreach (KJob *dependency, dependencies) {
+        if (!jobs.contains(dependency))
+            return false;
+    }
+
+    DependentJob dependentJob;
+    dependentJob.dependencies = dependencies.toSet();
+    dependentJob.factory = factory;
+    dependentJob.handler = handler;
+    m_dependentJobs << dependentJob;
+    scheduleStart();
+    return true;
+}
+
+bool ParallelJob::install(KJob *job, const JobHandler::ResultHandlerWithJob &handler)
+{
+    if (!addSubjob(job))
+        return false;
+
+    m_handlers.insert(job, handler);
+    return true;
+}
+
+bool ParallelJob::install(KJob *job, const JobHandler::ResultHandler &handler)
+{
+    return install(job, [handler] (KJob *) { handler(); });
+}
+
+void ParallelJob::start()
+{
+    m_started = true;
+    scheduleStart();
+}
+
+void ParallelJob::slotResult(KJob *job)
+{
+    const auto handler = m_handlers.take(job);
+    if (handler)
+        handler(job);
+
+    // Some jobs start on their own, they might be done before we got to them
+    m_runningJobs.remove(job);
+    m_waitingJobs.removeAll(job);
+
+    const bool failed = job->error() != KJob::NoError;
+    if (failed) {
+        if (error() == KJob::NoError)
+            setError(job->error());
+        m_errorTexts << job->errorText();
+        setErrorText(m_errorTexts.join(QStringLiteral("\n")));
+    }
+
+    // Jobs depending on a failed one are never created, nothing to kill
+    auto it = m_dependentJobs.begin();
+    while (it != m_dependentJobs.end()) {
+        if (it->dependencies.remove(job) && failed)
+            it = m_dependentJobs.erase(it);
+        else
+            ++it;
+    }
+
+    removeSubjob(job);
+    scheduleStart();
+}
+
+void ParallelJob::startReadyJobs()
+{
+    m_startScheduled = false;
+
+    createReadyJobs();
+
+    // Handlers and factories got the chance to add jobs by now, nothing
+    // left means we're done
+    if (!hasSubjobs() && m_dependentJobs.isEmpty()) {
+        emitResult();
+        return;
+    }
+
+    auto it = m_waitingJobs.begin();
+    while (it != m_waitingJobs.end() && m_runningJobs.size() < m_maxRunningJobs) {
+        KJob *job = *it;
+        it = m_waitingJobs.erase(it);
+        m_runningJobs.insert(job);
+        job->start();
+    }
+}
+
+void ParallelJob::scheduleStart()
+{
+    if (!m_started || m_startScheduled)
+        return;
+
+    m_startScheduled = true;
+    QMetaObject::invokeMethod(this, "startReadyJobs", Qt::QueuedConnection);
+}
+
+void ParallelJob::createReadyJobs()
+{
+    // The created jobs might start on their own, every subjob not done
+    // yet holds a slot. Factories returning no job leave theirs free
+    forever {
+        QList<DependentJob> readyJobs;
+        int freeSlots = m_maxRunningJobs - subjobs().size();
+        auto it = m_dependentJobs.begin();
+        while (it != m_dependentJobs.end() && freeSlots > 0) {
+            if (it->dependencies.isEmpty()) {
+                readyJobs << *it;
+                it = m_dependentJobs.erase(it);
+                freeSlots--;
+            } else {
+                ++it;
+            }
+        }
+
+        if (readyJobs.isEmpty())
+            return;
+
+        // Taken out first, factories might add dependent jobs themselves
+        foreach (const auto &readyJob, readyJobs) {
+            KJob *job = readyJob.factory();
+            if (!job)
+                continue;
+
+            if (readyJob.handler)
+                install(job, readyJob.handler);
+            else
+                addSubjob(job);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+
+#ifndef UTILS_PARALLELJOB_H
+#define UTILS_PARALLELJOB_H
+
+#include <functional>
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+
+#include "kcompositejob.h"
+#include "jobhandler.h"
+
+namespace Utils {
+
+// Unlike CompositeJob the subjobs run side by side, at most maxRunningJobs()
+// at once. Akonadi jobs start on their own though, they're bound only when
+// created by a factory through addDependentJob(), no more than the free
+// slots being created at once. A dependent job is created only once all its
+// dependencies succeeded and never if one of them failed, so the order holds
+// whatever the job. A failing subjob doesn't stop the others, the job then
+// fails with the first error and all error texts.
+class ParallelJob : public KCompositeJob
+{
+    Q_OBJECT
+public:
+    typedef std::function<KJob*()> JobFactory;
+
+    static int defaultMaxRunningJobs();
+
+    explicit ParallelJob(QObject *parent = Q_NULLPTR);
+    explicit ParallelJob(int maxRunningJobs, QObject *parent = Q_NULLPTR);
+
+    int maxRunningJobs() const;
+
+    // Subjobs added after start() are picked up on the next event loop
+    // iteration, so dependent jobs can still be added right after them
+    virtual bool addSubjob(KJob *job) Q_DECL_OVERRIDE;
+
+    // The dependencies have to be subjobs not done yet, the job returned by factory is
+    // installed with handler, nothing happens if factory returns no job. Without
+    // dependencies the job is created as soon as a slot is free.
+    // The dependent job isn't a subjob until created, other jobs can't
+    // depend on it and dependency cycles can't be made
+    bool addDependentJob(const QList<KJob*> &dependencies, const JobFactory &factory,
+                         const JobHandler::ResultHandlerWithJob &handler = JobHandler::ResultHandlerWithJob());
+
+    // The handler is called before the job is done with, unlike with
+    // JobHandler the subjob isn't started right away
+    virtual bool install(KJob *job, const JobHandler::ResultHandlerWithJob &handler);
+    virtual bool install(KJob *job, const JobHandler::ResultHandler &handler);
+
+    virtual void start() Q_DECL_OVERRIDE;
+
+private slots:
+    virtual void slotResult(KJob *job) Q_DECL_OVERRIDE;
+    void startReadyJobs();
+
+private:
+    struct DependentJob
+    {
+        QSet<KJob*> dependencies;
+        JobFactory factory;
+        JobHandler::ResultHandlerWithJob handler;
+    };
+
+    void scheduleStart();
+    void createReadyJobs();
+
+    int m_maxRunningJobs;
+    bool m_started;
+    bool m_startScheduled;
+    QList<KJob*> m_waitingJobs;
+    QSet<KJob*> m_runningJobs;
+    QList<DependentJob> m_dependentJobs;
+    QHash<KJob*, JobHandler::ResultHandlerWithJob> m_handlers;
+    QStringList m_errorTexts;
+};
+
+}
+
+#endif // UTILS_PARALLELJOB_H
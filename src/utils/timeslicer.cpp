@@ -0,0 +1,161 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include "timeslicer.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QTimer>
+
+#include "tracer.h"
+
+using namespace Utils;
+
+class TimeSlicerInstance : public QObject
+{
+    Q_OBJECT
+public:
+    TimeSlicerInstance()
+        : QObject(),
+          m_enabled(false),
+          m_timer(new QTimer(this)),
+          m_lastRank(0)
+    {
+        m_timer->setSingleShot(true);
+        m_timer->setInterval(0);
+        connect(m_timer, SIGNAL(timeout()), this, SLOT(runSlice()));
+    }
+
+    void schedule()
+    {
+        if (!m_timer->isActive())
+            m_timer->start();
+    }
+
+    // Keeps the owners sorted by decreasing rank, FIFO for a given rank
+    void insertOwner(const void *owner)
+    {
+        const auto rank = m_ranks.value(owner);
+        auto it = std::find_if(m_owners.begin(), m_owners.end(),
+                               [this, rank] (const void *other) {
+                                   return m_ranks.value(other) < rank;
+                               });
+        m_owners.insert(it, owner);
+    }
+
+private slots:
+    void runSlice()
+    {
+        Tracer::Span span("slicer", "slice");
+        QElapsedTimer elapsed;
+        elapsed.start();
+
+        while (!m_owners.isEmpty() && elapsed.elapsed() < TimeSlicer::budget()) {
+            // Looked up again each time, the work might post or cancel some more
+            const void *owner = m_owners.first();
+            auto &queue = m_queues[owner];
+            const auto work = queue.dequeue();
+            if (queue.isEmpty()) {
+                m_queues.remove(owner);
+                m_owners.removeFirst();
+            }
+            work();
+        }
+
+        if (!m_owners.isEmpty())
+            schedule();
+    }
+
+public:
+    bool m_enabled;
+    QTimer *m_timer;
+    // Owners having work queued, the next one to serve first
+    QList<const void*> m_owners;
+    QHash<const void*, QQueue<TimeSlicer::Work>> m_queues;
+    QHash<const void*, qint64> m_ranks;
+    qint64 m_lastRank;
+};
+
+Q_GLOBAL_STATIC(TimeSlicerInstance, timeSlicerInstance)
+
+int TimeSlicer::budget()
+{
+    return 8;
+}
+
+void TimeSlicer::setEnabled(bool enabled)
+{
+    timeSlicerInstance()->m_enabled = enabled;
+}
+
+bool TimeSlicer::isEnabled()
+{
+    return timeSlicerInstance()->m_enabled;
+}
+
+void TimeSlicer::post(const void *owner, const Work &work)
+{
+    auto self = timeSlicerInstance();
+    if (!self->m_enabled) {
+        work();
+        return;
+    }
+
+    if (!self->m_queues.contains(owner))
+        self->insertOwner(owner);
+    self->m_queues[owner].enqueue(work);
+    self->schedule();
+}
+
+void TimeSlicer::promote(const void *owner)
+{
+    auto self = timeSlicerInstance();
+    self->m_ranks.insert(owner, ++self->m_lastRank);
+
+    if (self->m_owners.removeOne(owner))
+        self->m_owners.prepend(owner);
+}
+
+void TimeSlicer::cancel(const void *owner)
+{
+    auto self = timeSlicerInstance();
+    if (self->m_queues.remove(owner) > 0)
+        self->m_owners.removeOne(owner);
+}
+
+void TimeSlicer::release(const void *owner)
+{
+    cancel(owner);
+    timeSlicerInstance()->m_ranks.remove(owner);
+}
+
+int TimeSlicer::pendingCount(const void *owner)
+{
+    return timeSlicerInstance()->m_queues.value(owner).size();
+}
+
+#include "timeslicer.moc"
@@ -0,0 +1,56 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef UTILS_TIMESLICER_H
+#define UTILS_TIMESLICER_H
+
+#include <functional>
+
+namespace Utils {
+
+// Spreads work over several event loop iterations, each slice taking at
+// most budget() milliseconds. Work is queued per owner, the owners
+// promoted last being served first, the others in the order they posted.
+// When disabled work runs right away.
+namespace TimeSlicer
+{
+    typedef std::function<void()> Work;
+
+    int budget();
+
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+    void post(const void *owner, const Work &work);
+    void promote(const void *owner);
+    // Drops the work of owner still waiting for its turn
+    void cancel(const void *owner);
+    // Also forgets about its promotion, to call once owner goes away
+    void release(const void *owner);
+
+    int pendingCount(const void *owner);
+}
+
+}
+
+#endif // UTILS_TIMESLICER_H
@@ -0,0 +1,214 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <KJob>
+
+#include "jobhandler.h"
+
+using namespace Utils;
+
+class TracerInstance
+{
+public:
+    TracerInstance()
+        : m_enabled(false),
+          m_eventCount(0),
+          m_nextJobId(0)
+    {
+        m_clock.start();
+        setOutputFile(QString::fromLocal8Bit(qgetenv(Tracer::environmentVariable().toLatin1())));
+    }
+
+    ~TracerInstance()
+    {
+        close();
+    }
+
+    void setOutputFile(const QString &fileName)
+    {
+        QMutexLocker locker(&m_mutex);
+        close();
+
+        if (fileName.isEmpty())
+            return;
+
+        m_file.setFileName(fileName);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning("Couldn't open %s for tracing", qPrintable(fileName));
+            return;
+        }
+
+        m_file.write("[\n");
+        m_file.flush();
+        m_enabled = true;
+    }
+
+    qint64 now() const
+    {
+        return m_clock.nsecsElapsed() / 1000;
+    }
+
+    qint64 nextJobId()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_nextJobId++;
+    }
+
+    void write(QJsonObject event)
+    {
+        event.insert(QStringLiteral("pid"), QCoreApplication::applicationPid());
+        event.insert(QStringLiteral("tid"), qint64(reinterpret_cast<quintptr>(QThread::currentThreadId())));
+
+        QMutexLocker locker(&m_mutex);
+        if (!m_enabled)
+            return;
+
+        // Flushed right away, a trace leading to a crash is the most interesting one
+        if (m_eventCount++ > 0)
+            m_file.write(",\n");
+        m_file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+        m_file.flush();
+    }
+
+    bool m_enabled;
+
+private:
+    void close()
+    {
+        if (!m_file.isOpen())
+            return;
+
+        m_file.write("\n]\n");
+        m_file.close();
+        m_enabled = false;
+        m_eventCount = 0;
+    }
+
+    QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QFile m_file;
+    int m_eventCount;
+    qint64 m_nextJobId;
+};
+
+Q_GLOBAL_STATIC(TracerInstance, tracerInstance)
+
+static QJsonObject createEvent(const char *category, const char *name, const char *phase, qint64 timestamp)
+{
+    QJsonObject event;
+    event.insert(QStringLiteral("cat"), QString::fromLatin1(category));
+    event.insert(QStringLiteral("name"), QString::fromLatin1(name));
+    event.insert(QStringLiteral("ph"), QString::fromLatin1(phase));
+    event.insert(QStringLiteral("ts"), timestamp);
+    return event;
+}
+
+QString Tracer::environmentVariable()
+{
+    return QStringLiteral("ZANSHIN_TRACE_FILE");
+}
+
+bool Tracer::isEnabled()
+{
+    return tracerInstance()->m_enabled;
+}
+
+void Tracer::setOutputFile(const QString &fileName)
+{
+    tracerInstance()->setOutputFile(fileName);
+}
+
+Tracer::Span::Span(const char *category, const char *name)
+    : m_category(category),
+      m_name(name),
+      m_start(isEnabled() ? tracerInstance()->now() : -1)
+{
+}
+
+Tracer::Span::~Span()
+{
+    if (m_start < 0 || !isEnabled())
+        return;
+
+    auto self = tracerInstance();
+    auto event = createEvent(m_category, m_name, "X", m_start);
+    event.insert(QStringLiteral("dur"), self->now() - m_start);
+    if (!m_args.isEmpty())
+        event.insert(QStringLiteral("args"), QJsonObject::fromVariantMap(m_args));
+    self->write(event);
+}
+
+void Tracer::Span::setArg(const QString &key, const QVariant &value)
+{
+    if (m_start >= 0)
+        m_args.insert(key, value);
+}
+
+void Tracer::traceJob(KJob *job, const char *category, const char *name,
+                      const QVariantMap &args, const ResultArgsFunction &resultArgs)
+{
+    if (!isEnabled())
+        return;
+
+    auto self = tracerInstance();
+    const auto id = self->nextJobId();
+
+    auto beginArgs = args;
+    const auto owner = JobHandler::currentOwner();
+    if (owner)
+        beginArgs.insert(QStringLiteral("owner"), ownerId(owner));
+
+    // Async events, jobs overlap and don't finish in the order they started
+    auto begin = createEvent(category, name, "b", self->now());
+    begin.insert(QStringLiteral("id"), id);
+    begin.insert(QStringLiteral("args"), QJsonObject::fromVariantMap(beginArgs));
+    self->write(begin);
+
+    QObject::connect(job, &KJob::result, [category, name, id, resultArgs] (KJob *job) {
+        auto self = tracerInstance();
+        auto endArgs = resultArgs ? resultArgs(job) : QVariantMap();
+        if (job->error() != KJob::NoError)
+            endArgs.insert(QStringLiteral("error"), job->errorText());
+
+        auto end = createEvent(category, name, "e", self->now());
+        end.insert(QStringLiteral("id"), id);
+        end.insert(QStringLiteral("args"), QJsonObject::fromVariantMap(endArgs));
+        self->write(end);
+    });
+}
+
+QString Tracer::ownerId(const void *owner)
+{
+    return QStringLiteral("0x") + QString::number(reinterpret_cast<quintptr>(owner), 16);
+}
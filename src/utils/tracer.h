@@ -0,0 +1,78 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#ifndef UTILS_TRACER_H
+#define UTILS_TRACER_H
+
+#include <functional>
+
+#include <QString>
+#include <QVariantMap>
+
+class KJob;
+
+namespace Utils {
+
+// Records what we spend time on as Chrome trace events, to be loaded in
+// chrome://tracing or any viewer understanding the format. Enabled by
+// pointing ZANSHIN_TRACE_FILE to the file to write, otherwise tracing
+// does nothing.
+namespace Tracer
+{
+    typedef std::function<QVariantMap(KJob*)> ResultArgsFunction;
+
+    QString environmentVariable();
+
+    bool isEnabled();
+    // Mainly for tests, an empty file name disables tracing
+    void setOutputFile(const QString &fileName);
+
+    // From its creation until it goes out of scope
+    class Span
+    {
+    public:
+        Span(const char *category, const char *name);
+        ~Span();
+
+        void setArg(const QString &key, const QVariant &value);
+
+    private:
+        Q_DISABLE_COPY(Span)
+        const char *m_category;
+        const char *m_name;
+        qint64 m_start;
+        QVariantMap m_args;
+    };
+
+    // From now until job emits its result, the current JobHandler owner
+    // is recorded so that jobs can be attributed to the queries fetching
+    void traceJob(KJob *job, const char *category, const char *name,
+                  const QVariantMap &args = QVariantMap(),
+                  const ResultArgsFunction &resultArgs = ResultArgsFunction());
+
+    QString ownerId(const void *owner);
+}
+
+}
+
+#endif // UTILS_TRACER_H
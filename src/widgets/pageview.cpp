@@ -165,12 +165,13 @@ void PageView::onRemoveItemRequested()
             return;
     }
 
+    QModelIndexList validIndexes;
     foreach (const QModelIndex &currentIndex, currentIndexes) {
-        if (!currentIndex.isValid())
-            continue;
-
-        QMetaObject::invokeMethod(m_model, "removeItem", Q_ARG(QModelIndex, currentIndex));
+        if (currentIndex.isValid())
+            validIndexes << currentIndex;
     }
+
+    QMetaObject::invokeMethod(m_model, "removeItems", Q_ARG(QModelIndexList, validIndexes));
 }
 
 void PageView::onCurrentChanged(const QModelIndex &current)
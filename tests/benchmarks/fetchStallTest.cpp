@@ -0,0 +1,106 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest/QtTest>
+
+#include "akonadi/akonadicollectionfetchjobinterface.h"
+#include "akonadi/akonadiitemfetchjobinterface.h"
+#include "akonadi/akonadimonitorimpl.h"
+#include "akonadi/akonadistorage.h"
+
+// Measures the longest time the GUI thread can't process events while
+// all the items of the task and note collections get fetched, reported
+// in milliseconds. Needs a running Akonadi, preferably with a large
+// account to make a difference.
+class FetchStallBenchmark : public QObject
+{
+    Q_OBJECT
+
+    void benchmarkFetch(const std::function<Akonadi::StorageInterface::Ptr()> &createStorage);
+
+private slots:
+    void fetchOnGuiThread();
+    void fetchOnWorkerThread();
+};
+
+void FetchStallBenchmark::benchmarkFetch(const std::function<Akonadi::StorageInterface::Ptr()> &createStorage)
+{
+    qint64 longestStall = 0;
+
+    QBENCHMARK {
+        // A fresh storage each time, its item cache would spare us the fetch
+        auto storage = createStorage();
+
+        QElapsedTimer elapsed;
+        elapsed.start();
+        QTimer ticker;
+        ticker.setInterval(1);
+        connect(&ticker, &QTimer::timeout, &ticker, [&elapsed, &longestStall] {
+            longestStall = qMax(longestStall, elapsed.restart());
+        });
+        ticker.start();
+
+        auto collectionsJob = storage->fetchCollections(Akonadi::Collection::root(),
+                                                        Akonadi::StorageInterface::Recursive,
+                                                        Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes);
+        QVERIFY(collectionsJob->kjob()->exec());
+
+        int pendingJobs = 0;
+        QEventLoop loop;
+        foreach (const auto &collection, collectionsJob->collections()) {
+            auto job = storage->fetchItems(collection);
+            job->setItemsHandler([] (const Akonadi::Item::List &) {});
+            pendingJobs++;
+            connect(job->kjob(), &KJob::result, &loop, [&pendingJobs, &loop] {
+                if (--pendingJobs == 0)
+                    loop.quit();
+            });
+        }
+
+        elapsed.restart();
+        if (pendingJobs > 0)
+            loop.exec();
+        ticker.stop();
+    }
+
+    QTest::setBenchmarkResult(longestStall, QTest::WalltimeMilliseconds);
+}
+
+void FetchStallBenchmark::fetchOnGuiThread()
+{
+    benchmarkFetch([] {
+        return Akonadi::StorageInterface::Ptr(new Akonadi::Storage);
+    });
+}
+
+void FetchStallBenchmark::fetchOnWorkerThread()
+{
+    benchmarkFetch([] {
+        // Without the caches, it's the fetches we're comparing
+        auto monitor = Akonadi::MonitorInterface::Ptr(new Akonadi::MonitorImpl);
+        return Akonadi::StorageInterface::Ptr(new Akonadi::Storage(monitor, Akonadi::Storage::FetchWorker));
+    });
+}
+
+QTEST_MAIN(FetchStallBenchmark)
+#include "fetchStallTest.moc"
@@ -0,0 +1,106 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest/QtTest>
+
+#include "akonadi/akonadimonitorimpl.h"
+#include "akonadi/akonadiserializer.h"
+#include "akonadi/akonadistorage.h"
+#include "akonadi/akonaditaskrepository.h"
+
+// Measures the time between a quick add and the server telling us
+// about the new item, that is when the row shows up in the pages.
+// Needs a running Akonadi with at least one writable task collection,
+// the tasks created are removed afterwards.
+class QuickAddBenchmark : public QObject
+{
+    Q_OBJECT
+
+    void benchmarkCreate(const Akonadi::TaskRepository::Ptr &repository);
+
+    Akonadi::MonitorInterface::Ptr m_monitor;
+    Akonadi::StorageInterface::Ptr m_storage;
+    Akonadi::SerializerInterface::Ptr m_serializer;
+    Akonadi::Item::List m_createdItems;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void createWithoutCachedCollection();
+    void createWithCachedCollection();
+};
+
+void QuickAddBenchmark::initTestCase()
+{
+    m_monitor = Akonadi::MonitorInterface::Ptr(new Akonadi::MonitorImpl);
+    m_storage = Akonadi::StorageInterface::Ptr(new Akonadi::Storage(m_monitor));
+    m_serializer = Akonadi::SerializerInterface::Ptr(new Akonadi::Serializer);
+    connect(m_monitor.data(), &Akonadi::MonitorInterface::itemsAdded, this, [this] (const Akonadi::Item::List &items) {
+        m_createdItems << items;
+    });
+}
+
+void QuickAddBenchmark::cleanupTestCase()
+{
+    if (m_createdItems.isEmpty())
+        return;
+
+    auto job = m_storage->removeItems(m_createdItems);
+    QVERIFY(job->exec());
+}
+
+void QuickAddBenchmark::benchmarkCreate(const Akonadi::TaskRepository::Ptr &repository)
+{
+    int count = 0;
+    QBENCHMARK {
+        auto task = Domain::Task::Ptr::create();
+        task->setTitle(QStringLiteral("Quick add benchmark %1").arg(count++));
+
+        const int previousCount = m_createdItems.size();
+        QEventLoop loop;
+        connect(m_monitor.data(), &Akonadi::MonitorInterface::itemsAdded, &loop, &QEventLoop::quit);
+        QTimer::singleShot(5000, &loop, SLOT(quit()));
+        repository->create(task);
+        loop.exec();
+        QVERIFY(m_createdItems.size() > previousCount);
+    }
+}
+
+void QuickAddBenchmark::createWithoutCachedCollection()
+{
+    Akonadi::TaskRepository::Ptr repository(new Akonadi::TaskRepository(m_storage, m_serializer,
+                                                                         Akonadi::MessagingInterface::Ptr()));
+    benchmarkCreate(repository);
+}
+
+void QuickAddBenchmark::createWithCachedCollection()
+{
+    Akonadi::TaskRepository::Ptr repository(new Akonadi::TaskRepository(m_storage, m_serializer,
+                                                                         Akonadi::MessagingInterface::Ptr(),
+                                                                         Akonadi::RelationIndex::Ptr(),
+                                                                         m_monitor));
+    benchmarkCreate(repository);
+}
+
+QTEST_MAIN(QuickAddBenchmark)
+#include "quickAddTest.moc"
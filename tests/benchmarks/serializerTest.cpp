@@ -32,11 +32,13 @@ class SerializerBenchmark : public QObject
     Q_OBJECT
 
     Akonadi::Item createTestItem();
+    Akonadi::Item createTreeItem(int id, const QString &relatedUid);
 private slots:
     void deserialize();
     void checkPayloadAndDeserialize();
     void deserializeAndDestroy();
     void checkPayload();
+    void filterDescendantItems();
 };
 
 Akonadi::Item SerializerBenchmark::createTestItem()
@@ -57,6 +59,19 @@ Akonadi::Item SerializerBenchmark::createTestItem()
     return item;
 }
 
+Akonadi::Item SerializerBenchmark::createTreeItem(int id, const QString &relatedUid)
+{
+    KCalCore::Todo::Ptr todo(new KCalCore::Todo);
+    todo->setUid(QString::number(id));
+    todo->setRelatedTo(relatedUid);
+
+    Akonadi::Item item(id);
+    item.setMimeType("application/x-vnd.akonadi.calendar.todo");
+    item.setPayload<KCalCore::Todo::Ptr>(todo);
+
+    return item;
+}
+
 void SerializerBenchmark::deserialize()
 {
     Akonadi::Item item = createTestItem();
@@ -110,5 +125,23 @@ void SerializerBenchmark::checkPayload()
     }
 }
 
+void SerializerBenchmark::filterDescendantItems()
+{
+    // A collection of 50000 tasks, the first 5000 form a tree with
+    // four children per task, the others are top level tasks
+    Akonadi::Item::List items;
+    for (int i = 0; i < 50000; i++) {
+        const QString relatedUid = (i > 0 && i < 5000) ? QString::number((i - 1) / 4) : QString();
+        items << createTreeItem(i, relatedUid);
+    }
+    const Akonadi::Item root = items.first();
+
+    Akonadi::Serializer serializer;
+    QBENCHMARK {
+        const auto descendants = serializer.filterDescendantItems(items, root);
+        QCOMPARE(descendants.size(), 4999);
+    }
+}
+
 QTEST_MAIN(SerializerBenchmark)
 #include "serializerTest.moc"
@@ -60,6 +60,17 @@ Akonadi::Item::List AkonadiFakeItemFetchJob::items() const
     return isDone() ? m_items : Akonadi::Item::List();
 }
 
+void AkonadiFakeItemFetchJob::setItemsHandler(const ItemsHandler &handler)
+{
+    m_itemsHandler = handler;
+}
+
+void AkonadiFakeItemFetchJob::done()
+{
+    if (m_itemsHandler && !m_items.isEmpty())
+        m_itemsHandler(m_items);
+}
+
 void AkonadiFakeTagFetchJob::setTags(const Akonadi::Tag::List &tags)
 {
     m_tags = tags;
@@ -65,10 +65,16 @@ public:
     using FakeJob::FakeJob;
 
     void setItems(const Akonadi::Item::List &items);
-    Akonadi::Item::List items() const;
+    Akonadi::Item::List items() const Q_DECL_OVERRIDE;
+
+    void setItemsHandler(const ItemsHandler &handler) Q_DECL_OVERRIDE;
+
+protected:
+    void done() Q_DECL_OVERRIDE;
 
 private:
     Akonadi::Item::List m_items;
+    ItemsHandler m_itemsHandler;
 };
 
 class AkonadiFakeTagFetchJob : public FakeJob, public Akonadi::TagFetchJobInterface
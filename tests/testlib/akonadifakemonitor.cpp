@@ -30,6 +30,19 @@ AkonadiFakeMonitor::AkonadiFakeMonitor(QObject *parent)
 {
 }
 
+bool AkonadiFakeMonitor::hasPendingItemChanges(Akonadi::Item::Id id) const
+{
+    return m_pendingItemIds.contains(id);
+}
+
+void AkonadiFakeMonitor::setItemChangesPending(Akonadi::Item::Id id, bool pending)
+{
+    if (pending)
+        m_pendingItemIds.insert(id);
+    else
+        m_pendingItemIds.remove(id);
+}
+
 void AkonadiFakeMonitor::addCollection(const Akonadi::Collection &collection)
 {
     emit collectionAdded(collection);
@@ -50,24 +63,45 @@ void AkonadiFakeMonitor::changeCollectionSelection(const Akonadi::Collection &co
     emit collectionSelectionChanged(collection);
 }
 
+void AkonadiFakeMonitor::changeCollectionStatistics(const Akonadi::Collection &collection)
+{
+    emit collectionStatisticsChanged(collection);
+}
+
 void AkonadiFakeMonitor::addItem(const Akonadi::Item &item)
 {
     emit itemAdded(item);
+    emit itemsAdded(Akonadi::Item::List() << item);
 }
 
 void AkonadiFakeMonitor::removeItem(const Akonadi::Item &item)
 {
     emit itemRemoved(item);
+    emit itemsRemoved(Akonadi::Item::List() << item);
 }
 
 void AkonadiFakeMonitor::changeItem(const Akonadi::Item &item)
 {
     emit itemChanged(item);
+    emit itemsChanged(Akonadi::Item::List() << item);
 }
 
 void AkonadiFakeMonitor::moveItem(const Akonadi::Item &item)
 {
     emit itemMoved(item);
+    emit itemsMoved(Akonadi::Item::List() << item);
+}
+
+void AkonadiFakeMonitor::changeItemRevision(const Akonadi::Item &item)
+{
+    emit itemsRevisionChanged(Akonadi::Item::List() << item);
+}
+
+void AkonadiFakeMonitor::changeItemsTags(const Akonadi::Item::List &items,
+                                         const QSet<Akonadi::Tag> &addedTags,
+                                         const QSet<Akonadi::Tag> &removedTags)
+{
+    emit itemsTagsChanged(items, addedTags, removedTags);
 }
 
 void AkonadiFakeMonitor::addTag(const Akonadi::Tag &tag)
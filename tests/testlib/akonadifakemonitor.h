@@ -36,20 +36,31 @@ public:
 
     explicit AkonadiFakeMonitor(QObject *parent = Q_NULLPTR);
 
+    bool hasPendingItemChanges(Akonadi::Item::Id id) const Q_DECL_OVERRIDE;
+    void setItemChangesPending(Akonadi::Item::Id id, bool pending);
+
 public slots:
     void addCollection(const Akonadi::Collection &collection);
     void removeCollection(const Akonadi::Collection &collection);
     void changeCollection(const Akonadi::Collection &collection);
     void changeCollectionSelection(const Akonadi::Collection &collection);
+    void changeCollectionStatistics(const Akonadi::Collection &collection);
 
     void addItem(const Akonadi::Item &item);
     void removeItem(const Akonadi::Item &item);
     void changeItem(const Akonadi::Item &item);
     void moveItem(const Akonadi::Item &item);
+    void changeItemRevision(const Akonadi::Item &item);
+    void changeItemsTags(const Akonadi::Item::List &items,
+                         const QSet<Akonadi::Tag> &addedTags,
+                         const QSet<Akonadi::Tag> &removedTags);
 
     void addTag(const Akonadi::Tag &tag);
     void removeTag(const Akonadi::Tag &tag);
     void changeTag(const Akonadi::Tag &tag);
+
+private:
+    QSet<Akonadi::Item::Id> m_pendingItemIds;
 };
 
 }
@@ -46,14 +46,20 @@ void FakeJob::start()
 
 void FakeJob::onTimeout()
 {
-    if (m_errorCode == KJob::NoError)
+    if (m_errorCode == KJob::NoError) {
         m_done = true;
+        done();
+    }
 
     setError(m_errorCode);
     setErrorText(m_errorText);
     emitResult();
 }
 
+void FakeJob::done()
+{
+}
+
 bool FakeJob::isDone() const
 {
     return m_done;
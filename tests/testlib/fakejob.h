@@ -44,6 +44,8 @@ protected:
     bool isDone() const;
     int expectedError() const;
 
+    virtual void done();
+
 private:
     bool m_done;
     bool m_launched;
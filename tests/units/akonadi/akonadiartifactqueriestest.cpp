@@ -392,6 +392,94 @@ private slots:
         }
     }
 
+    void shouldCheckInboxArtifactsTagsAgainstTagIndex_data()
+    {
+        shouldNotHaveArtifactsWithContextsOrTagsInInbox_data();
+    }
+
+    void shouldCheckInboxArtifactsTagsAgainstTagIndex()
+    {
+        // GIVEN
+
+        // One top level collection
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col);
+
+        // One item in the collection, fetched without its tags
+        Akonadi::Item item(42);
+        item.setParentCollection(col);
+        QFETCH(Domain::Artifact::Ptr, artifact);
+        QFETCH(bool, hasContexts);
+        QFETCH(bool, hasTags);
+        QFETCH(bool, isExpectedInInbox);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item);
+
+        // The tag index knows the tags of the item though
+        Akonadi::Tag context(43);
+        context.setType(Akonadi::SerializerInterface::contextTagType());
+        Akonadi::Tag plainTag(44);
+        plainTag.setType(Akonadi::Tag::PLAIN);
+        Akonadi::Item indexedItem(42);
+        indexedItem.setParentCollection(col);
+        if (hasContexts)
+            indexedItem.setTag(context);
+        if (hasTags)
+            indexedItem.setTag(plainTag);
+
+        // Storage mock returning the fetch jobs
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks|Akonadi::StorageInterface::Notes)
+                                                                 .thenReturn(collectionFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
+                                                           .thenReturn(itemFetchJob);
+
+        // Serializer mock returning the artifact from the item, never asked about its tags
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
+
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item).thenReturn(artifact.dynamicCast<Domain::Task>());
+        serializerMock(&Akonadi::SerializerInterface::createNoteFromItem).when(item).thenReturn(artifact.dynamicCast<Domain::Note>());
+
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::hasContextTags).when(item).thenReturn(false);
+        serializerMock(&Akonadi::SerializerInterface::hasAkonadiTags).when(item).thenReturn(false);
+
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item).thenReturn(!artifact.dynamicCast<Domain::Task>().isNull());
+        serializerMock(&Akonadi::SerializerInterface::isNoteItem).when(item).thenReturn(!artifact.dynamicCast<Domain::Note>().isNull());
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        auto tagIndex = Akonadi::TagIndex::Ptr::create(storageMock.getInstance(), relationIndex, monitor);
+        monitor->addItem(indexedItem);
+
+        // WHEN
+        QScopedPointer<Domain::ArtifactQueries> queries(new Akonadi::ArtifactQueries(storageMock.getInstance(),
+                                                                                     serializerMock.getInstance(),
+                                                                                     monitor,
+                                                                                     tagIndex));
+        Domain::QueryResult<Domain::Artifact::Ptr>::Ptr result = queries->findInboxTopLevel();
+
+        // THEN
+        QVERIFY(result->data().isEmpty());
+        QTest::qWait(150);
+
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::hasContextTags).when(item).exactly(0));
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::hasAkonadiTags).when(item).exactly(0));
+        if (isExpectedInInbox) {
+            QCOMPARE(result->data().size(), 1);
+            QCOMPARE(result->data().at(0), artifact);
+        } else {
+            QVERIFY(result->data().isEmpty());
+        }
+    }
+
     void shouldReactToItemAddsForInbox_data()
     {
         QTest::addColumn<bool>("reactionExpected");
@@ -654,10 +742,8 @@ private slots:
         col1.setParentCollection(Akonadi::Collection::root());
         Akonadi::Collection col2(43);
         col2.setParentCollection(Akonadi::Collection::root());
-        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob1 = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob1->setCollections(Akonadi::Collection::List() << col1 << col2);
-        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob2 = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob2->setCollections(Akonadi::Collection::List() << col1 << col2);
+        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col1 << col2);
 
         // One item in each collection
         Akonadi::Item item1(42);
@@ -665,14 +751,16 @@ private slots:
         Domain::Task::Ptr task1(new Domain::Task);
         Testlib::AkonadiFakeItemFetchJob *itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
         itemFetchJob1->setItems(Akonadi::Item::List() << item1);
-        Testlib::AkonadiFakeItemFetchJob *itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob2->setItems(Akonadi::Item::List() << item1);
 
         Akonadi::Item item2(43);
         item1.setParentCollection(col2);
         Domain::Task::Ptr task2(new Domain::Task);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob2->setItems(Akonadi::Item::List() << item2);
         Testlib::AkonadiFakeItemFetchJob *itemFetchJob3 = new Testlib::AkonadiFakeItemFetchJob(this);
         itemFetchJob3->setItems(Akonadi::Item::List() << item2);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob4 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob4->setItems(Akonadi::Item::List() << item2);
 
 
         // Storage mock returning the fetch jobs
@@ -680,19 +768,20 @@ private slots:
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
                                                                        Akonadi::StorageInterface::Tasks|Akonadi::StorageInterface::Notes)
-                                                                 .thenReturn(collectionFetchJob1)
-                                                                 .thenReturn(collectionFetchJob2);
+                                                                 .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col1)
-                                                           .thenReturn(itemFetchJob1)
-                                                           .thenReturn(itemFetchJob2);
+                                                           .thenReturn(itemFetchJob1);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col2)
-                                                           .thenReturn(itemFetchJob3);
+                                                           .thenReturn(itemFetchJob2)
+                                                           .thenReturn(itemFetchJob3)
+                                                           .thenReturn(itemFetchJob4);
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
         serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col2).thenReturn(true)
-                                                                                      .thenReturn(false);
+                                                                                      .thenReturn(false)
+                                                                                      .thenReturn(true);
 
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isNoteItem).when(item1).thenReturn(false);
@@ -732,6 +821,23 @@ private slots:
         // THEN
         QCOMPARE(result->data().size(), 1);
         QCOMPARE(result->data().first().dynamicCast<Domain::Task>(), task1);
+
+        // WHEN
+        monitor->changeCollectionSelection(col2);
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(result->data().size(), 2);
+        QCOMPARE(result->data().first().dynamicCast<Domain::Task>(), task1);
+        QCOMPARE(result->data().last().dynamicCast<Domain::Task>(), task2);
+
+        // Only the toggled collection got fetched again
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                               Akonadi::StorageInterface::Recursive,
+                                                                               Akonadi::StorageInterface::Tasks|Akonadi::StorageInterface::Notes)
+                                                                         .exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(3));
     }
 };
 
@@ -0,0 +1,287 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "testlib/akonadifakemonitor.h"
+
+#include "akonadi/akonadicollectiontree.h"
+
+class AkonadiCollectionTreeTest : public QObject
+{
+    Q_OBJECT
+private:
+    Akonadi::Collection createCollection(Akonadi::Collection::Id id, const QString &name, const Akonadi::Collection &parent)
+    {
+        Akonadi::Collection collection(id);
+        collection.setName(name);
+        // Like a listing does, only a dummy parent
+        collection.setParentCollection(parent == Akonadi::Collection::root() ? parent : Akonadi::Collection(parent.id()));
+        return collection;
+    }
+
+private slots:
+    void shouldCallAllTheWaitingCallbacksOncePopulated()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree tree(monitor);
+
+        QList<bool> outcomes;
+        auto callback = [&outcomes] (bool success) { outcomes << success; };
+
+        // WHEN
+        const bool firstMustList = tree.waitForPopulation(callback);
+        const bool secondMustList = tree.waitForPopulation(callback);
+
+        // THEN
+        QVERIFY(firstMustList);
+        QVERIFY(!secondMustList);
+        QVERIFY(outcomes.isEmpty());
+        QVERIFY(!tree.isPopulated());
+
+        // WHEN
+        tree.setPopulationFailed();
+
+        // THEN
+        QCOMPARE(outcomes, QList<bool>() << false << false);
+        QVERIFY(!tree.isPopulated());
+
+        // WHEN
+        outcomes.clear();
+        QVERIFY(tree.waitForPopulation(callback));
+        tree.setCollections(Akonadi::Collection::List());
+
+        // THEN
+        QCOMPARE(outcomes, QList<bool>() << true);
+        QVERIFY(tree.isPopulated());
+
+        // WHEN
+        outcomes.clear();
+        const bool populatedMustList = tree.waitForPopulation(callback);
+
+        // THEN
+        QVERIFY(!populatedMustList);
+        QCOMPARE(outcomes, QList<bool>() << true);
+    }
+
+    void shouldReconstructAncestorChains()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree tree(monitor);
+
+        auto col1 = createCollection(42, "1", Akonadi::Collection::root());
+        auto col2 = createCollection(43, "2", col1);
+        auto col3 = createCollection(44, "3", col2);
+        auto col4 = createCollection(45, "4", col1);
+
+        // WHEN
+        tree.setCollections(Akonadi::Collection::List() << col3 << col1 << col2 << col4);
+
+        // THEN
+        const auto collection = tree.collection(col3.id());
+        QCOMPARE(collection.name(), QString("3"));
+        QCOMPARE(collection.parentCollection().name(), QString("2"));
+        QCOMPARE(collection.parentCollection().parentCollection().name(), QString("1"));
+        QCOMPARE(collection.parentCollection().parentCollection().parentCollection(), Akonadi::Collection::root());
+
+        QCOMPARE(tree.children(col1.id()), Akonadi::Collection::List() << col2 << col4);
+        QCOMPARE(tree.descendants(Akonadi::Collection::root().id()), Akonadi::Collection::List() << col1 << col2 << col3 << col4);
+        QCOMPARE(tree.descendants(col2.id()), Akonadi::Collection::List() << col3);
+        QVERIFY(!tree.collection(46).isValid());
+    }
+
+    void shouldReactToCollectionNotifications()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree tree(monitor);
+
+        auto col1 = createCollection(42, "1", Akonadi::Collection::root());
+        auto col2 = createCollection(43, "2", col1);
+        auto col3 = createCollection(44, "3", col2);
+        tree.setCollections(Akonadi::Collection::List() << col1 << col2 << col3);
+        QCOMPARE(tree.collection(col3.id()).parentCollection().name(), QString("2"));
+
+        // WHEN
+        auto col4 = createCollection(45, "4", col1);
+        monitor->addCollection(col4);
+
+        // THEN
+        QCOMPARE(tree.children(col1.id()), Akonadi::Collection::List() << col2 << col4);
+
+        // WHEN
+        col2.setName("2bis");
+        monitor->changeCollection(col2);
+
+        // THEN
+        QCOMPARE(tree.collection(col3.id()).parentCollection().name(), QString("2bis"));
+
+        // WHEN
+        col2.setParentCollection(tree.collection(col4.id()));
+        monitor->changeCollection(col2);
+
+        // THEN
+        QCOMPARE(tree.children(col1.id()), Akonadi::Collection::List() << col4);
+        QCOMPARE(tree.children(col4.id()), Akonadi::Collection::List() << col2);
+        QCOMPARE(tree.collection(col3.id()).parentCollection().parentCollection().name(), QString("4"));
+
+        // WHEN
+        monitor->removeCollection(col4);
+
+        // THEN
+        QVERIFY(!tree.collection(col4.id()).isValid());
+        QVERIFY(!tree.collection(col2.id()).isValid());
+        QVERIFY(!tree.collection(col3.id()).isValid());
+        QCOMPARE(tree.descendants(Akonadi::Collection::root().id()), Akonadi::Collection::List() << col1);
+    }
+
+    void shouldIgnoreAddedCollectionsUntilPopulated()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree tree(monitor);
+
+        // WHEN
+        monitor->addCollection(createCollection(42, "1", Akonadi::Collection::root()));
+
+        // THEN
+        QVERIFY(!tree.collection(42).isValid());
+    }
+
+    void shouldApplyNotificationsReceivedWhileListing()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree tree(monitor);
+
+        auto col1 = createCollection(42, "1", Akonadi::Collection::root());
+        auto col2 = createCollection(43, "2", col1);
+        auto col3 = createCollection(44, "3", col1);
+        QVERIFY(tree.waitForPopulation([] (bool) {}));
+
+        // WHEN
+        monitor->addCollection(col3);
+        monitor->removeCollection(col2);
+        tree.setCollections(Akonadi::Collection::List() << col1 << col2);
+
+        // THEN
+        QCOMPARE(tree.children(col1.id()), Akonadi::Collection::List() << col3);
+        QVERIFY(!tree.collection(col2.id()).isValid());
+    }
+
+    void shouldSearchCollectionsByName()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree tree(monitor);
+
+        auto col1 = createCollection(42, "Calendars", Akonadi::Collection::root());
+        auto col2 = createCollection(43, "Work Tasks", col1);
+        auto col3 = createCollection(44, "Home tasks", col1);
+        auto col4 = createCollection(45, "Notes", Akonadi::Collection::root());
+        tree.setCollections(Akonadi::Collection::List() << col1 << col2 << col3 << col4);
+
+        // WHEN
+        auto result = tree.search("TASK");
+
+        // THEN
+        QCOMPARE(result, Akonadi::Collection::List() << col2 << col3);
+        QCOMPARE(result.first().parentCollection().name(), QString("Calendars"));
+
+        // WHEN
+        result = tree.search("es");
+
+        // THEN
+        QCOMPARE(result, Akonadi::Collection::List() << col4);
+
+        // WHEN
+        result = tree.search("");
+
+        // THEN
+        QCOMPARE(result, Akonadi::Collection::List() << col1 << col2 << col3 << col4);
+
+        // WHEN
+        result = tree.search("ksat");
+
+        // THEN
+        QVERIFY(result.isEmpty());
+    }
+
+    void shouldKeepTheSearchIndexUpToDate()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree tree(monitor);
+
+        auto col1 = createCollection(42, "Calendars", Akonadi::Collection::root());
+        auto col2 = createCollection(43, "Work Tasks", col1);
+        tree.setCollections(Akonadi::Collection::List() << col1 << col2);
+
+        // WHEN
+        auto col3 = createCollection(44, "Home tasks", col1);
+        monitor->addCollection(col3);
+
+        // THEN
+        QCOMPARE(tree.search("task"), Akonadi::Collection::List() << col2 << col3);
+
+        // WHEN
+        col2.setName("Work");
+        monitor->changeCollection(col2);
+
+        // THEN
+        QCOMPARE(tree.search("task"), Akonadi::Collection::List() << col3);
+        QCOMPARE(tree.search("work").size(), 1);
+
+        // WHEN
+        monitor->removeCollection(col3);
+
+        // THEN
+        QVERIFY(tree.search("task").isEmpty());
+    }
+
+    void shouldKeepHiddenCollectionsOnlyWhenListingAll()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::CollectionTree displayedTree(monitor);
+        Akonadi::CollectionTree allTree(monitor, Akonadi::CollectionTree::AllCollections);
+
+        auto col1 = createCollection(42, "Tasks", Akonadi::Collection::root());
+        displayedTree.setCollections(Akonadi::Collection::List() << col1);
+        allTree.setCollections(Akonadi::Collection::List() << col1);
+
+        // WHEN
+        col1.setShouldList(Akonadi::Collection::ListDisplay, false);
+        monitor->changeCollection(col1);
+
+        // THEN
+        QVERIFY(displayedTree.search("task").isEmpty());
+        QCOMPARE(allTree.search("task"), Akonadi::Collection::List() << col1);
+    }
+};
+
+QTEST_MAIN(AkonadiCollectionTreeTest)
+
+#include "akonadicollectiontreetest.moc"
@@ -391,6 +391,79 @@ private slots:
         QCOMPARE(result->data().at(1), task2);
     }
 
+    void shouldLookInTagIndexForContextTopLevelTasks()
+    {
+        // GIVEN
+
+        // A context
+        Akonadi::Tag tag(43);
+        tag.setType(Akonadi::SerializerInterface::contextTagType());
+        auto context = Domain::Context::Ptr::create();
+
+        // One collection with two tasks related to the context and one unrelated
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col);
+
+        Akonadi::Item item1(44);
+        item1.setParentCollection(col);
+        item1.setTags(Akonadi::Tag::List() << tag);
+        auto task1 = Domain::Task::Ptr::create();
+        Akonadi::Item item2(45);
+        item2.setParentCollection(col);
+        Akonadi::Item item3(47);
+        item3.setParentCollection(col);
+        item3.setTags(Akonadi::Tag::List() << tag);
+        auto task3 = Domain::Task::Ptr::create();
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1 << item2 << item3);
+
+        // Storage mock only returning the jobs to populate the index
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                 .thenReturn(collectionFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col).thenReturn(itemFetchJob);
+
+        // Serializer mock returning the objects from the items
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::createTagFromContext).when(context).thenReturn(tag);
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item3).thenReturn(task3);
+        serializerMock(&Akonadi::SerializerInterface::isContextChild).when(context, item1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isContextChild).when(context, item3).thenReturn(true);
+
+        // The relation index populating the tag index, the items have no relations
+        foreach (const Akonadi::Item &item, Akonadi::Item::List() << item1 << item2 << item3) {
+            serializerMock(&Akonadi::SerializerInterface::itemUid).when(item).thenReturn(QString());
+            serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn(QString());
+        }
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        auto tagIndex = Akonadi::TagIndex::Ptr::create(storageMock.getInstance(), relationIndex, monitor);
+
+        // WHEN
+        QScopedPointer<Domain::ContextQueries> queries(new Akonadi::ContextQueries(storageMock.getInstance(),
+                                                                                   serializerMock.getInstance(),
+                                                                                   monitor,
+                                                                                   tagIndex));
+        Domain::QueryResult<Domain::Task::Ptr>::Ptr result = queries->findTopLevelTasks(context);
+
+        // THEN
+        QVERIFY(result->data().isEmpty());
+        QTest::qWait(300);
+        QVERIFY(tagIndex->isPopulated());
+
+        QCOMPARE(result->data().size(), 2);
+        QCOMPARE(result->data().at(0), task1);
+        QCOMPARE(result->data().at(1), task3);
+    }
+
     void shouldReactToItemAddsForTopLevelTask()
     {
         // GIVEN
@@ -426,6 +499,7 @@ private slots:
         // WHEN
         Akonadi::Item item1(44);
         item1.setParentCollection(col);
+        item1.setTag(tag);
         auto task1 = Domain::Task::Ptr::create();
 
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
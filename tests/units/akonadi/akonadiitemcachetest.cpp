@@ -0,0 +1,225 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include <AkonadiCore/CollectionStatistics>
+
+#include "testlib/akonadifakemonitor.h"
+
+#include "akonadi/akonadiitemcache.h"
+
+class AkonadiItemCacheTest : public QObject
+{
+    Q_OBJECT
+private:
+    Akonadi::Item createItem(Akonadi::Item::Id id, int revision, const Akonadi::Collection &collection)
+    {
+        Akonadi::Item item(id);
+        item.setRevision(revision);
+        item.setParentCollection(collection);
+        return item;
+    }
+
+    QList<Akonadi::Item::Id> itemIds(const Akonadi::Item::List &items)
+    {
+        QList<Akonadi::Item::Id> result;
+        foreach (const Akonadi::Item &item, items)
+            result << item.id();
+        return result;
+    }
+
+private slots:
+    void shouldFollowTheMonitorForCachedCollections()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::ItemCache cache(monitor);
+
+        Akonadi::Collection col1(1);
+        Akonadi::Collection col2(2);
+        cache.beginFetch(col1.id());
+        cache.setItems(col1.id(), Akonadi::Item::List() << createItem(42, 0, col1) << createItem(43, 0, col1));
+
+        // WHEN
+        auto changedItem = createItem(42, 1, col1);
+        changedItem.setPayloadFromData("foo");
+        monitor->addItem(createItem(44, 0, col1));
+        monitor->changeItem(changedItem);
+        monitor->removeItem(createItem(43, 0, col1));
+        monitor->addItem(createItem(45, 0, col2));
+
+        // THEN
+        QVERIFY(cache.isCached(col1.id()));
+        QVERIFY(!cache.isStale(col1.id()));
+        QVERIFY(!cache.isCached(col2.id()));
+        const auto items = cache.items(col1.id());
+        QCOMPARE(itemIds(items), QList<Akonadi::Item::Id>() << 42 << 44);
+        QCOMPARE(items.first().revision(), 1);
+
+        // WHEN
+        monitor->changeItemRevision(createItem(42, 2, col1));
+
+        // THEN
+        QCOMPARE(cache.items(col1.id()).first().revision(), 2);
+        QCOMPARE(cache.items(col1.id()).first().payloadData(), QByteArray("foo"));
+
+        // WHEN
+        monitor->moveItem(createItem(44, 1, col2));
+
+        // THEN
+        QCOMPARE(itemIds(cache.items(col1.id())), QList<Akonadi::Item::Id>() << 42);
+
+        // WHEN
+        monitor->removeCollection(col1);
+
+        // THEN
+        QVERIFY(!cache.isCached(col1.id()));
+    }
+
+    void shouldBeStaleWhenNotifiedDuringAFetch()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::ItemCache cache(monitor);
+
+        Akonadi::Collection col(1);
+
+        // WHEN
+        cache.beginFetch(col.id());
+        monitor->changeItem(createItem(42, 1, col));
+        cache.setItems(col.id(), Akonadi::Item::List() << createItem(42, 0, col));
+
+        // THEN
+        QVERIFY(cache.isCached(col.id()));
+        QVERIFY(cache.isStale(col.id()));
+    }
+
+    void shouldLetOthersWaitForARunningFetch()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::ItemCache cache(monitor);
+
+        Akonadi::Collection col(1);
+        QList<bool> outcomes;
+        auto callback = [&outcomes] (bool success) { outcomes << success; };
+
+        // WHEN
+        cache.beginFetch(col.id());
+        cache.waitForFetch(col.id(), callback);
+        cache.waitForFetch(col.id(), callback);
+
+        // THEN
+        QVERIFY(cache.isFetching(col.id()));
+        QVERIFY(outcomes.isEmpty());
+
+        // WHEN
+        cache.setItems(col.id(), Akonadi::Item::List() << createItem(44, 0, col)
+                                                       << createItem(42, 0, col)
+                                                       << createItem(43, 0, col));
+
+        // THEN
+        QVERIFY(!cache.isFetching(col.id()));
+        QCOMPARE(outcomes, QList<bool>() << true << true);
+        QCOMPARE(itemIds(cache.items(col.id())), QList<Akonadi::Item::Id>() << 42 << 43 << 44);
+
+        // WHEN
+        outcomes.clear();
+        cache.beginFetch(col.id());
+        cache.waitForFetch(col.id(), callback);
+        cache.cancelFetch(col.id());
+
+        // THEN
+        QVERIFY(!cache.isFetching(col.id()));
+        QCOMPARE(outcomes, QList<bool>() << false);
+    }
+
+    void shouldBeStaleWhenTheStatisticsDontMatch()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::ItemCache cache(monitor);
+
+        Akonadi::Collection col(1);
+        cache.beginFetch(col.id());
+        cache.setItems(col.id(), Akonadi::Item::List() << createItem(42, 0, col) << createItem(43, 0, col));
+
+        Akonadi::CollectionStatistics statistics;
+        statistics.setCount(2);
+        col.setStatistics(statistics);
+
+        // WHEN
+        monitor->changeCollectionStatistics(col);
+
+        // THEN
+        QVERIFY(!cache.isStale(col.id()));
+
+        // WHEN
+        statistics.setCount(3);
+        col.setStatistics(statistics);
+        monitor->changeCollectionStatistics(col);
+
+        // THEN
+        QVERIFY(cache.isStale(col.id()));
+    }
+
+    void shouldOnlyRefreshOutdatedItems()
+    {
+        // GIVEN
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::ItemCache cache(monitor);
+
+        Akonadi::Collection col(1);
+        auto item1 = createItem(42, 0, col);
+        item1.setPayloadFromData("cached");
+        cache.beginFetch(col.id());
+        cache.setItems(col.id(), Akonadi::Item::List() << item1 << createItem(43, 0, col) << createItem(44, 0, col));
+
+        // Item 43 changed, item 44 is gone and item 45 is new
+        const auto listedItems = Akonadi::Item::List() << createItem(42, 0, col)
+                                                       << createItem(43, 1, col)
+                                                       << createItem(45, 0, col);
+
+        // WHEN
+        const auto outdatedItems = cache.outdatedItems(col.id(), listedItems);
+
+        // THEN
+        QCOMPARE(itemIds(outdatedItems), QList<Akonadi::Item::Id>() << 43 << 45);
+
+        // WHEN
+        cache.beginFetch(col.id());
+        cache.updateItems(col.id(), listedItems, Akonadi::Item::List() << createItem(43, 1, col) << createItem(45, 0, col));
+
+        // THEN
+        QVERIFY(!cache.isStale(col.id()));
+        const auto items = cache.items(col.id());
+        QCOMPARE(itemIds(items), QList<Akonadi::Item::Id>() << 42 << 43 << 45);
+        QCOMPARE(items.at(0).payloadData(), QByteArray("cached"));
+        QCOMPARE(items.at(1).revision(), 1);
+    }
+};
+
+QTEST_MAIN(AkonadiItemCacheTest)
+
+#include "akonadiitemcachetest.moc"
@@ -0,0 +1,89 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "testlib/akonadifakejobs.h"
+
+#include "utils/jobhandler.h"
+
+class AkonadiItemFetchJobInterfaceTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void shouldStreamItemsInBatches()
+    {
+        // GIVEN
+        Akonadi::Item item1(42);
+        Akonadi::Item item2(43);
+        auto job = new Testlib::AkonadiFakeItemFetchJob(this);
+        job->setItems(Akonadi::Item::List() << item1 << item2);
+
+        // WHEN
+        Akonadi::Item::List receivedItems;
+        bool resultHandled = false;
+        job->streamItems([&receivedItems] (const Akonadi::Item::List &items) {
+            receivedItems << items;
+        }, [&resultHandled] {
+            resultHandled = true;
+        });
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(receivedItems, Akonadi::Item::List() << item1 << item2);
+        QVERIFY(resultHandled);
+        QCOMPARE(Utils::JobHandler::jobCount(), 0);
+    }
+
+    void shouldDropBatchesOnceAbandoned()
+    {
+        // GIVEN
+        int owner = 0;
+        auto job = new Testlib::AkonadiFakeItemFetchJob(this);
+        job->setItems(Akonadi::Item::List() << Akonadi::Item(42));
+
+        Akonadi::Item::List receivedItems;
+        bool resultHandled = false;
+        {
+            Utils::JobHandler::OwnerScope scope(&owner);
+            job->streamItems([&receivedItems] (const Akonadi::Item::List &items) {
+                receivedItems << items;
+            }, [&resultHandled] {
+                resultHandled = true;
+            });
+        }
+
+        // WHEN
+        Utils::JobHandler::abandon(&owner);
+        QTest::qWait(150);
+
+        // THEN
+        QVERIFY(receivedItems.isEmpty());
+        QVERIFY(!resultHandled);
+        QCOMPARE(Utils::JobHandler::jobCount(), 0);
+    }
+};
+
+QTEST_MAIN(AkonadiItemFetchJobInterfaceTest)
+
+#include "akonadiitemfetchjobinterfacetest.moc"
@@ -0,0 +1,289 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include <AkonadiCore/Item>
+
+#include "utils/mockobject.h"
+
+#include "testlib/akonadifakejobs.h"
+#include "testlib/akonadifakemonitor.h"
+
+#include "akonadi/akonadiitemwritequeue.h"
+#include "akonadi/akonadistorageinterface.h"
+
+using namespace mockitopp;
+using namespace mockitopp::matcher;
+
+class AkonadiItemWriteQueueTest : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AkonadiItemWriteQueueTest(QObject *parent = Q_NULLPTR)
+        : QObject(parent)
+    {
+        qRegisterMetaType<Akonadi::Item::List>();
+    }
+
+private slots:
+    void shouldMergeTheWritesOfAnItemWithinAFlush()
+    {
+        // GIVEN
+        Akonadi::Item item(42);
+
+        auto transactionJob = new FakeJob(this);
+        auto writeJob = new FakeJob(this);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item, transactionJob)
+                                                           .thenReturn(writeJob);
+
+        auto monitor = Akonadi::MonitorInterface::Ptr(new AkonadiFakeMonitor);
+
+        Akonadi::ItemWriteQueue queue(storageMock.getInstance(), monitor);
+
+        // WHEN
+        auto job1 = queue.updateItem(item);
+        auto job2 = queue.updateItem(item);
+        auto job3 = queue.updateItem(item);
+
+        QSignalSpy spy1(job1, SIGNAL(result(KJob*)));
+        QSignalSpy spy2(job2, SIGNAL(result(KJob*)));
+        QSignalSpy spy3(job3, SIGNAL(result(KJob*)));
+
+        QTest::qWait(Akonadi::ItemWriteQueue::flushDelay() + FakeJob::DURATION * 3);
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item, transactionJob).exactly(1));
+        QCOMPARE(spy1.count(), 1);
+        QCOMPARE(spy2.count(), 1);
+        QCOMPARE(spy3.count(), 1);
+    }
+
+    void shouldFlushSeveralItemsInOneTransaction()
+    {
+        // GIVEN
+        Akonadi::Item item1(42);
+        Akonadi::Item item2(43);
+
+        auto transactionJob = new FakeJob(this);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item1, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item2, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+
+        auto monitor = Akonadi::MonitorInterface::Ptr(new AkonadiFakeMonitor);
+
+        Akonadi::ItemWriteQueue queue(storageMock.getInstance(), monitor);
+
+        // WHEN
+        auto job1 = queue.updateItem(item1);
+        auto job2 = queue.updateItem(item2);
+
+        QSignalSpy spy1(job1, SIGNAL(result(KJob*)));
+        QSignalSpy spy2(job2, SIGNAL(result(KJob*)));
+
+        // Written one after the other they wouldn't both be done by then
+        QTest::qWait(Akonadi::ItemWriteQueue::flushDelay() + FakeJob::DURATION * 3 / 2);
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::createTransaction).when().exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item1, transactionJob).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item2, transactionJob).exactly(1));
+        QCOMPARE(spy1.count(), 1);
+        QCOMPARE(spy2.count(), 1);
+    }
+
+    void shouldFlushTheQueuedWritesOfItemsOnDemand()
+    {
+        // GIVEN
+        Akonadi::Item item1(42);
+        Akonadi::Item item2(43);
+
+        auto transactionJob = new FakeJob(this);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item1, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+
+        auto monitor = Akonadi::MonitorInterface::Ptr(new AkonadiFakeMonitor);
+
+        Akonadi::ItemWriteQueue queue(storageMock.getInstance(), monitor);
+        auto writeJob = queue.updateItem(item1);
+        QSignalSpy writeSpy(writeJob, SIGNAL(result(KJob*)));
+
+        // WHEN
+        QVERIFY(!queue.flushItems(Akonadi::Item::List() << item2));
+        auto flushJob = queue.flushItems(Akonadi::Item::List() << item1 << item2);
+        QVERIFY(flushJob);
+        QSignalSpy flushSpy(flushJob, SIGNAL(result(KJob*)));
+        flushJob->start();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item1, transactionJob).exactly(1));
+        QTRY_COMPARE(flushSpy.count(), 1);
+        QCOMPARE(writeSpy.count(), 1);
+    }
+
+    void shouldNotifyTheStoredItemWhenAFlushFails()
+    {
+        // GIVEN
+        Akonadi::Item item(42);
+
+        // A failing write, taking its transaction down
+        auto transactionJob = new FakeJob(this);
+        transactionJob->setExpectedError(KJob::UserDefinedError, QStringLiteral("Bar"));
+        auto writeJob = new FakeJob(this);
+        writeJob->setExpectedError(KJob::KilledJobError, QStringLiteral("Foo"));
+
+        // A fetch job bringing back the stored item
+        Akonadi::Item storedItem(42);
+        storedItem.setPayloadFromData("stored");
+        auto fetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        fetchJob->setItems(Akonadi::Item::List() << storedItem);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item, transactionJob)
+                                                           .thenReturn(writeJob);
+        storageMock(&Akonadi::StorageInterface::fetchItem).when(item)
+                                                          .thenReturn(fetchJob);
+
+        auto monitor = Akonadi::MonitorInterface::Ptr(new AkonadiFakeMonitor);
+        QSignalSpy monitorSpy(monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)));
+
+        Akonadi::ItemWriteQueue queue(storageMock.getInstance(), monitor);
+
+        // WHEN
+        auto job = queue.updateItem(item);
+        QSignalSpy jobSpy(job, SIGNAL(result(KJob*)));
+        QTest::qWait(Akonadi::ItemWriteQueue::flushDelay() + FakeJob::DURATION * 3);
+
+        // THEN
+        QCOMPARE(jobSpy.count(), 1);
+        QCOMPARE(job->error(), int(KJob::KilledJobError));
+        QCOMPARE(job->errorText(), QStringLiteral("Foo"));
+
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItem).when(item).exactly(1));
+        QCOMPARE(monitorSpy.count(), 1);
+        auto notifiedItems = monitorSpy.takeFirst().at(0).value<Akonadi::Item::List>();
+        QCOMPARE(notifiedItems.size(), 1);
+        QCOMPARE(notifiedItems.first().payloadData(), QByteArray("stored"));
+    }
+
+    void shouldWriteTheOtherItemsAgainWhenAFlushFails()
+    {
+        // GIVEN
+        Akonadi::Item item1(42);
+        Akonadi::Item item2(43);
+
+        // The first transaction fails because of item1
+        auto transactionJob1 = new FakeJob(this);
+        transactionJob1->setExpectedError(KJob::UserDefinedError, QStringLiteral("Bar"));
+        auto failingJob = new FakeJob(this);
+        failingJob->setExpectedError(KJob::KilledJobError, QStringLiteral("Foo"));
+        auto transactionJob2 = new FakeJob(this);
+
+        auto fetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        fetchJob->setItems(Akonadi::Item::List() << item1);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob1)
+                                                                         .thenReturn(transactionJob2);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item1, transactionJob1)
+                                                           .thenReturn(failingJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item2, transactionJob1)
+                                                           .thenReturn(new FakeJob(this));
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item2, transactionJob2)
+                                                           .thenReturn(new FakeJob(this));
+        storageMock(&Akonadi::StorageInterface::fetchItem).when(item1)
+                                                          .thenReturn(fetchJob);
+
+        auto monitor = Akonadi::MonitorInterface::Ptr(new AkonadiFakeMonitor);
+        QSignalSpy monitorSpy(monitor.data(), SIGNAL(itemsChanged(Akonadi::Item::List)));
+
+        Akonadi::ItemWriteQueue queue(storageMock.getInstance(), monitor);
+
+        // WHEN
+        QScopedPointer<KJob> job1(queue.updateItem(item1));
+        job1->setAutoDelete(false);
+        QScopedPointer<KJob> job2(queue.updateItem(item2));
+        job2->setAutoDelete(false);
+        QSignalSpy spy1(job1.data(), SIGNAL(result(KJob*)));
+        QSignalSpy spy2(job2.data(), SIGNAL(result(KJob*)));
+        QTest::qWait(Akonadi::ItemWriteQueue::flushDelay() + FakeJob::DURATION * 4);
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::createTransaction).when().exactly(2));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item1, transactionJob1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item2, transactionJob1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item2, transactionJob2).exactly(1));
+
+        QCOMPARE(spy1.count(), 1);
+        QCOMPARE(job1->error(), int(KJob::KilledJobError));
+        QCOMPARE(spy2.count(), 1);
+        QCOMPARE(job2->error(), int(KJob::NoError));
+
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItem).when(item1).exactly(1));
+        QCOMPARE(monitorSpy.count(), 1);
+        auto notifiedItems = monitorSpy.takeFirst().at(0).value<Akonadi::Item::List>();
+        QCOMPARE(notifiedItems.size(), 1);
+        QCOMPARE(notifiedItems.first().id(), item1.id());
+    }
+
+    void shouldWriteTheQueuedItemsBeforeGoingAway()
+    {
+        // GIVEN
+        Akonadi::Item item(42);
+
+        auto transactionJob = new FakeJob(this);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(item, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+
+        auto monitor = Akonadi::MonitorInterface::Ptr(new AkonadiFakeMonitor);
+
+        QScopedPointer<Akonadi::ItemWriteQueue> queue(new Akonadi::ItemWriteQueue(storageMock.getInstance(), monitor));
+        auto job = queue->updateItem(item);
+        QSignalSpy spy(job, SIGNAL(result(KJob*)));
+
+        // WHEN
+        queue.reset();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(item, transactionJob).exactly(1));
+        QCOMPARE(spy.count(), 1);
+    }
+};
+
+QTEST_MAIN(AkonadiItemWriteQueueTest)
+
+#include "akonadiitemwritequeuetest.moc"
@@ -0,0 +1,94 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "akonadi/akonadimonitorimpl.h"
+
+typedef Akonadi::MonitorImpl::PendingChanges PendingChanges;
+Q_DECLARE_METATYPE(PendingChanges)
+
+class AkonadiMonitorImplTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void shouldMergePendingChanges_data()
+    {
+        QTest::addColumn<PendingChanges>("previous");
+        QTest::addColumn<int>("change");
+        QTest::addColumn<PendingChanges>("expected");
+
+        const PendingChanges none = Akonadi::MonitorImpl::NoChange;
+        const PendingChanges added = Akonadi::MonitorImpl::ItemAdded;
+        const PendingChanges removed = Akonadi::MonitorImpl::ItemRemoved;
+        const PendingChanges changed = Akonadi::MonitorImpl::ItemChanged;
+        const PendingChanges moved = Akonadi::MonitorImpl::ItemMoved;
+
+        QTest::newRow("nothing then added") << none << int(Akonadi::MonitorImpl::ItemAdded) << added;
+        QTest::newRow("nothing then removed") << none << int(Akonadi::MonitorImpl::ItemRemoved) << removed;
+        QTest::newRow("nothing then changed") << none << int(Akonadi::MonitorImpl::ItemChanged) << changed;
+        QTest::newRow("nothing then moved") << none << int(Akonadi::MonitorImpl::ItemMoved) << moved;
+
+        QTest::newRow("added then added") << added << int(Akonadi::MonitorImpl::ItemAdded) << added;
+        QTest::newRow("added then removed") << added << int(Akonadi::MonitorImpl::ItemRemoved) << none;
+        QTest::newRow("added then changed") << added << int(Akonadi::MonitorImpl::ItemChanged) << added;
+        QTest::newRow("added then moved") << added << int(Akonadi::MonitorImpl::ItemMoved) << added;
+
+        QTest::newRow("removed then added") << removed << int(Akonadi::MonitorImpl::ItemAdded) << changed;
+        QTest::newRow("removed then removed") << removed << int(Akonadi::MonitorImpl::ItemRemoved) << removed;
+        QTest::newRow("removed then changed") << removed << int(Akonadi::MonitorImpl::ItemChanged) << removed;
+        QTest::newRow("removed then moved") << removed << int(Akonadi::MonitorImpl::ItemMoved) << removed;
+
+        QTest::newRow("changed then added") << changed << int(Akonadi::MonitorImpl::ItemAdded) << changed;
+        QTest::newRow("changed then removed") << changed << int(Akonadi::MonitorImpl::ItemRemoved) << removed;
+        QTest::newRow("changed then changed") << changed << int(Akonadi::MonitorImpl::ItemChanged) << changed;
+        QTest::newRow("changed then moved") << changed << int(Akonadi::MonitorImpl::ItemMoved) << (changed | moved);
+
+        QTest::newRow("moved then added") << moved << int(Akonadi::MonitorImpl::ItemAdded) << changed;
+        QTest::newRow("moved then removed") << moved << int(Akonadi::MonitorImpl::ItemRemoved) << removed;
+        QTest::newRow("moved then changed") << moved << int(Akonadi::MonitorImpl::ItemChanged) << (changed | moved);
+        QTest::newRow("moved then moved") << moved << int(Akonadi::MonitorImpl::ItemMoved) << moved;
+
+        QTest::newRow("changed and moved then removed") << (changed | moved) << int(Akonadi::MonitorImpl::ItemRemoved) << removed;
+        QTest::newRow("changed and moved then changed") << (changed | moved) << int(Akonadi::MonitorImpl::ItemChanged) << (changed | moved);
+        QTest::newRow("changed and moved then moved") << (changed | moved) << int(Akonadi::MonitorImpl::ItemMoved) << (changed | moved);
+    }
+
+    void shouldMergePendingChanges()
+    {
+        // GIVEN
+        QFETCH(PendingChanges, previous);
+        QFETCH(int, change);
+
+        // WHEN
+        auto result = Akonadi::MonitorImpl::mergeChanges(previous, Akonadi::MonitorImpl::PendingChange(change));
+
+        // THEN
+        QFETCH(PendingChanges, expected);
+        QCOMPARE(int(result), int(expected));
+    }
+};
+
+QTEST_MAIN(AkonadiMonitorImplTest)
+
+#include "akonadimonitorimpltest.moc"
@@ -406,10 +406,8 @@ private slots:
         col1.setParentCollection(Akonadi::Collection::root());
         Akonadi::Collection col2(43);
         col2.setParentCollection(Akonadi::Collection::root());
-        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob1 = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob1->setCollections(Akonadi::Collection::List() << col1 << col2);
-        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob2 = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob2->setCollections(Akonadi::Collection::List() << col1 << col2);
+        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col1 << col2);
 
         // Two projects, one in each collection
         Akonadi::Item item1(42);
@@ -417,33 +415,36 @@ private slots:
         Domain::Project::Ptr project1(new Domain::Project);
         Testlib::AkonadiFakeItemFetchJob *itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
         itemFetchJob1->setItems(Akonadi::Item::List() << item1);
-        Testlib::AkonadiFakeItemFetchJob *itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob2->setItems(Akonadi::Item::List() << item1);
 
         Akonadi::Item item2(43);
         item2.setParentCollection(col2);
         Domain::Project::Ptr project2(new Domain::Project);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob2->setItems(Akonadi::Item::List() << item2);
         Testlib::AkonadiFakeItemFetchJob *itemFetchJob3 = new Testlib::AkonadiFakeItemFetchJob(this);
         itemFetchJob3->setItems(Akonadi::Item::List() << item2);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob4 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob4->setItems(Akonadi::Item::List() << item2);
 
         // Storage mock returning the fetch jobs
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
                                                                        Akonadi::StorageInterface::Tasks)
-                                                                 .thenReturn(collectionFetchJob1)
-                                                                 .thenReturn(collectionFetchJob2);
+                                                                 .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col1)
-                                                           .thenReturn(itemFetchJob1)
-                                                           .thenReturn(itemFetchJob2);
+                                                           .thenReturn(itemFetchJob1);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col2)
-                                                           .thenReturn(itemFetchJob3);
+                                                           .thenReturn(itemFetchJob2)
+                                                           .thenReturn(itemFetchJob3)
+                                                           .thenReturn(itemFetchJob4);
 
         // Serializer mock returning the projects from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
         serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col2).thenReturn(true)
-                                                                                      .thenReturn(false);
+                                                                                      .thenReturn(false)
+                                                                                      .thenReturn(true);
 
         serializerMock(&Akonadi::SerializerInterface::isProjectItem).when(item1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isProjectItem).when(item2).thenReturn(true);
@@ -473,19 +474,37 @@ private slots:
         // THEN
         QCOMPARE(result->data().size(), 1);
         QCOMPARE(result->data().first(), project1);
+
+        // WHEN
+        monitor->changeCollectionSelection(col2);
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(result->data().size(), 2);
+        QCOMPARE(result->data().first(), project1);
+        QCOMPARE(result->data().last(), project2);
+
+        // Only the toggled collection got fetched again
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                               Akonadi::StorageInterface::Recursive,
+                                                                               Akonadi::StorageInterface::Tasks)
+                                                                         .exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(3));
     }
 
-    void shouldLookInAllCollectionsForProjectTopLevelArtifacts()
+
+    void shouldLookInProjectAndNotesCollectionsForProjectTopLevelArtifacts()
     {
         // GIVEN
 
-        // Two top level collections
+        // Two top level collections, only the second one holds notes
         Akonadi::Collection col1(42);
         col1.setParentCollection(Akonadi::Collection::root());
         Akonadi::Collection col2(43);
         col2.setParentCollection(Akonadi::Collection::root());
         auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob->setCollections(Akonadi::Collection::List() << col1 << col2);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col2);
 
         // One project and two tasks in the first collection
         Akonadi::Item item1(42);
@@ -514,7 +533,7 @@ private slots:
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col1)
                                                            .thenReturn(itemFetchJob1);
@@ -546,6 +565,19 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item4).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item5).thenReturn(false);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item4).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item5).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item4).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item5).thenReturn(QString());
+
         // WHEN
         QScopedPointer<Domain::ProjectQueries> queries(new Akonadi::ProjectQueries(storageMock.getInstance(),
                                                                                    serializerMock.getInstance(),
@@ -588,31 +620,31 @@ private slots:
         item1.setParentCollection(col);
         auto project1 = Domain::Project::Ptr::create();
 
-        // We'll make the same queries twice
+        // We'll make the same queries twice, the second time items come from the index
         auto collectionFetchJob11 = new Testlib::AkonadiFakeCollectionFetchJob(this);
         collectionFetchJob11->setCollections(Akonadi::Collection::List() << col);
-        auto itemFetchJob21 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob21->setItems(Akonadi::Item::List() << item1);
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1);
         auto collectionFetchJob12 = new Testlib::AkonadiFakeCollectionFetchJob(this);
         collectionFetchJob12->setCollections(Akonadi::Collection::List() << col);
-        auto itemFetchJob22 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob22->setItems(Akonadi::Item::List() << item1);
 
         // Storage mock returning the fetch jobs
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob11)
                                                                  .thenReturn(collectionFetchJob12);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
-                                                           .thenReturn(itemFetchJob21)
-                                                           .thenReturn(itemFetchJob22);
+                                                           .thenReturn(itemFetchJob);
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
         serializerMock(&Akonadi::SerializerInterface::createItemFromProject).when(project1).thenReturn(item1);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item1).thenReturn(false);
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
 
         QScopedPointer<Domain::ProjectQueries> queries(new Akonadi::ProjectQueries(storageMock.getInstance(),
                                                                                    serializerMock.getInstance(),
@@ -634,6 +666,8 @@ private slots:
             QTest::qWait(150);
             QVERIFY(result->data().isEmpty());
         }
+
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
     }
 
     void shouldReactToItemAddsForTopLevelArtifact()
@@ -657,7 +691,7 @@ private slots:
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
                                                            .thenReturn(itemFetchJob);
@@ -668,6 +702,11 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::createItemFromProject).when(project1).thenReturn(item1);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item1).thenReturn(false);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -677,7 +716,8 @@ private slots:
         Domain::QueryResult<Domain::Artifact::Ptr>::Ptr result = queries->findTopLevelArtifacts(project1);
         QTest::qWait(150);
         QVERIFY(result->data().isEmpty());
-        QVERIFY(serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item1).exactly(1));
+        // item1 isn't a child in the index, no need to check it
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item1).exactly(0));
 
         // WHEN
         Akonadi::Item item2(43);
@@ -701,6 +741,11 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item3).thenReturn(true);
 
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         monitor->addItem(item2);
         monitor->addItem(item3);
 
@@ -740,7 +785,7 @@ private slots:
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
                                                            .thenReturn(itemFetchJob);
@@ -769,6 +814,15 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -825,7 +879,7 @@ private slots:
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
                                                            .thenReturn(itemFetchJob);
@@ -855,6 +909,16 @@ private slots:
                                                                                            .thenReturn(false);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1")
+                                                                                     .thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -906,7 +970,7 @@ private slots:
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
                                                            .thenReturn(itemFetchJob);
@@ -932,10 +996,19 @@ private slots:
 
         // Serializer mock returning if task1 is parent of items
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item1).thenReturn(false);
-        serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item2).thenReturn(false)
-                                                                                           .thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn(QString())
+                                                                                     .thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -985,19 +1058,16 @@ private slots:
 
         auto collectionFetchJob2 = new Testlib::AkonadiFakeCollectionFetchJob(this);
         collectionFetchJob2->setCollections(Akonadi::Collection::List() << col);
-        auto itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob2->setItems(Akonadi::Item::List() << item1 << item2 << item3);
 
         // Storage mock returning the fetch jobs
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob1)
                                                                  .thenReturn(collectionFetchJob2);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
-                                                           .thenReturn(itemFetchJob1)
-                                                           .thenReturn(itemFetchJob2);
+                                                           .thenReturn(itemFetchJob1);
 
         // Serializer mock returning the objects from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
@@ -1023,8 +1093,18 @@ private slots:
         // Serializer mock returning if project2 is parent of items
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project2, item1).thenReturn(false);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project2, item2).thenReturn(false);
-        serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project2, item3).thenReturn(false)
-                                                                                           .thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project2, item3).thenReturn(true);
+
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1")
+                                                                                     .thenReturn("2");
 
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
@@ -1047,6 +1127,9 @@ private slots:
         QCOMPARE(result1->data().size(), 0);
         QCOMPARE(result2->data().size(), 1);
         QCOMPARE(result2->data().at(0).objectCast<Domain::Task>(), task3);
+
+        // Both queries shared the same collection fetch
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
     }
 
     void shouldReactToItemRemovesForTopLevelArtifacts()
@@ -1076,7 +1159,7 @@ private slots:
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                       Akonadi::StorageInterface::Notes)
                                                                  .thenReturn(collectionFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
                                                            .thenReturn(itemFetchJob);
@@ -1106,6 +1189,15 @@ private slots:
                                                                                            .thenReturn(false);
         serializerMock(&Akonadi::SerializerInterface::isProjectChild).when(project1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(project1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
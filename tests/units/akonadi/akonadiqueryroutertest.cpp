@@ -0,0 +1,250 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "akonadi/akonadiqueryrouter.h"
+
+#include "domain/livequery.h"
+
+typedef Domain::LiveQuery<Akonadi::Item, QString> ItemQuery;
+typedef Akonadi::QueryRouter<ItemQuery> ItemRouter;
+
+class AkonadiQueryRouterTest : public QObject
+{
+    Q_OBJECT
+private:
+    Akonadi::Item createItem(Akonadi::Item::Id id, const QString &key)
+    {
+        Akonadi::Item item(id);
+        item.setRemoteId(key);
+        return item;
+    }
+
+    // Items are matched by their remote id which acts as routing key,
+    // the items seen by the query are logged in seenIds
+    ItemQuery::Ptr createQuery(const QString &key, const Akonadi::Item::List &fetchedItems,
+                               const ItemRouter::Ptr &router, QList<Akonadi::Item::Id> *seenIds)
+    {
+        auto query = ItemQuery::Ptr::create();
+        query->setFetchFunction([key, fetchedItems, router] (const ItemQuery::AddFunction &queryAdd) {
+            auto add = key.isEmpty() ? queryAdd : router->trackedAdd(key, queryAdd);
+            foreach (const Akonadi::Item &item, fetchedItems)
+                add(item);
+        });
+        query->setConvertFunction([] (const Akonadi::Item &item) {
+            return QString::number(item.id());
+        });
+        query->setUpdateFunction([] (const Akonadi::Item &, QString &) {
+        });
+        query->setPredicateFunction([key, seenIds] (const Akonadi::Item &item) {
+            *seenIds << item.id();
+            return key.isEmpty() || item.remoteId() == key;
+        });
+        query->setRepresentsFunction([] (const Akonadi::Item &item, const QString &output) {
+            return QString::number(item.id()) == output;
+        });
+
+        if (key.isEmpty())
+            router->addQuery(query);
+        else
+            router->addQuery(key, query);
+
+        return query;
+    }
+
+private slots:
+    void shouldRouteItemsOnlyToInterestedQueries()
+    {
+        // GIVEN
+        auto router = ItemRouter::Ptr::create([] (const Akonadi::Item &item, QStringList &keys) {
+            keys << item.remoteId();
+            return true;
+        });
+
+        QList<Akonadi::Item::Id> globalIds, aIds, bIds;
+        auto globalQuery = createQuery(QString(), Akonadi::Item::List(), router, &globalIds);
+        auto aQuery = createQuery("a", Akonadi::Item::List(), router, &aIds);
+        auto bQuery = createQuery("b", Akonadi::Item::List(), router, &bIds);
+
+        auto globalResult = globalQuery->result();
+        auto aResult = aQuery->result();
+        auto bResult = bQuery->result();
+
+        // WHEN
+        router->onAdded(Akonadi::Item::List() << createItem(1, "a")
+                                              << createItem(2, "b")
+                                              << createItem(3, "c")
+                                              << createItem(4, "a"));
+
+        // THEN
+        QCOMPARE(globalIds, QList<Akonadi::Item::Id>() << 1 << 2 << 3 << 4);
+        QCOMPARE(aIds, QList<Akonadi::Item::Id>() << 1 << 4);
+        QCOMPARE(bIds, QList<Akonadi::Item::Id>() << 2);
+
+        QCOMPARE(globalResult->data(), QList<QString>() << "1" << "2" << "3" << "4");
+        QCOMPARE(aResult->data(), QList<QString>() << "1" << "4");
+        QCOMPARE(bResult->data(), QList<QString>() << "2");
+    }
+
+    void shouldRouteChangesToPreviousAndNewKeys()
+    {
+        // GIVEN
+        auto router = ItemRouter::Ptr::create([] (const Akonadi::Item &item, QStringList &keys) {
+            keys << item.remoteId();
+            return true;
+        });
+
+        QList<Akonadi::Item::Id> aIds, bIds, cIds;
+        auto aQuery = createQuery("a", Akonadi::Item::List() << createItem(1, "a") << createItem(2, "a"), router, &aIds);
+        auto bQuery = createQuery("b", Akonadi::Item::List(), router, &bIds);
+        auto cQuery = createQuery("c", Akonadi::Item::List(), router, &cIds);
+
+        auto aResult = aQuery->result();
+        auto bResult = bQuery->result();
+        auto cResult = cQuery->result();
+        QCOMPARE(aResult->data(), QList<QString>() << "1" << "2");
+        aIds.clear();
+
+        // WHEN
+        router->onChanged(Akonadi::Item::List() << createItem(1, "b"));
+
+        // THEN
+        QCOMPARE(aIds, QList<Akonadi::Item::Id>() << 1);
+        QCOMPARE(bIds, QList<Akonadi::Item::Id>() << 1);
+        QVERIFY(cIds.isEmpty());
+
+        QCOMPARE(aResult->data(), QList<QString>() << "2");
+        QCOMPARE(bResult->data(), QList<QString>() << "1");
+        QVERIFY(cResult->data().isEmpty());
+
+        // WHEN
+        router->onRemoved(Akonadi::Item::List() << createItem(1, QString())
+                                                << createItem(2, QString()));
+
+        // THEN
+        QVERIFY(aResult->data().isEmpty());
+        QVERIFY(bResult->data().isEmpty());
+        QVERIFY(cResult->data().isEmpty());
+    }
+
+    void shouldRouteItemsWithUnknownKeysToAllKeyedQueries()
+    {
+        // GIVEN
+        auto router = ItemRouter::Ptr::create([] (const Akonadi::Item &item, QStringList &keys) {
+            if (item.remoteId().isEmpty())
+                return false;
+
+            keys << item.remoteId();
+            return true;
+        });
+
+        QList<Akonadi::Item::Id> aIds, bIds;
+        auto aQuery = createQuery("a", Akonadi::Item::List(), router, &aIds);
+        auto bQuery = createQuery("b", Akonadi::Item::List(), router, &bIds);
+
+        auto aResult = aQuery->result();
+        auto bResult = bQuery->result();
+
+        // WHEN
+        router->onAdded(Akonadi::Item::List() << createItem(1, "a")
+                                              << createItem(2, QString()));
+
+        // THEN
+        QCOMPARE(aIds, QList<Akonadi::Item::Id>() << 1 << 2);
+        QCOMPARE(bIds, QList<Akonadi::Item::Id>() << 2);
+    }
+
+    void shouldRouteLaterNotificationsOfItemsWithUnknownKeysToAllKeyedQueries()
+    {
+        // GIVEN
+        auto router = ItemRouter::Ptr::create([] (const Akonadi::Item &item, QStringList &keys) {
+            if (item.gid() == QStringLiteral("unknown"))
+                return false;
+
+            keys << item.remoteId();
+            return true;
+        });
+
+        QList<Akonadi::Item::Id> aIds, bIds;
+        auto aQuery = createQuery("a", Akonadi::Item::List(), router, &aIds);
+        auto bQuery = createQuery("b", Akonadi::Item::List(), router, &bIds);
+
+        auto aResult = aQuery->result();
+        auto bResult = bQuery->result();
+
+        auto item1 = createItem(1, "a");
+        item1.setGid(QStringLiteral("unknown"));
+        auto item2 = createItem(2, "a");
+        item2.setGid(QStringLiteral("unknown"));
+        router->onAdded(Akonadi::Item::List() << item1 << item2);
+        QCOMPARE(aResult->data(), QList<QString>() << "1" << "2");
+        aIds.clear();
+        bIds.clear();
+
+        // WHEN
+        router->onChanged(Akonadi::Item::List() << createItem(1, "b"));
+
+        // THEN
+        QCOMPARE(aIds, QList<Akonadi::Item::Id>() << 1);
+        QCOMPARE(bIds, QList<Akonadi::Item::Id>() << 1);
+        QCOMPARE(aResult->data(), QList<QString>() << "2");
+        QCOMPARE(bResult->data(), QList<QString>() << "1");
+
+        // WHEN
+        router->onRemoved(Akonadi::Item::List() << createItem(2, QString()));
+
+        // THEN
+        QVERIFY(aResult->data().isEmpty());
+        QCOMPARE(bResult->data(), QList<QString>() << "1");
+    }
+
+    void shouldNotRouteToRemovedQueries()
+    {
+        // GIVEN
+        auto router = ItemRouter::Ptr::create([] (const Akonadi::Item &item, QStringList &keys) {
+            keys << item.remoteId();
+            return true;
+        });
+
+        QList<Akonadi::Item::Id> globalIds, aIds;
+        auto globalQuery = createQuery(QString(), Akonadi::Item::List(), router, &globalIds);
+        auto aQuery = createQuery("a", Akonadi::Item::List(), router, &aIds);
+
+        auto globalResult = globalQuery->result();
+        auto aResult = aQuery->result();
+
+        // WHEN
+        router->removeQuery(globalQuery);
+        router->removeQuery(aQuery);
+        router->onAdded(Akonadi::Item::List() << createItem(1, "a"));
+
+        // THEN
+        QVERIFY(globalIds.isEmpty());
+        QVERIFY(aIds.isEmpty());
+    }
+};
+
+QTEST_MAIN(AkonadiQueryRouterTest)
+
+#include "akonadiqueryroutertest.moc"
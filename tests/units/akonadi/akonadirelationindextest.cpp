@@ -0,0 +1,304 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "utils/mockobject.h"
+
+#include "testlib/akonadifakejobs.h"
+#include "testlib/akonadifakemonitor.h"
+
+#include "akonadi/akonadirelationindex.h"
+#include "akonadi/akonadiserializerinterface.h"
+#include "akonadi/akonadistorageinterface.h"
+
+using namespace mockitopp;
+
+class AkonadiRelationIndexTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void shouldPopulateCollectionOnlyOnce()
+    {
+        // GIVEN
+
+        // One collection with a task and two children
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Item item1(42);
+        item1.setParentCollection(col);
+        Akonadi::Item item2(43);
+        item2.setParentCollection(col);
+        Akonadi::Item item3(44);
+        item3.setParentCollection(col);
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1 << item2 << item3);
+
+        // Storage mock returning the fetch job
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
+                                                           .thenReturn(itemFetchJob);
+
+        // Serializer mock returning the uids of the items and of their parents
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
+        Akonadi::RelationIndex index(storageMock.getInstance(),
+                                     serializerMock.getInstance(),
+                                     Testlib::AkonadiFakeMonitor::Ptr::create());
+
+        // WHEN
+        int callbackCount = 0;
+        index.populateCollection(col, [&callbackCount] (bool) { callbackCount++; });
+        index.populateCollection(col, [&callbackCount] (bool) { callbackCount++; });
+
+        // THEN
+        QVERIFY(!index.isCollectionPopulated(col.id()));
+        QCOMPARE(callbackCount, 0);
+        QTest::qWait(150);
+        QVERIFY(index.isCollectionPopulated(col.id()));
+        QCOMPARE(callbackCount, 2);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
+
+        QCOMPARE(index.item(item2.id()), item2);
+        QCOMPARE(index.itemIdForUid("1"), item1.id());
+        QCOMPARE(index.childItems("1"), Akonadi::Item::List() << item2 << item3);
+        QVERIFY(index.childItems("2").isEmpty());
+        QCOMPARE(index.parentUid(item2.id()), QString("1"));
+        QVERIFY(index.parentUid(item1.id()).isEmpty());
+        QCOMPARE(index.descendantItems(item1.id()), Akonadi::Item::List() << item2 << item3);
+        QVERIFY(index.descendantItems(item3.id()).isEmpty());
+
+        // WHEN
+        index.populateCollection(col, [&callbackCount] (bool) { callbackCount++; });
+
+        // THEN
+        QCOMPARE(callbackCount, 3);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
+    }
+
+    void shouldNotMarkCollectionAsPopulatedOnError()
+    {
+        // GIVEN
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Item item(42);
+        item.setParentCollection(col);
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item);
+        itemFetchJob->setExpectedError(KJob::KilledJobError);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
+                                                           .thenReturn(itemFetchJob);
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn("1");
+
+        Akonadi::RelationIndex index(storageMock.getInstance(),
+                                     serializerMock.getInstance(),
+                                     Testlib::AkonadiFakeMonitor::Ptr::create());
+
+        // WHEN
+        bool callbackCalled = false;
+        bool populated = true;
+        index.populateCollection(col, [&callbackCalled, &populated] (bool result) {
+            callbackCalled = true;
+            populated = result;
+        });
+        QTest::qWait(150);
+
+        // THEN
+        QVERIFY(callbackCalled);
+        QVERIFY(!populated);
+        QVERIFY(!index.isCollectionPopulated(col.id()));
+        QVERIFY(!index.item(item.id()).isValid());
+        QVERIFY(index.childItems("1").isEmpty());
+    }
+
+    void shouldApplyNotificationsReceivedWhilePopulating()
+    {
+        // GIVEN
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Item item(42);
+        item.setParentCollection(col);
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
+                                                           .thenReturn(itemFetchJob);
+
+        // The fetched copy predates the change
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn("1")
+                                                                                    .thenReturn("2");
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::RelationIndex index(storageMock.getInstance(),
+                                     serializerMock.getInstance(),
+                                     monitor);
+        index.populateCollection(col, [] (bool) {});
+
+        // WHEN
+        monitor->changeItem(item);
+        QTest::qWait(150);
+
+        // THEN
+        QVERIFY(index.isCollectionPopulated(col.id()));
+        QVERIFY(index.childItems("1").isEmpty());
+        QCOMPARE(index.childItems("2"), Akonadi::Item::List() << item);
+    }
+
+    void shouldNotGiveCurrentItemsWithPendingChanges()
+    {
+        // GIVEN
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Item item(42);
+        item.setParentCollection(col);
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
+                                                           .thenReturn(itemFetchJob);
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn(QString());
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::RelationIndex index(storageMock.getInstance(),
+                                     serializerMock.getInstance(),
+                                     monitor);
+        index.populateCollection(col, [] (bool) {});
+        QTest::qWait(150);
+        QCOMPARE(index.currentItem(item.id()), item);
+
+        // WHEN
+        monitor->setItemChangesPending(item.id(), true);
+
+        // THEN
+        QCOMPARE(index.item(item.id()), item);
+        QVERIFY(!index.currentItem(item.id()).isValid());
+
+        // WHEN
+        monitor->setItemChangesPending(item.id(), false);
+
+        // THEN
+        QCOMPARE(index.currentItem(item.id()), item);
+    }
+
+    void shouldFollowMonitorEvents()
+    {
+        // GIVEN
+
+        // One collection with two tasks
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Item item1(42);
+        item1.setParentCollection(col);
+        Akonadi::Item item2(43);
+        item2.setParentCollection(col);
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1 << item2);
+
+        // An item in another collection
+        Akonadi::Collection otherCol(43);
+        otherCol.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Item otherItem(44);
+        otherItem.setParentCollection(otherCol);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
+                                                           .thenReturn(itemFetchJob);
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn(QString());
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        Akonadi::RelationIndex index(storageMock.getInstance(),
+                                     serializerMock.getInstance(),
+                                     monitor);
+        index.populateCollection(col, [] (bool) {});
+        QTest::qWait(150);
+        QVERIFY(index.childItems("1").isEmpty());
+
+        // WHEN
+        Akonadi::Item item3(45);
+        item3.setParentCollection(col);
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1")
+                                                                                     .thenReturn("2");
+        monitor->addItem(item3);
+
+        // THEN
+        QCOMPARE(index.childItems("1"), Akonadi::Item::List() << item3);
+
+        // WHEN
+        monitor->changeItem(item3);
+
+        // THEN
+        QVERIFY(index.childItems("1").isEmpty());
+        QCOMPARE(index.childItems("2"), Akonadi::Item::List() << item3);
+        QCOMPARE(index.parentUid(item3.id()), QString("2"));
+
+        // WHEN
+        monitor->removeItem(item3);
+
+        // THEN
+        QVERIFY(index.childItems("2").isEmpty());
+        QVERIFY(!index.item(item3.id()).isValid());
+        QCOMPARE(index.itemIdForUid("3"), Akonadi::Item::Id(-1));
+
+        // WHEN
+        monitor->addItem(otherItem); // No serializer call expected, collection unknown
+
+        // THEN
+        QVERIFY(!index.item(otherItem.id()).isValid());
+
+        // WHEN
+        monitor->removeCollection(col);
+
+        // THEN
+        QVERIFY(!index.isCollectionPopulated(col.id()));
+        QVERIFY(!index.item(item1.id()).isValid());
+        QCOMPARE(index.itemIdForUid("1"), Akonadi::Item::Id(-1));
+    }
+};
+
+QTEST_MAIN(AkonadiRelationIndexTest)
+
+#include "akonadirelationindextest.moc"
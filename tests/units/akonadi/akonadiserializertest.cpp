@@ -1118,6 +1118,69 @@ private slots:
         QCOMPARE(uid, expectedUid);
     }
 
+    void shouldRetrieveUidFromItem_data()
+    {
+        QTest::addColumn<Akonadi::Item>("item");
+        QTest::addColumn<QString>("expectedUid");
+
+        Akonadi::Item item1;
+        KCalCore::Todo::Ptr todo1(new KCalCore::Todo);
+        todo1->setUid("1");
+        item1.setPayload<KCalCore::Todo::Ptr>(todo1);
+
+        Akonadi::Item item2;
+        KMime::Message::Ptr message1(new KMime::Message);
+        message1->subject(true)->fromUnicodeString("foo", "utf-8");
+        message1->mainBodyPart()->fromUnicodeString("bar");
+        item2.setMimeType(Akonadi::NoteUtils::noteMimeType());
+        item2.setPayload<KMime::Message::Ptr>(message1);
+
+        Akonadi::Item item3;
+
+        QTest::newRow("task") << item1 << "1";
+        QTest::newRow("note") << item2 << QString();
+        QTest::newRow("no payload") << item3 << QString();
+    }
+
+    void shouldRetrieveUidFromItem()
+    {
+        // GIVEN
+        QFETCH(Akonadi::Item, item);
+        QFETCH(QString, expectedUid);
+
+        // WHEN
+        Akonadi::Serializer serializer;
+        QString uid = serializer.itemUid(item);
+
+        // THEN
+        QCOMPARE(uid, expectedUid);
+    }
+
+    void shouldCloneItemPayload()
+    {
+        // GIVEN
+        Akonadi::Item item(42);
+        KCalCore::Todo::Ptr todo(new KCalCore::Todo);
+        todo->setSummary("summary");
+        todo->setRelatedTo("1");
+        item.setMimeType(KCalCore::Todo::todoMimeType());
+        item.setPayload<KCalCore::Todo::Ptr>(todo);
+
+        auto parent = Domain::Task::Ptr::create();
+        parent->setProperty("todoUid", "2");
+
+        // WHEN
+        Akonadi::Serializer serializer;
+        auto clone = serializer.cloneItem(item);
+        serializer.updateItemParent(clone, parent);
+
+        // THEN
+        QCOMPARE(clone.id(), item.id());
+        QCOMPARE(clone.payload<KCalCore::Todo::Ptr>()->summary(), QString("summary"));
+        QCOMPARE(clone.payload<KCalCore::Todo::Ptr>()->relatedTo(), QString("2"));
+        QCOMPARE(item.payload<KCalCore::Todo::Ptr>()->relatedTo(), QString("1"));
+    }
+
     void shouldCreateNoteFromItem_data()
     {
         QTest::addColumn<QString>("title");
@@ -1810,6 +1873,25 @@ private slots:
         Akonadi::Item::List items5;
         items5 << item << item2 << item3 << item4;
         QTest::newRow("list with filter in list") << item << items5 << 2;
+
+        Akonadi::Item item6(16);
+        KCalCore::Todo::Ptr todo6(new KCalCore::Todo);
+        todo6->setUid("1");
+        todo6->setRelatedTo("8");
+        item6.setPayload<KCalCore::Todo::Ptr>(todo6);
+        Akonadi::Item item7(17);
+        KCalCore::Todo::Ptr todo7(new KCalCore::Todo);
+        todo7->setUid("7");
+        todo7->setRelatedTo("1");
+        item7.setPayload<KCalCore::Todo::Ptr>(todo7);
+        Akonadi::Item item8(18);
+        KCalCore::Todo::Ptr todo8(new KCalCore::Todo);
+        todo8->setUid("8");
+        todo8->setRelatedTo("7");
+        item8.setPayload<KCalCore::Todo::Ptr>(todo8);
+        Akonadi::Item::List items6;
+        items6 << item6 << item7 << item8;
+        QTest::newRow("list with a cycle") << item6 << items6 << 2;
     }
 
     void shouldFilterChildrenItem()
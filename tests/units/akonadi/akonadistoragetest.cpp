@@ -73,6 +73,7 @@ public:
     {
         qRegisterMetaType<Akonadi::Collection>();
         qRegisterMetaType<Akonadi::Item>();
+        qRegisterMetaType<Akonadi::Item::List>();
         qRegisterMetaType<Akonadi::Tag>();
     }
 
@@ -218,6 +219,52 @@ private slots:
     }
 
 
+    void shouldListCollectionsFromTheTreeCache()
+    {
+        // GIVEN
+        Akonadi::Storage storage;
+        Akonadi::Storage cachedStorage(Akonadi::MonitorInterface::Ptr(new Akonadi::MonitorImpl));
+
+        auto collectionNames = [] (Akonadi::CollectionFetchJobInterface *job) {
+            QStringList names;
+            for (const auto &collection : job->collections())
+                names << collection.name();
+            names.sort();
+            return names;
+        };
+
+        auto job = storage.fetchCollections(Akonadi::Collection::root(),
+                                            Akonadi::Storage::Recursive,
+                                            Akonadi::Storage::Tasks);
+        AKVERIFYEXEC(job->kjob());
+        auto subJob = storage.fetchCollections(calendar1(),
+                                               Akonadi::Storage::Recursive,
+                                               Akonadi::Storage::Tasks);
+        AKVERIFYEXEC(subJob->kjob());
+
+        // WHEN
+        auto cachedJob1 = cachedStorage.fetchCollections(Akonadi::Collection::root(),
+                                                         Akonadi::Storage::Recursive,
+                                                         Akonadi::Storage::Tasks);
+        auto cachedJob2 = cachedStorage.fetchCollections(calendar1(),
+                                                         Akonadi::Storage::Recursive,
+                                                         Akonadi::Storage::Tasks);
+        AKVERIFYEXEC(cachedJob1->kjob());
+        AKVERIFYEXEC(cachedJob2->kjob());
+
+        // THEN
+        QCOMPARE(collectionNames(cachedJob1), collectionNames(job));
+        QCOMPARE(collectionNames(cachedJob2), collectionNames(subJob));
+        for (const auto &collection : cachedJob1->collections()) {
+            auto parent = collection.parentCollection();
+            while (parent != Akonadi::Collection::root()) {
+                QVERIFY(parent.isValid());
+                QVERIFY(!parent.displayName().isEmpty());
+                parent = parent.parentCollection();
+            }
+        }
+    }
+
     void shouldListFullItemsInACollection()
     {
         // GIVEN
@@ -261,6 +308,66 @@ private slots:
         QCOMPARE(itemRemoteIds, expectedRemoteIds);
     }
 
+    void shouldStreamItemsOfACollectionInBatches()
+    {
+        // GIVEN
+        Akonadi::Storage storage;
+        const QStringList expectedRemoteIds = { "{1d33862f-f274-4c67-ab6c-362d56521ff4}",
+                                                "{1d33862f-f274-4c67-ab6c-362d56521ff5}",
+                                                "{1d33862f-f274-4c67-ab6c-362d56521ff6}",
+                                                "{7824df00-2fd6-47a4-8319-52659dc82005}",
+                                                "{7824df00-2fd6-47a4-8319-52659dc82006}" };
+
+        // WHEN
+        QStringList itemRemoteIds;
+        auto job = storage.fetchItems(calendar2());
+        job->setItemsHandler([&itemRemoteIds] (const Akonadi::Item::List &items) {
+            for (const auto &item : items) {
+                itemRemoteIds << item.remoteId();
+                QVERIFY(item.loadedPayloadParts().contains(Akonadi::Item::FullPayload));
+            }
+        });
+        AKVERIFYEXEC(job->kjob());
+
+        // THEN
+        QVERIFY(job->items().isEmpty());
+        itemRemoteIds.sort();
+        QCOMPARE(itemRemoteIds, expectedRemoteIds);
+    }
+
+    void shouldServeItemsOfACollectionFromTheCache()
+    {
+        // GIVEN
+        Akonadi::Storage cachedStorage(Akonadi::MonitorInterface::Ptr(new Akonadi::MonitorImpl));
+        const QStringList expectedRemoteIds = { "{1d33862f-f274-4c67-ab6c-362d56521ff4}",
+                                                "{1d33862f-f274-4c67-ab6c-362d56521ff5}",
+                                                "{1d33862f-f274-4c67-ab6c-362d56521ff6}",
+                                                "{7824df00-2fd6-47a4-8319-52659dc82005}",
+                                                "{7824df00-2fd6-47a4-8319-52659dc82006}" };
+
+        auto itemRemoteIds = [] (Akonadi::ItemFetchJobInterface *job) {
+            QStringList remoteIds;
+            for (const auto &item : job->items()) {
+                remoteIds << item.remoteId();
+                if (!item.loadedPayloadParts().contains(Akonadi::Item::FullPayload))
+                    remoteIds << QStringLiteral("missing payload");
+            }
+            remoteIds.sort();
+            return remoteIds;
+        };
+
+        auto job = cachedStorage.fetchItems(calendar2());
+        AKVERIFYEXEC(job->kjob());
+        QCOMPARE(itemRemoteIds(job), expectedRemoteIds);
+
+        // WHEN
+        auto cachedJob = cachedStorage.fetchItems(calendar2());
+        AKVERIFYEXEC(cachedJob->kjob());
+
+        // THEN
+        QCOMPARE(itemRemoteIds(cachedJob), expectedRemoteIds);
+    }
+
 
     void shouldListTags()
     {
@@ -453,6 +560,36 @@ private slots:
         }
     }
 
+    void shouldNotifyItemsInBatches()
+    {
+        // GIVEN
+
+        // A spied monitor
+        Akonadi::MonitorImpl monitor;
+        QSignalSpy spy(&monitor, SIGNAL(itemsAdded(Akonadi::Item::List)));
+        MonitorSpy monitorSpy(&monitor);
+
+        // A todo as payload of an item...
+        KCalCore::Todo::Ptr todo(new KCalCore::Todo);
+        todo->setSummary("summary");
+        Akonadi::Item item;
+        item.setMimeType("application/x-vnd.akonadi.calendar.todo");
+        item.setPayload<KCalCore::Todo::Ptr>(todo);
+
+        // WHEN
+        auto job = new Akonadi::ItemCreateJob(item, calendar2());
+        AKVERIFYEXEC(job);
+        monitorSpy.waitForStableState();
+        QTRY_VERIFY(!spy.isEmpty());
+
+        // THEN
+        QCOMPARE(spy.size(), 1);
+        auto notifiedItems = spy.takeFirst().takeFirst().value<Akonadi::Item::List>();
+        QCOMPARE(notifiedItems.size(), 1);
+        QCOMPARE(notifiedItems.first().id(), job->item().id());
+        QCOMPARE(notifiedItems.first().payload<KCalCore::Todo::Ptr>()->summary(), todo->summary());
+    }
+
     void shouldNotifyItemRemoved()
     {
         // GIVEN
@@ -1350,6 +1487,33 @@ private slots:
         }
     }
 
+    void shouldFindCollectionsByNameFromTheTreeCache()
+    {
+        // GIVEN
+        Akonadi::Storage storage;
+        Akonadi::Storage cachedStorage(Akonadi::MonitorInterface::Ptr(new Akonadi::MonitorImpl));
+
+        auto collectionNames = [] (Akonadi::CollectionSearchJobInterface *job) {
+            QStringList names;
+            for (const auto &collection : job->collections())
+                names << collection.name();
+            names.sort();
+            return names;
+        };
+
+        foreach (const QString &name, QStringList() << "Calendar" << "calendar2" << "toto" << "Ca") {
+            auto job = storage.searchCollections(name);
+            AKVERIFYEXEC(job->kjob());
+
+            // WHEN
+            auto cachedJob = cachedStorage.searchCollections(name);
+            AKVERIFYEXEC(cachedJob->kjob());
+
+            // THEN
+            QCOMPARE(collectionNames(cachedJob), collectionNames(job));
+        }
+    }
+
 private:
     Akonadi::Item fetchItemByRID(const QString &remoteId, const Akonadi::Collection &collection)
     {
@@ -0,0 +1,308 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "utils/mockobject.h"
+
+#include "testlib/akonadifakejobs.h"
+#include "testlib/akonadifakemonitor.h"
+
+#include "akonadi/akonadirelationindex.h"
+#include "akonadi/akonadiserializerinterface.h"
+#include "akonadi/akonadistorageinterface.h"
+#include "akonadi/akonaditagindex.h"
+
+using namespace mockitopp;
+
+class AkonadiTagIndexTest : public QObject
+{
+    Q_OBJECT
+private:
+    Akonadi::Tag createTag(Akonadi::Tag::Id id, const QByteArray &type)
+    {
+        Akonadi::Tag tag(QString::number(id));
+        tag.setId(id);
+        tag.setType(type);
+        return tag;
+    }
+
+private slots:
+    void shouldPopulateOnlyOnce()
+    {
+        // GIVEN
+
+        // One context and one plain tag
+        auto context = createTag(42, Akonadi::SerializerInterface::contextTagType());
+        auto plainTag = createTag(43, Akonadi::Tag::PLAIN);
+
+        // Two collections with tagged and untagged items
+        Akonadi::Collection col1(42);
+        col1.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Collection col2(43);
+        col2.setParentCollection(Akonadi::Collection::root());
+        auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col1 << col2);
+
+        Akonadi::Item item1(42);
+        item1.setParentCollection(col1);
+        item1.setTags(Akonadi::Tag::List() << context);
+        Akonadi::Item item2(43);
+        item2.setParentCollection(col1);
+        Akonadi::Item item3(44);
+        item3.setParentCollection(col2);
+        item3.setTags(Akonadi::Tag::List() << context << plainTag);
+        auto itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob1->setItems(Akonadi::Item::List() << item1 << item2);
+        auto itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob2->setItems(Akonadi::Item::List() << item3);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                 .thenReturn(collectionFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).thenReturn(itemFetchJob1);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).thenReturn(itemFetchJob2);
+
+        // Serializer mock for the relation index, the items have no relations
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        foreach (const Akonadi::Item &item, Akonadi::Item::List() << item1 << item2 << item3) {
+            serializerMock(&Akonadi::SerializerInterface::itemUid).when(item).thenReturn(QString());
+            serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn(QString());
+        }
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        Akonadi::TagIndex index(storageMock.getInstance(), relationIndex, monitor);
+
+        // WHEN
+        int callbackCount = 0;
+        index.populate([&callbackCount] (bool populated) { if (populated) callbackCount++; });
+        index.populate([&callbackCount] (bool populated) { if (populated) callbackCount++; });
+
+        // THEN
+        QVERIFY(!index.isPopulated());
+        QCOMPARE(callbackCount, 0);
+        QTest::qWait(300);
+        QVERIFY(index.isPopulated());
+        QCOMPARE(callbackCount, 2);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                               Akonadi::StorageInterface::Recursive,
+                                                                               Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                         .exactly(1));
+
+        QCOMPARE(index.taggedItems(context.id()), Akonadi::Item::List() << item1 << item3);
+        QCOMPARE(index.taggedItems(plainTag.id()), Akonadi::Item::List() << item3);
+        QVERIFY(index.hasContextTags(item1));
+        QVERIFY(!index.hasPlainTags(item1));
+        QVERIFY(!index.hasContextTags(item2));
+        QVERIFY(!index.hasPlainTags(item2));
+        QVERIFY(index.hasContextTags(item3));
+        QVERIFY(index.hasPlainTags(item3));
+
+        // WHEN
+        index.populate([&callbackCount] (bool populated) { if (populated) callbackCount++; });
+
+        // THEN
+        QCOMPARE(callbackCount, 3);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(1));
+    }
+
+    void shouldReuseTheCollectionsOfTheRelationIndex()
+    {
+        // GIVEN
+
+        // One context
+        auto context = createTag(42, Akonadi::SerializerInterface::contextTagType());
+
+        // One collection with a tagged item
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col);
+
+        Akonadi::Item item(42);
+        item.setParentCollection(col);
+        item.setTags(Akonadi::Tag::List() << context);
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                 .thenReturn(collectionFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col).thenReturn(itemFetchJob);
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn(QString());
+
+        // The relation index already went through the collection
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        relationIndex->populateCollection(col, [] (bool) {});
+        QTest::qWait(150);
+        QVERIFY(relationIndex->isCollectionPopulated(col.id()));
+
+        Akonadi::TagIndex index(storageMock.getInstance(), relationIndex, monitor);
+
+        // WHEN
+        QList<bool> calls;
+        index.populate([&calls] (bool populated) { calls << populated; });
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(calls, QList<bool>() << true);
+        QCOMPARE(index.taggedItems(context.id()), Akonadi::Item::List() << item);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
+    }
+
+    void shouldReportFailuresToPopulate()
+    {
+        // GIVEN
+        auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setExpectedError(KJob::KilledJobError);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                 .thenReturn(collectionFetchJob);
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        Akonadi::TagIndex index(storageMock.getInstance(), relationIndex, monitor);
+
+        // WHEN
+        QList<bool> calls;
+        index.populate([&calls] (bool populated) { calls << populated; });
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(calls, QList<bool>() << false);
+        QVERIFY(!index.isPopulated());
+    }
+
+    void shouldFollowMonitorEvents()
+    {
+        // GIVEN
+        auto context = createTag(42, Akonadi::SerializerInterface::contextTagType());
+        auto plainTag = createTag(43, Akonadi::Tag::PLAIN);
+
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Item item(42);
+        item.setParentCollection(col);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        Akonadi::TagIndex index(storageMock.getInstance(), relationIndex, monitor);
+
+        // WHEN
+        monitor->addTag(context);
+        monitor->addTag(plainTag);
+        monitor->addItem(item);
+
+        // THEN
+        QVERIFY(index.taggedItems(context.id()).isEmpty());
+        QVERIFY(!index.hasContextTags(item));
+
+        // WHEN
+        item.setTags(Akonadi::Tag::List() << context);
+        monitor->changeItemsTags(Akonadi::Item::List() << item,
+                                 QSet<Akonadi::Tag>() << context,
+                                 QSet<Akonadi::Tag>());
+
+        // THEN
+        QCOMPARE(index.taggedItems(context.id()), Akonadi::Item::List() << item);
+        QVERIFY(index.hasContextTags(item));
+        QVERIFY(!index.hasPlainTags(item));
+
+        // WHEN
+        item.setTags(Akonadi::Tag::List() << plainTag);
+        monitor->changeItem(item);
+
+        // THEN
+        QVERIFY(index.taggedItems(context.id()).isEmpty());
+        QCOMPARE(index.taggedItems(plainTag.id()), Akonadi::Item::List() << item);
+        QVERIFY(!index.hasContextTags(item));
+        QVERIFY(index.hasPlainTags(item));
+
+        // WHEN
+        context.setType(Akonadi::Tag::PLAIN);
+        monitor->changeTag(context);
+        item.setTags(Akonadi::Tag::List() << plainTag << context);
+        monitor->changeItemsTags(Akonadi::Item::List() << item,
+                                 QSet<Akonadi::Tag>() << context,
+                                 QSet<Akonadi::Tag>());
+
+        // THEN
+        QCOMPARE(index.taggedItems(context.id()), Akonadi::Item::List() << item);
+        QVERIFY(!index.hasContextTags(item));
+
+        // WHEN
+        monitor->removeTag(plainTag);
+
+        // THEN
+        QVERIFY(index.taggedItems(plainTag.id()).isEmpty());
+        QCOMPARE(index.taggedItems(context.id()), Akonadi::Item::List() << item);
+        QCOMPARE(index.taggedItems(context.id()).first().tags(), Akonadi::Tag::List() << context);
+        QVERIFY(index.hasPlainTags(item));
+
+        // WHEN
+        item.setTags(Akonadi::Tag::List());
+        monitor->changeItemsTags(Akonadi::Item::List() << item,
+                                 QSet<Akonadi::Tag>(),
+                                 QSet<Akonadi::Tag>() << context);
+
+        // THEN
+        QVERIFY(index.taggedItems(context.id()).isEmpty());
+        QVERIFY(!index.hasPlainTags(item));
+
+        // WHEN
+        item.setTags(Akonadi::Tag::List() << context);
+        monitor->changeItem(item);
+        monitor->removeCollection(col);
+
+        // THEN
+        QVERIFY(index.taggedItems(context.id()).isEmpty());
+    }
+};
+
+QTEST_MAIN(AkonadiTagIndexTest)
+
+#include "akonaditagindextest.moc"
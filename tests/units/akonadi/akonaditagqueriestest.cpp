@@ -261,7 +261,79 @@ private slots:
         QCOMPARE(result->data().at(1)->name(), tag2->name());
     }
 
-    void shouldLookInAllCollectionsForTagTopLevelArtifacts()
+    void shouldLookInTagItemsForTagTopLevelArtifacts()
+    {
+        // GIVEN
+
+        // One domain Tag and it's corresponding akonadiTag
+        auto tag = Domain::Tag::Ptr::create();
+        Akonadi::Tag akonadiTag(42);
+
+        // Two collections
+        Akonadi::Collection col1(42);
+        col1.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Collection col2(43);
+        col2.setParentCollection(Akonadi::Collection::root());
+
+        // One task in the first collection and one note in the second
+        // collection are tagged, the server gives us only them
+        Akonadi::Item item1(43);
+        item1.setParentCollection(col1);
+        auto task1 = Domain::Task::Ptr::create();
+        Akonadi::Item item3(45);
+        item3.setParentCollection(col2);
+        auto note3 = Domain::Note::Ptr::create();
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1 << item3);
+
+        // Storage mock returning the fetch jobs
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag)
+                                                              .thenReturn(itemFetchJob);
+
+        // Serializer mock returning the objects from the items
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item3).thenReturn(false);
+        serializerMock(&Akonadi::SerializerInterface::isNoteItem).when(item3).thenReturn(true);
+
+        serializerMock(&Akonadi::SerializerInterface::createAkonadiTagFromTag).when(tag).thenReturn(akonadiTag);
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
+        serializerMock(&Akonadi::SerializerInterface::createNoteFromItem).when(item3).thenReturn(note3);
+
+        // Serializer mock returning if tag is hold by the items
+        serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, item1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, item3).thenReturn(true);
+
+        // WHEN
+        QScopedPointer<Domain::TagQueries> queries(new Akonadi::TagQueries(storageMock.getInstance(),
+                                                                           serializerMock.getInstance(),
+                                                                           Testlib::AkonadiFakeMonitor::Ptr::create()));
+
+        Domain::QueryResult<Domain::Artifact::Ptr>::Ptr result = queries->findTopLevelArtifacts(tag);
+        result->data();
+        result = queries->findTopLevelArtifacts(tag); // Should not cause any problem or wrong data
+
+        // THEN
+        QVERIFY(result->data().isEmpty());
+        QTest::qWait(150);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(1));
+
+        QCOMPARE(result->data().size(), 2);
+        QCOMPARE(result->data().at(0).objectCast<Domain::Task>(), task1);
+        QCOMPARE(result->data().at(1).objectCast<Domain::Note>(), note3);
+
+        // Should not change nothing
+        result = queries->findTopLevelArtifacts(tag);
+
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(1));
+
+        QCOMPARE(result->data().size(), 2);
+        QCOMPARE(result->data().at(0).objectCast<Domain::Task>(), task1);
+        QCOMPARE(result->data().at(1).objectCast<Domain::Note>(), note3);
+    }
+
+    void shouldLookInAllCollectionsForTagTopLevelArtifactsIfServerCantAnswer()
     {
         // GIVEN
 
@@ -277,6 +349,10 @@ private slots:
         auto tag = Domain::Tag::Ptr::create();
         Akonadi::Tag akonadiTag(42);
 
+        // The tag items fetch fails
+        auto tagItemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        tagItemFetchJob->setExpectedError(KJob::KilledJobError);
+
         //two tasks in the first collection
         Akonadi::Item item1(43);
         item1.setParentCollection(col1);
@@ -299,6 +375,8 @@ private slots:
 
         // Storage mock returning the fetch jobs
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag)
+                                                              .thenReturn(tagItemFetchJob);
         storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
                                                                        Akonadi::StorageInterface::Recursive,
                                                                        Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
@@ -320,8 +398,6 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::createAkonadiTagFromTag).when(tag).thenReturn(akonadiTag);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
-        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item3).thenReturn(Domain::Task::Ptr());
-        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item4).thenReturn(Domain::Task::Ptr());
         serializerMock(&Akonadi::SerializerInterface::createNoteFromItem).when(item3).thenReturn(note3);
         serializerMock(&Akonadi::SerializerInterface::createNoteFromItem).when(item4).thenReturn(note4);
 
@@ -337,39 +413,159 @@ private slots:
                                                                            Testlib::AkonadiFakeMonitor::Ptr::create()));
 
         Domain::QueryResult<Domain::Artifact::Ptr>::Ptr result = queries->findTopLevelArtifacts(tag);
-        result->data();
-        result = queries->findTopLevelArtifacts(tag); // Should not cause any problem or wrong data
 
         // THEN
         QVERIFY(result->data().isEmpty());
-        QTest::qWait(150);
+        QTest::qWait(300);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(1));
         QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
         QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(1));
 
         QCOMPARE(result->data().size(), 2);
         QCOMPARE(result->data().at(0).objectCast<Domain::Task>(), task1);
         QCOMPARE(result->data().at(1).objectCast<Domain::Note>(), note3);
+    }
 
-        // Should not change nothing
-        result = queries->findTopLevelArtifacts(tag);
+    void shouldLookInTagIndexForTagTopLevelArtifacts()
+    {
+        // GIVEN
 
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(1));
+        // One domain Tag and it's corresponding akonadiTag
+        auto tag = Domain::Tag::Ptr::create();
+        Akonadi::Tag akonadiTag(42);
+        akonadiTag.setType(Akonadi::Tag::PLAIN);
+
+        // One collection with a tagged task, a tagged note and an untagged task
+        Akonadi::Collection col(42);
+        col.setParentCollection(Akonadi::Collection::root());
+        auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col);
+
+        Akonadi::Item item1(43);
+        item1.setParentCollection(col);
+        item1.setTags(Akonadi::Tag::List() << akonadiTag);
+        auto task1 = Domain::Task::Ptr::create();
+        Akonadi::Item item2(44);
+        item2.setParentCollection(col);
+        Akonadi::Item item3(45);
+        item3.setParentCollection(col);
+        item3.setTags(Akonadi::Tag::List() << akonadiTag);
+        auto note3 = Domain::Note::Ptr::create();
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1 << item2 << item3);
+
+        // Storage mock only returning the jobs to populate the index
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                 .thenReturn(collectionFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col).thenReturn(itemFetchJob);
+
+        // Serializer mock returning the objects from the items
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item3).thenReturn(false);
+        serializerMock(&Akonadi::SerializerInterface::isNoteItem).when(item3).thenReturn(true);
+
+        serializerMock(&Akonadi::SerializerInterface::createAkonadiTagFromTag).when(tag).thenReturn(akonadiTag);
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
+        serializerMock(&Akonadi::SerializerInterface::createNoteFromItem).when(item3).thenReturn(note3);
+
+        serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, item1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, item3).thenReturn(true);
+
+        // The relation index populating the tag index, the items have no relations
+        foreach (const Akonadi::Item &item, Akonadi::Item::List() << item1 << item2 << item3) {
+            serializerMock(&Akonadi::SerializerInterface::itemUid).when(item).thenReturn(QString());
+            serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item).thenReturn(QString());
+        }
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        auto tagIndex = Akonadi::TagIndex::Ptr::create(storageMock.getInstance(), relationIndex, monitor);
+
+        // WHEN
+        QScopedPointer<Domain::TagQueries> queries(new Akonadi::TagQueries(storageMock.getInstance(),
+                                                                           serializerMock.getInstance(),
+                                                                           monitor,
+                                                                           tagIndex));
+        Domain::QueryResult<Domain::Artifact::Ptr>::Ptr result = queries->findTopLevelArtifacts(tag);
+
+        // THEN
+        QVERIFY(result->data().isEmpty());
+        QTest::qWait(300);
+        QVERIFY(tagIndex->isPopulated());
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(0));
 
         QCOMPARE(result->data().size(), 2);
         QCOMPARE(result->data().at(0).objectCast<Domain::Task>(), task1);
         QCOMPARE(result->data().at(1).objectCast<Domain::Note>(), note3);
     }
 
-    void shouldReactToItemAddedForTag()
+    void shouldAskTheServerForTagTopLevelArtifactsIfTagIndexFailsToPopulate()
     {
         // GIVEN
-        // One top level
-        Akonadi::Collection col1(42);
-        col1.setParentCollection(Akonadi::Collection::root());
+
+        // One domain Tag and it's corresponding akonadiTag
+        auto tag = Domain::Tag::Ptr::create();
+        Akonadi::Tag akonadiTag(42);
+
+        // The index can't list the collections
         auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob->setCollections(Akonadi::Collection::List() << col1);
+        collectionFetchJob->setExpectedError(KJob::KilledJobError);
+
+        // The server gives us the tagged task
+        Akonadi::Item item1(43);
+        item1.setParentCollection(Akonadi::Collection(42));
+        auto task1 = Domain::Task::Ptr::create();
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1);
+
+        // Storage mock returning the fetch jobs
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
+                                                                 .thenReturn(collectionFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag)
+                                                              .thenReturn(itemFetchJob);
+
+        // Serializer mock returning the objects from the items
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::createAkonadiTagFromTag).when(tag).thenReturn(akonadiTag);
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
+        serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, item1).thenReturn(true);
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        auto relationIndex = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                                 serializerMock.getInstance(),
+                                                                 monitor);
+        auto tagIndex = Akonadi::TagIndex::Ptr::create(storageMock.getInstance(), relationIndex, monitor);
+
+        // WHEN
+        QScopedPointer<Domain::TagQueries> queries(new Akonadi::TagQueries(storageMock.getInstance(),
+                                                                           serializerMock.getInstance(),
+                                                                           monitor,
+                                                                           tagIndex));
+        Domain::QueryResult<Domain::Artifact::Ptr>::Ptr result = queries->findTopLevelArtifacts(tag);
+
+        // THEN
+        QVERIFY(result->data().isEmpty());
+        QTest::qWait(300);
+        QVERIFY(!tagIndex->isPopulated());
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(1));
+
+        QCOMPARE(result->data().size(), 1);
+        QCOMPARE(result->data().at(0).objectCast<Domain::Task>(), task1);
+    }
 
+    void shouldReactToItemAddedForTag()
+    {
+        // GIVEN
         // One domain Tag
         Akonadi::Tag akonadiTag(43);
         auto tag = Domain::Tag::Ptr::create();
@@ -379,12 +575,8 @@ private slots:
         // Storage mock returning the fetch job
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
 
-        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
-                                                                       Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
-                                                                 .thenReturn(collectionFetchJob);
-        storageMock(&Akonadi::StorageInterface::fetchItems).when(col1)
-                                                           .thenReturn(itemFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag)
+                                                              .thenReturn(itemFetchJob);
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
@@ -403,6 +595,7 @@ private slots:
 
         // WHEN
         Akonadi::Item item1(44);
+        item1.setTag(akonadiTag);
         auto task1 = Domain::Task::Ptr::create();
 
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
@@ -413,7 +606,7 @@ private slots:
         monitor->addItem(item1);
 
         // THEN
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(1));
         QVERIFY(serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).exactly(1));
 
         QCOMPARE(result->data().size(), 1);
@@ -431,8 +624,6 @@ private slots:
         // One top level collection with the task
         Akonadi::Collection col(42);
         col.setParentCollection(Akonadi::Collection::root());
-        auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob->setCollections(Akonadi::Collection::List() << col);
 
         // A task related to the tag
         Akonadi::Item item1(44);
@@ -443,13 +634,8 @@ private slots:
 
         // Storage mock returning the fetch job
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
-        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
-                                                                       Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
-                                                                 .thenReturn(collectionFetchJob);
-
-        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
-                                                           .thenReturn(itemFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag)
+                                                              .thenReturn(itemFetchJob);
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
@@ -484,11 +670,7 @@ private slots:
         // THEN
         QVERIFY(serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, item1).exactly(2));
 
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
-                                                                               Akonadi::StorageInterface::Recursive,
-                                                                               Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
-                                                                         .exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(1));
         QCOMPARE(result->data().size(), 1);
         QCOMPARE(result->data().at(0).objectCast<Domain::Task>(), task1.objectCast<Domain::Task>());
 
@@ -506,8 +688,6 @@ private slots:
         // One top level collection with the task
         Akonadi::Collection col(42);
         col.setParentCollection(Akonadi::Collection::root());
-        auto collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
-        collectionFetchJob->setCollections(Akonadi::Collection::List() << col);
 
         // Two tasks related to the tag
         Akonadi::Item itemTask1(44);
@@ -528,13 +708,8 @@ private slots:
 
         // Storage mock returning the fetch job
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
-        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
-                                                                       Akonadi::StorageInterface::Recursive,
-                                                                       Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
-                                                                 .thenReturn(collectionFetchJob);
-
-        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
-                                                           .thenReturn(itemFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag)
+                                                              .thenReturn(itemFetchJob);
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
@@ -593,11 +768,7 @@ private slots:
         QVERIFY(serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, itemTask2).exactly(1));
         QVERIFY(serializerMock(&Akonadi::SerializerInterface::isTagChild).when(tag, itemNote).exactly(1));
 
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
-                                                                               Akonadi::StorageInterface::Recursive,
-                                                                               Akonadi::StorageInterface::Tasks | Akonadi::StorageInterface::Notes)
-                                                                         .exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchTagItems).when(akonadiTag).exactly(1));
         QCOMPARE(result->data().size(), 2);
         QCOMPARE(result->data().at(0).objectCast<Domain::Task>(), task1.objectCast<Domain::Task>());
         QCOMPARE(result->data().at(1).objectCast<Domain::Note>(), note.objectCast<Domain::Note>());
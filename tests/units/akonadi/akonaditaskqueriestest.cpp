@@ -84,6 +84,8 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item3).thenReturn(true);
@@ -151,6 +153,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item2).thenReturn(false);
 
@@ -268,6 +271,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item3).thenReturn(true);
@@ -342,6 +346,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item3).thenReturn(true);
@@ -397,6 +402,89 @@ private slots:
         QVERIFY(replaceHandlerCalled);
     }
 
+    void shouldOnlyLookInSelectedCollectionsForAllTasks()
+    {
+        // GIVEN
+
+        // Two top level collections
+        Akonadi::Collection col1(42);
+        col1.setParentCollection(Akonadi::Collection::root());
+        Akonadi::Collection col2(43);
+        col2.setParentCollection(Akonadi::Collection::root());
+        Testlib::AkonadiFakeCollectionFetchJob *collectionFetchJob = new Testlib::AkonadiFakeCollectionFetchJob(this);
+        collectionFetchJob->setCollections(Akonadi::Collection::List() << col1 << col2);
+
+        // One task in each collection
+        Akonadi::Item item1(42);
+        item1.setParentCollection(col1);
+        Domain::Task::Ptr task1(new Domain::Task);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob1->setItems(Akonadi::Item::List() << item1);
+
+        Akonadi::Item item2(43);
+        item2.setParentCollection(col2);
+        Domain::Task::Ptr task2(new Domain::Task);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob2->setItems(Akonadi::Item::List() << item2);
+
+        // Storage mock returning the fetch jobs
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                       Akonadi::StorageInterface::Recursive,
+                                                                       Akonadi::StorageInterface::Tasks)
+                                                                 .thenReturn(collectionFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col1)
+                                                           .thenReturn(itemFetchJob1);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col2)
+                                                           .thenReturn(itemFetchJob2);
+
+        // Serializer mock returning the tasks from the items, only the first collection is selected
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col2).thenReturn(false)
+                                                                                      .thenReturn(true);
+
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item2).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
+        serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
+        serializerMock(&Akonadi::SerializerInterface::representsItem).when(task1, item2).thenReturn(false);
+
+        // Monitor mock
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+
+        QScopedPointer<Domain::TaskQueries> queries(new Akonadi::TaskQueries(storageMock.getInstance(),
+                                                                             serializerMock.getInstance(),
+                                                                             monitor));
+        Domain::QueryResult<Domain::Task::Ptr>::Ptr result = queries->findAll();
+        QTest::qWait(150);
+        QCOMPARE(result->data().size(), 1);
+        QCOMPARE(result->data().first(), task1);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(0));
+
+        // WHEN
+        monitor->addItem(item2);
+
+        // THEN
+        QCOMPARE(result->data().size(), 1);
+        QCOMPARE(result->data().first(), task1);
+
+        // WHEN
+        monitor->changeCollectionSelection(col2);
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(result->data().size(), 2);
+        QCOMPARE(result->data().first(), task1);
+        QCOMPARE(result->data().last(), task2);
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchCollections).when(Akonadi::Collection::root(),
+                                                                               Akonadi::StorageInterface::Recursive,
+                                                                               Akonadi::StorageInterface::Tasks)
+                                                                         .exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(1));
+    }
+
     void shouldLookInAllChildrenReportedForAllChildrenTask()
     {
         // GIVEN
@@ -438,6 +526,15 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // WHEN
         QScopedPointer<Domain::TaskQueries> queries(new Akonadi::TaskQueries(storageMock.getInstance(),
                                                                              serializerMock.getInstance(),
@@ -484,29 +581,26 @@ private slots:
         item1.setParentCollection(col);
         Domain::Task::Ptr task1(new Domain::Task);
 
-        // We'll make the same queries twice
-        Testlib::AkonadiFakeItemFetchJob *itemFetchJob11 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob11->setItems(Akonadi::Item::List() << item1);
-        Testlib::AkonadiFakeItemFetchJob *itemFetchJob21 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob21->setItems(Akonadi::Item::List() << item1);
-        Testlib::AkonadiFakeItemFetchJob *itemFetchJob12 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob12->setItems(Akonadi::Item::List() << item1);
-        Testlib::AkonadiFakeItemFetchJob *itemFetchJob22 = new Testlib::AkonadiFakeItemFetchJob(this);
-        itemFetchJob22->setItems(Akonadi::Item::List() << item1);
+        // We'll make the same queries twice, the second time is answered by the index
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob1->setItems(Akonadi::Item::List() << item1);
+        Testlib::AkonadiFakeItemFetchJob *itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob2->setItems(Akonadi::Item::List() << item1);
 
         // Storage mock returning the fetch jobs
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchItem).when(item1)
-                                                          .thenReturn(itemFetchJob11)
-                                                          .thenReturn(itemFetchJob12);
+                                                          .thenReturn(itemFetchJob1);
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
-                                                           .thenReturn(itemFetchJob21)
-                                                           .thenReturn(itemFetchJob22);
+                                                           .thenReturn(itemFetchJob2);
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
         serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task1).thenReturn(item1);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item1).thenReturn(false);
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
 
         QScopedPointer<Domain::TaskQueries> queries(new Akonadi::TaskQueries(storageMock.getInstance(),
                                                                              serializerMock.getInstance(),
@@ -528,6 +622,9 @@ private slots:
             QTest::qWait(150);
             QVERIFY(result->data().isEmpty());
         }
+
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItem).when(item1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
     }
 
     void shouldReactToItemAddsForChildrenTask()
@@ -560,6 +657,11 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item1).thenReturn(false);
         serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task1).thenReturn(item1);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -569,7 +671,8 @@ private slots:
         Domain::QueryResult<Domain::Task::Ptr>::Ptr result = queries->findChildren(task1);
         QTest::qWait(150);
         QVERIFY(result->data().isEmpty());
-        QVERIFY(serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item1).exactly(1));
+        // item1 isn't a child in the index, no need to check it
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item1).exactly(0));
 
         // WHEN
         Akonadi::Item item2(43);
@@ -585,6 +688,11 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item3).thenReturn(task3);
 
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         monitor->addItem(item2);
         monitor->addItem(item3);
 
@@ -642,6 +750,15 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -717,10 +834,19 @@ private slots:
         // Serializer mock returning if task1 is parent of items
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item1).thenReturn(false);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item2).thenReturn(true)
-                                                                                     .thenReturn(false)
                                                                                      .thenReturn(false);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1")
+                                                                                     .thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -786,10 +912,19 @@ private slots:
 
         // Serializer mock returning if task1 is parent of items
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item1).thenReturn(false);
-        serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item2).thenReturn(false)
-                                                                                     .thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn(QString())
+                                                                                     .thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -806,7 +941,6 @@ private slots:
         QCOMPARE(result->data().size(), 1);
 
         // WHEN
-        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
         monitor->changeItem(item2);
 
         // THEN
@@ -889,8 +1023,18 @@ private slots:
         // Serializer mock returning if task2 is parent of items
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task2, item1).thenReturn(false);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task2, item2).thenReturn(false);
-        serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task2, item3).thenReturn(false)
-                                                                                     .thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task2, item3).thenReturn(true);
+
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1")
+                                                                                     .thenReturn("2");
 
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
@@ -913,6 +1057,9 @@ private slots:
         QCOMPARE(result1->data().size(), 0);
         QCOMPARE(result2->data().size(), 1);
         QCOMPARE(result2->data().at(0), task3);
+
+        // Both queries shared the same collection fetch
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
     }
 
     void shouldReactToItemRemovesForChildrenTask()
@@ -960,6 +1107,15 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskChild).when(task1, item3).thenReturn(true);
 
+        // Serializer mock returning the uids of the items and of their parents
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item1).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("1");
+
         // Monitor mock
         auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
 
@@ -1026,6 +1182,8 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
 
@@ -1153,6 +1311,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
 
@@ -1229,6 +1388,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
         serializerMock(&Akonadi::SerializerInterface::updateTaskFromItem).when(task2, item2).thenReturn();
@@ -1316,6 +1476,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
 
@@ -1393,6 +1554,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
 
@@ -1478,6 +1640,7 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task2).thenReturn(item2);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
@@ -1492,6 +1655,12 @@ private slots:
         serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item2).thenReturn(QString());
         serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(item3).thenReturn("2");
 
+        // Serializer mock returning the uids of the items
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item1).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item2).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(item3).thenReturn("3");
+
         // Serializer mock returning if the item is a task
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item1).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::isTaskItem).when(item2).thenReturn(true);
@@ -1562,6 +1731,7 @@ private slots:
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
         serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task1).thenReturn(item1);
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
 
         // WHEN
         QScopedPointer<Domain::TaskQueries> queries(new Akonadi::TaskQueries(storageMock.getInstance(),
@@ -1635,12 +1805,16 @@ private slots:
         Utils::MockObject<Akonadi::StorageInterface> storageMock;
         storageMock(&Akonadi::StorageInterface::fetchItem).when(item1)
                                                            .thenReturn(itemFetchJob1);
+        // The collection gets fetched again when the index fails to populate it
+        const bool populateFails = itemFetchJob2->expectedError() != KJob::NoError;
         storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
-                                                           .thenReturn(itemFetchJob2);
+                                                           .thenReturn(itemFetchJob2)
+                                                           .thenReturn(new Testlib::AkonadiFakeItemFetchJob(this));
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
         serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task1).thenReturn(item1);
+        serializerMock(&Akonadi::SerializerInterface::objectUid).when(task1).thenReturn("1");
 
         // WHEN
         QScopedPointer<Domain::TaskQueries> queries(new Akonadi::TaskQueries(storageMock.getInstance(),
@@ -1654,7 +1828,7 @@ private slots:
         // THEN
         QVERIFY(result->data().isEmpty());
         QTest::qWait(150);
-        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(populateFails ? 2 : 1));
         QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItem).when(item1).exactly(1));
 
         QCOMPARE(result->data().size(), 0);
@@ -1743,6 +1917,7 @@ private slots:
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
 
         // WHEN
         QScopedPointer<Domain::TaskQueries> queries(new Akonadi::TaskQueries(storageMock.getInstance(),
@@ -1849,6 +2024,7 @@ private slots:
 
         // Serializer mock
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col).thenReturn(true);
 
         // WHEN
         QScopedPointer<Domain::TaskQueries> queries(new Akonadi::TaskQueries(storageMock.getInstance(),
@@ -1916,6 +2092,8 @@ private slots:
 
         // Serializer mock returning the tasks from the items
         Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col1).thenReturn(true);
+        serializerMock(&Akonadi::SerializerInterface::isSelectedCollection).when(col2).thenReturn(true);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item1).thenReturn(task1);
         serializerMock(&Akonadi::SerializerInterface::createTaskFromItem).when(item2).thenReturn(task2);
 
@@ -226,6 +226,53 @@ private slots:
         QVERIFY(storageMock(&Akonadi::StorageInterface::createItem).when(item, col2).exactly(1));
     }
 
+    void shouldKeepTheTargetCollectionUntilItChanges()
+    {
+        // GIVEN
+
+        // A default collection for saving
+        Akonadi::Collection col(42);
+
+        // A task and its corresponding item not existing in storage yet
+        Akonadi::Item item;
+        Domain::Task::Ptr task(new Domain::Task);
+
+        // Storage mock returning the create jobs
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::defaultTaskCollection).when().thenReturn(col);
+        storageMock(&Akonadi::StorageInterface::createItem).when(item, col)
+                                                           .thenReturn(new FakeJob(this))
+                                                           .thenReturn(new FakeJob(this))
+                                                           .thenReturn(new FakeJob(this));
+
+        // Serializer mock returning the item for the task
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task).thenReturn(item);
+
+        auto monitor = Testlib::AkonadiFakeMonitor::Ptr::create();
+        QScopedPointer<Akonadi::TaskRepository> repository(new Akonadi::TaskRepository(storageMock.getInstance(),
+                                                                                       serializerMock.getInstance(),
+                                                                                       Akonadi::MessagingInterface::Ptr(),
+                                                                                       Akonadi::RelationIndex::Ptr(),
+                                                                                       monitor));
+
+        // WHEN
+        repository->create(task)->exec();
+        repository->create(task)->exec();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::defaultTaskCollection).when().exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::createItem).when(item, col).exactly(2));
+
+        // WHEN
+        monitor->changeCollection(col);
+        repository->create(task)->exec();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::defaultTaskCollection).when().exactly(2));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::createItem).when(item, col).exactly(3));
+    }
+
     void shouldCreateNewItemsInProjectCollection()
     {
         // GIVEN
@@ -494,6 +541,59 @@ private slots:
         }
     }
 
+    void shouldRemoveSeveralTasksAtOnce()
+    {
+        // GIVEN
+        Akonadi::Collection col(40);
+
+        // Two selected tasks, the second one being a child of the first one
+        Domain::Task::Ptr task1(new Domain::Task);
+        Akonadi::Item item1(42);
+        item1.setParentCollection(col);
+        Domain::Task::Ptr task2(new Domain::Task);
+        Akonadi::Item item2(43);
+        item2.setParentCollection(col);
+
+        // And another child of the first task
+        Akonadi::Item item3(44);
+        item3.setParentCollection(col);
+
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << item1 << item2);
+        auto collectionItemsFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        const auto collectionItems = Akonadi::Item::List() << item1 << item2 << item3;
+        collectionItemsFetchJob->setItems(collectionItems);
+
+        const auto removedList = Akonadi::Item::List() << item2 << item3 << item1;
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItemList).when(Akonadi::Item::List() << item1 << item2)
+                                                              .thenReturn(itemFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col)
+                                                           .thenReturn(collectionItemsFetchJob);
+        storageMock(&Akonadi::StorageInterface::removeItems).when(removedList, Q_NULLPTR)
+                                                            .thenReturn(new FakeJob(this));
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task1).thenReturn(item1);
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(task2).thenReturn(item2);
+        serializerMock(&Akonadi::SerializerInterface::filterDescendantItems).when(collectionItems, item1)
+                                                                            .thenReturn(Akonadi::Item::List() << item2 << item3);
+        serializerMock(&Akonadi::SerializerInterface::filterDescendantItems).when(collectionItems, item2)
+                                                                            .thenReturn(Akonadi::Item::List());
+
+        // WHEN
+        QScopedPointer<Akonadi::TaskRepository> repository(new Akonadi::TaskRepository(storageMock.getInstance(),
+                                                                                       serializerMock.getInstance(),
+                                                                                       Akonadi::MessagingInterface::Ptr()));
+        repository->removeTasks(Domain::Task::List() << task1 << task2)->exec();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItemList).when(Akonadi::Item::List() << item1 << item2).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::removeItems).when(removedList, Q_NULLPTR).exactly(1));
+    }
+
     void shouldAssociateATaskToAnother_data()
     {
         QTest::addColumn<Akonadi::Item>("childItem");
@@ -529,11 +629,15 @@ private slots:
 
         itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
         itemFetchJob1->setExpectedError(KJob::KilledJobError);
+        itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob2->setItems(Akonadi::Item::List() << parentItem);
         QTest::newRow("child job error with empty list") << childItem << parentItem << child << parent << itemFetchJob1 << itemFetchJob2 << itemFetchJob3 << false << false << list;
 
         itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
         itemFetchJob1->setExpectedError(KJob::KilledJobError);
         itemFetchJob1->setItems(Akonadi::Item::List() << childItem);
+        itemFetchJob2 = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob2->setItems(Akonadi::Item::List() << parentItem);
         QTest::newRow("child job error with item") << childItem << parentItem << child << parent << itemFetchJob1 << itemFetchJob2 << itemFetchJob3 << false << false << list;
 
         itemFetchJob1 = new Testlib::AkonadiFakeItemFetchJob(this);
@@ -630,12 +734,13 @@ private slots:
 
 
         // THEN
+        // Both items are fetched right away, the parent doesn't wait for the child
         QVERIFY(serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child).exactly(1));
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(parent).exactly(1));
         QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItem).when(childItem).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItem).when(parentItem).exactly(1));
         if (execJob) {
             QVERIFY(serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem, parent).exactly(1));
-            QVERIFY(serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(parent).exactly(1));
-            QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItem).when(parentItem).exactly(1));
             if (execParentJob) {
                 if (parentItem.parentCollection().id() == childItem.parentCollection().id())
                     QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(childItem, Q_NULLPTR).exactly(1));
@@ -650,6 +755,247 @@ private slots:
         }
     }
 
+    void shouldAssociateSeveralTasksToAnotherInOneTransaction()
+    {
+        // GIVEN
+
+        // Two collections
+        Akonadi::Collection col1(1);
+        Akonadi::Collection col2(2);
+
+        // A parent and a child in the first collection
+        Domain::Task::Ptr parent(new Domain::Task);
+        Akonadi::Item parentItem(41);
+        parentItem.setParentCollection(col1);
+        Domain::Task::Ptr child1(new Domain::Task);
+        Akonadi::Item childItem1(42);
+        childItem1.setParentCollection(col1);
+
+        // Another child in the second collection, with its own child
+        Domain::Task::Ptr child2(new Domain::Task);
+        Akonadi::Item childItem2(43);
+        childItem2.setParentCollection(col2);
+        Akonadi::Item grandChildItem(44);
+        grandChildItem.setParentCollection(col2);
+
+        // Storage mock fetching everything at once
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << childItem1 << childItem2 << parentItem);
+        auto collectionItemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        collectionItemFetchJob->setItems(Akonadi::Item::List() << childItem2 << grandChildItem);
+        auto transactionJob = new FakeJob(this);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItemList).when(Akonadi::Item::List() << parentItem << childItem1 << childItem2)
+                                                              .thenReturn(itemFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col2)
+                                                           .thenReturn(collectionItemFetchJob);
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(childItem1, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+        storageMock(&Akonadi::StorageInterface::updateItem).when(childItem2, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+        storageMock(&Akonadi::StorageInterface::moveItems).when(Akonadi::Item::List() << childItem2 << grandChildItem, col1, transactionJob)
+                                                          .thenReturn(new FakeJob(this));
+
+        // Serializer mock
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(parent).thenReturn(parentItem);
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child1).thenReturn(childItem1);
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child2).thenReturn(childItem2);
+        serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem1, parent).thenReturn();
+        serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem2, parent).thenReturn();
+        serializerMock(&Akonadi::SerializerInterface::filterDescendantItems).when(Akonadi::Item::List() << childItem2 << grandChildItem, childItem2)
+                                                                            .thenReturn(Akonadi::Item::List() << grandChildItem);
+
+        // WHEN
+        QScopedPointer<Akonadi::TaskRepository> repository(new Akonadi::TaskRepository(storageMock.getInstance(),
+                                                                                       serializerMock.getInstance(),
+                                                                                       Akonadi::MessagingInterface::Ptr()));
+        repository->associateChildren(parent, Domain::Task::List() << child1 << child2)->exec();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItemList).when(Akonadi::Item::List() << parentItem << childItem1 << childItem2)
+                                                                      .exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(1));
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem1, parent).exactly(1));
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem2, parent).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::createTransaction).when().exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(childItem1, transactionJob).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(childItem2, transactionJob).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::moveItems).when(Akonadi::Item::List() << childItem2 << grandChildItem, col1, transactionJob)
+                                                                  .exactly(1));
+    }
+
+    void shouldReportFailingCollectionFetchWhenAssociatingSeveralTasks()
+    {
+        // GIVEN
+
+        // A parent in a first collection
+        Akonadi::Collection col1(1);
+        Akonadi::Collection col2(2);
+        Domain::Task::Ptr parent(new Domain::Task);
+        Akonadi::Item parentItem(41);
+        parentItem.setParentCollection(col1);
+
+        // Two children in a second collection
+        Domain::Task::Ptr child1(new Domain::Task);
+        Akonadi::Item childItem1(42);
+        childItem1.setParentCollection(col2);
+        Domain::Task::Ptr child2(new Domain::Task);
+        Akonadi::Item childItem2(43);
+        childItem2.setParentCollection(col2);
+
+        // Storage mock failing to fetch the second collection
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << parentItem << childItem1 << childItem2);
+        auto collectionItemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        collectionItemFetchJob->setExpectedError(KJob::KilledJobError, QStringLiteral("Foo"));
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItemList).when(Akonadi::Item::List() << parentItem << childItem1 << childItem2)
+                                                              .thenReturn(itemFetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col2)
+                                                           .thenReturn(collectionItemFetchJob);
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(parent).thenReturn(parentItem);
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child1).thenReturn(childItem1);
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child2).thenReturn(childItem2);
+        serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem1, parent).thenReturn();
+        serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem2, parent).thenReturn();
+
+        // WHEN
+        QScopedPointer<Akonadi::TaskRepository> repository(new Akonadi::TaskRepository(storageMock.getInstance(),
+                                                                                       serializerMock.getInstance(),
+                                                                                       Akonadi::MessagingInterface::Ptr()));
+        auto job = repository->associateChildren(parent, Domain::Task::List() << child1 << child2);
+        job->exec();
+
+        // THEN
+        QCOMPARE(job->error(), int(KJob::KilledJobError));
+        QCOMPARE(job->errorText(), QStringLiteral("Foo"));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::createTransaction).when().exactly(0));
+    }
+
+    void shouldNotMoveAssociatedTasksAlreadyInTheParentCollection()
+    {
+        // GIVEN
+        Akonadi::Collection col(1);
+
+        Domain::Task::Ptr parent(new Domain::Task);
+        Akonadi::Item parentItem(41);
+        parentItem.setParentCollection(col);
+        Domain::Task::Ptr child1(new Domain::Task);
+        Akonadi::Item childItem1(42);
+        childItem1.setParentCollection(col);
+        Domain::Task::Ptr child2(new Domain::Task);
+        Akonadi::Item childItem2(43);
+        childItem2.setParentCollection(col);
+
+        auto itemFetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        itemFetchJob->setItems(Akonadi::Item::List() << parentItem << childItem1 << childItem2);
+        auto transactionJob = new FakeJob(this);
+
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItemList).when(Akonadi::Item::List() << parentItem << childItem1 << childItem2)
+                                                              .thenReturn(itemFetchJob);
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(childItem1, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+        storageMock(&Akonadi::StorageInterface::updateItem).when(childItem2, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(parent).thenReturn(parentItem);
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child1).thenReturn(childItem1);
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child2).thenReturn(childItem2);
+        serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem1, parent).thenReturn();
+        serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem2, parent).thenReturn();
+
+        // WHEN
+        QScopedPointer<Akonadi::TaskRepository> repository(new Akonadi::TaskRepository(storageMock.getInstance(),
+                                                                                       serializerMock.getInstance(),
+                                                                                       Akonadi::MessagingInterface::Ptr()));
+        repository->associateChildren(parent, Domain::Task::List() << child1 << child2)->exec();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::createTransaction).when().exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(childItem1, transactionJob).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(childItem2, transactionJob).exactly(1));
+    }
+
+    void shouldAssociateFromIndexedItemsWithoutFetchingThem()
+    {
+        // GIVEN
+
+        // A parent in a first collection
+        Akonadi::Collection col1(1);
+        Domain::Task::Ptr parent(new Domain::Task);
+        Akonadi::Item parentItem(41);
+        parentItem.setParentCollection(col1);
+
+        // A child with its own child in a second collection
+        Akonadi::Collection col2(2);
+        Domain::Task::Ptr child(new Domain::Task);
+        Akonadi::Item childItem(42);
+        childItem.setParentCollection(col2);
+        Akonadi::Item grandChildItem(43);
+        grandChildItem.setParentCollection(col2);
+
+        auto col1FetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        col1FetchJob->setItems(Akonadi::Item::List() << parentItem);
+        auto col2FetchJob = new Testlib::AkonadiFakeItemFetchJob(this);
+        col2FetchJob->setItems(Akonadi::Item::List() << childItem << grandChildItem);
+        auto transactionJob = new FakeJob(this);
+
+        // Storage mock only populating the index, no fetchItem expected
+        Utils::MockObject<Akonadi::StorageInterface> storageMock;
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).thenReturn(col1FetchJob);
+        storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).thenReturn(col2FetchJob);
+        storageMock(&Akonadi::StorageInterface::createTransaction).when().thenReturn(transactionJob);
+        storageMock(&Akonadi::StorageInterface::updateItem).when(childItem, transactionJob)
+                                                           .thenReturn(new FakeJob(this));
+        storageMock(&Akonadi::StorageInterface::moveItems).when(Akonadi::Item::List() << childItem << grandChildItem, col1, transactionJob)
+                                                          .thenReturn(new FakeJob(this));
+
+        Utils::MockObject<Akonadi::SerializerInterface> serializerMock;
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(parentItem).thenReturn("1");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(childItem).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::itemUid).when(grandChildItem).thenReturn("3");
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(parentItem).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(childItem).thenReturn(QString());
+        serializerMock(&Akonadi::SerializerInterface::relatedUidFromItem).when(grandChildItem).thenReturn("2");
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(child).thenReturn(Akonadi::Item(42));
+        serializerMock(&Akonadi::SerializerInterface::createItemFromTask).when(parent).thenReturn(Akonadi::Item(41));
+        serializerMock(&Akonadi::SerializerInterface::cloneItem).when(childItem).thenReturn(childItem);
+        serializerMock(&Akonadi::SerializerInterface::cloneItem).when(parentItem).thenReturn(parentItem);
+        serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem, parent).thenReturn();
+
+        auto index = Akonadi::RelationIndex::Ptr::create(storageMock.getInstance(),
+                                                         serializerMock.getInstance(),
+                                                         Testlib::AkonadiFakeMonitor::Ptr::create());
+        index->populateCollection(col1, [] (bool) {});
+        index->populateCollection(col2, [] (bool) {});
+        QTest::qWait(150);
+
+        // WHEN
+        QScopedPointer<Akonadi::TaskRepository> repository(new Akonadi::TaskRepository(storageMock.getInstance(),
+                                                                                       serializerMock.getInstance(),
+                                                                                       Akonadi::MessagingInterface::Ptr(),
+                                                                                       index));
+        repository->associate(parent, child)->exec();
+
+        // THEN
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col1).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::fetchItems).when(col2).exactly(1));
+        QVERIFY(serializerMock(&Akonadi::SerializerInterface::updateItemParent).when(childItem, parent).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::updateItem).when(childItem, transactionJob).exactly(1));
+        QVERIFY(storageMock(&Akonadi::StorageInterface::moveItems).when(Akonadi::Item::List() << childItem << grandChildItem, col1, transactionJob)
+                                                                  .exactly(1));
+    }
+
     void shouldDissociateATaskFromItsParent_data()
     {
         QTest::addColumn<Domain::Task::Ptr>("child");
@@ -25,7 +25,10 @@
 
 #include "domain/livequery.h"
 
+#include "akonadi/akonadiqueryscheduler.h"
+
 #include "utils/jobhandler.h"
+#include "utils/timeslicer.h"
 
 #include "testlib/fakejob.h"
 
@@ -44,6 +47,12 @@ private:
     }
 
 private slots:
+    void initTestCase()
+    {
+        // Our fetches install jobs, they have to belong to the queries
+        Akonadi::QueryScheduler::install();
+    }
+
     void shouldHaveInitialFetchFunctionAndPredicate()
     {
         // GIVEN
@@ -285,6 +294,152 @@ private slots:
         QVERIFY(replaceHandlerCalled);
     }
 
+    void shouldReactToBatchedEvents()
+    {
+        // GIVEN
+        Domain::LiveQuery<QObject*, QPair<int, QString>> query;
+        query.setFetchFunction([this] (const Domain::LiveQuery<QObject*, QString>::AddFunction &add) {
+            Utils::JobHandler::install(new FakeJob, [this, add] {
+                add(createObject(0, "0A"));
+                add(createObject(1, "1A"));
+                add(createObject(2, "2A"));
+                add(createObject(3, "0B"));
+                add(createObject(4, "1B"));
+                add(createObject(5, "2B"));
+                add(createObject(6, "0C"));
+                add(createObject(7, "1C"));
+                add(createObject(8, "2C"));
+            });
+        });
+        query.setConvertFunction([] (QObject *object) {
+            return QPair<int, QString>(object->property("objectId").toInt(), object->objectName());
+        });
+        query.setUpdateFunction([] (QObject *object, QPair<int, QString> &output) {
+            output.second = object->objectName();
+        });
+        query.setPredicateFunction([] (QObject *object) {
+            return object->objectName().startsWith('0');
+        });
+        query.setRepresentsFunction([] (QObject *object, const QPair<int, QString> &output) {
+            return object->property("objectId").toInt() == output.first;
+        });
+
+        Domain::QueryResult<QPair<int, QString>>::Ptr result = query.result();
+        QTest::qWait(150);
+        QList<QPair<int, QString>> expected;
+        expected << QPair<int, QString>(0, "0A")
+                 << QPair<int, QString>(3, "0B")
+                 << QPair<int, QString>(6, "0C");
+        QCOMPARE(result->data(), expected);
+
+        // WHEN
+        query.onChangedBatch(QList<QObject*>() << createObject(3, "0BB")
+                                               << createObject(6, "1C")
+                                               << createObject(4, "0D"));
+
+        // THEN
+        expected.clear();
+        expected << QPair<int, QString>(0, "0A")
+                 << QPair<int, QString>(3, "0BB")
+                 << QPair<int, QString>(4, "0D");
+        QCOMPARE(result->data(), expected);
+
+        // WHEN
+        query.onRemovedBatch(QList<QObject*>() << createObject(0, "0A")
+                                               << createObject(3, "0BB"));
+
+        // THEN
+        expected.clear();
+        expected << QPair<int, QString>(4, "0D");
+        QCOMPARE(result->data(), expected);
+
+        // WHEN
+        query.onAddedBatch(QList<QObject*>() << createObject(9, "0E")
+                                             << createObject(10, "1E"));
+
+        // THEN
+        expected << QPair<int, QString>(9, "0E");
+        QCOMPARE(result->data(), expected);
+    }
+
+    void shouldLookUpBatchedEventsByKey()
+    {
+        // GIVEN
+        Domain::LiveQuery<QObject*, QPair<int, QString>> query;
+        query.setFetchFunction([this] (const Domain::LiveQuery<QObject*, QString>::AddFunction &add) {
+            Utils::JobHandler::install(new FakeJob, [this, add] {
+                add(createObject(0, "0A"));
+                add(createObject(1, "1A"));
+                add(createObject(2, "0B"));
+                add(createObject(3, "0C"));
+                add(createObject(4, "0D"));
+            });
+        });
+        query.setConvertFunction([] (QObject *object) {
+            return QPair<int, QString>(object->property("objectId").toInt(), object->objectName());
+        });
+        query.setUpdateFunction([] (QObject *object, QPair<int, QString> &output) {
+            output.second = object->objectName();
+        });
+        query.setPredicateFunction([] (QObject *object) {
+            return object->objectName().startsWith('0');
+        });
+        int representsCount = 0;
+        query.setRepresentsFunction([&representsCount] (QObject *object, const QPair<int, QString> &output) {
+            representsCount++;
+            return object->property("objectId").toInt() == output.first;
+        });
+        query.setKeyFunction([] (QObject *object) {
+            return object->property("objectId").toLongLong();
+        });
+
+        Domain::QueryResult<QPair<int, QString>>::Ptr result = query.result();
+        QTest::qWait(150);
+        QList<QPair<int, QString>> expected;
+        expected << QPair<int, QString>(0, "0A")
+                 << QPair<int, QString>(2, "0B")
+                 << QPair<int, QString>(3, "0C")
+                 << QPair<int, QString>(4, "0D");
+        QCOMPARE(result->data(), expected);
+
+        // WHEN
+        query.onChangedBatch(QList<QObject*>() << createObject(2, "0BB")
+                                               << createObject(3, "1C")
+                                               << createObject(1, "0AA"));
+
+        // THEN
+        expected.clear();
+        expected << QPair<int, QString>(0, "0A")
+                 << QPair<int, QString>(2, "0BB")
+                 << QPair<int, QString>(4, "0D")
+                 << QPair<int, QString>(1, "0AA");
+        QCOMPARE(result->data(), expected);
+        QCOMPARE(representsCount, 2);
+
+        // WHEN
+        representsCount = 0;
+        query.onRemovedBatch(QList<QObject*>() << createObject(0, "0A")
+                                               << createObject(1, "0AA"));
+
+        // THEN
+        expected.clear();
+        expected << QPair<int, QString>(2, "0BB")
+                 << QPair<int, QString>(4, "0D");
+        QCOMPARE(result->data(), expected);
+        QCOMPARE(representsCount, 2);
+
+        // WHEN
+        representsCount = 0;
+        query.onChangedBatch(QList<QObject*>() << createObject(4, "0DD"));
+
+        // THEN
+        expected.clear();
+        expected << QPair<int, QString>(2, "0BB")
+                 << QPair<int, QString>(4, "0DD");
+        QCOMPARE(result->data(), expected);
+        QCOMPARE(representsCount, 1);
+    }
+
     void shouldRemoveWhenChangesMakeInputUnsuitableForQuery()
     {
         // GIVEN
@@ -439,6 +594,105 @@ private slots:
         QCOMPARE(result->data(), expected);
         QCOMPARE(removeHandlerCallCount, 2);
     }
+
+    void shouldKeepNotificationsInOrderWithSlicedFetches()
+    {
+        // GIVEN
+        Utils::TimeSlicer::setEnabled(true);
+
+        Domain::LiveQuery<QObject*, QPair<int, QString>> query;
+        query.setFetchFunction([this] (const Domain::LiveQuery<QObject*, QString>::AddFunction &add) {
+            add(createObject(0, "0A"));
+            add(createObject(1, "1A"));
+            add(createObject(3, "0B"));
+            add(createObject(6, "0C"));
+        });
+        query.setConvertFunction([] (QObject *object) {
+            return QPair<int, QString>(object->property("objectId").toInt(), object->objectName());
+        });
+        query.setUpdateFunction([] (QObject *object, QPair<int, QString> &output) {
+            output.second = object->objectName();
+        });
+        query.setPredicateFunction([] (QObject *object) {
+            return object->objectName().startsWith('0');
+        });
+        query.setRepresentsFunction([] (QObject *object, const QPair<int, QString> &output) {
+            return object->property("objectId").toInt() == output.first;
+        });
+
+        // WHEN
+        Domain::QueryResult<QPair<int, QString>>::Ptr result = query.result();
+        query.onRemoved(createObject(3, "0B"));
+        query.onChanged(createObject(6, "0D"));
+
+        // THEN
+        QVERIFY(result->data().isEmpty());
+        QTest::qWait(Utils::TimeSlicer::budget() * 2);
+        QList<QPair<int, QString>> expected;
+        expected << QPair<int, QString>(0, "0A")
+                 << QPair<int, QString>(6, "0D");
+        QCOMPARE(result->data(), expected);
+
+        Utils::TimeSlicer::setEnabled(false);
+    }
+
+    void shouldDropTheFetchOnceTheResultsAreGone()
+    {
+        // GIVEN
+        int handlerCount = 0;
+        Domain::LiveQuery<QObject*, QPair<int, QString>> query;
+        query.setFetchFunction([this, &handlerCount] (const Domain::LiveQuery<QObject*, QString>::AddFunction &add) {
+            Utils::JobHandler::install(new FakeJob, [this, add, &handlerCount] {
+                handlerCount++;
+                add(createObject(0, "0A"));
+            });
+        });
+        query.setConvertFunction([] (QObject *object) {
+            return QPair<int, QString>(object->property("objectId").toInt(), object->objectName());
+        });
+        query.setPredicateFunction([] (QObject *object) {
+            return object->objectName().startsWith('0');
+        });
+
+        // WHEN
+        query.result(); // Dropped right away
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(handlerCount, 0);
+        QCOMPARE(Utils::JobHandler::jobCount(), 0);
+    }
+
+    void shouldDropThePreviousFetchOnReset()
+    {
+        // GIVEN
+        int handlerCount = 0;
+        Domain::LiveQuery<QObject*, QPair<int, QString>> query;
+        query.setFetchFunction([this, &handlerCount] (const Domain::LiveQuery<QObject*, QString>::AddFunction &add) {
+            Utils::JobHandler::install(new FakeJob, [this, add, &handlerCount] {
+                handlerCount++;
+                add(createObject(0, "0A"));
+            });
+        });
+        query.setConvertFunction([] (QObject *object) {
+            return QPair<int, QString>(object->property("objectId").toInt(), object->objectName());
+        });
+        query.setPredicateFunction([] (QObject *object) {
+            return object->objectName().startsWith('0');
+        });
+
+        Domain::QueryResult<QPair<int, QString>>::Ptr result = query.result();
+
+        // WHEN
+        query.reset();
+        QTest::qWait(150);
+
+        // THEN
+        QCOMPARE(handlerCount, 1);
+        QList<QPair<int, QString>> expected;
+        expected << QPair<int, QString>(0, "0A");
+        QCOMPARE(result->data(), expected);
+    }
 };
 
 QTEST_MAIN(LiveQueryTest)
@@ -302,6 +302,53 @@ private slots:
         QVERIFY(taskRepositoryMock(&Domain::TaskRepository::remove).when(task2).exactly(1));
     }
 
+    void shouldDeleteSeveralItemsAtOnce()
+    {
+        // GIVEN
+
+        // Two tasks
+        auto task1 = Domain::Task::Ptr::create();
+        task1->setTitle("task1");
+        auto task2 = Domain::Task::Ptr::create();
+        task2->setTitle("task2");
+        auto artifactProvider = Domain::QueryResultProvider<Domain::Artifact::Ptr>::Ptr::create();
+        auto artifactResult = Domain::QueryResult<Domain::Artifact::Ptr>::create(artifactProvider);
+        artifactProvider->append(task1);
+        artifactProvider->append(task2);
+
+        Utils::MockObject<Domain::ArtifactQueries> artifactQueriesMock;
+        artifactQueriesMock(&Domain::ArtifactQueries::findInboxTopLevel).when().thenReturn(artifactResult);
+
+        Utils::MockObject<Domain::TaskQueries> taskQueriesMock;
+        taskQueriesMock(&Domain::TaskQueries::findChildren).when(task1).thenReturn(Domain::QueryResult<Domain::Task::Ptr>::Ptr());
+        taskQueriesMock(&Domain::TaskQueries::findChildren).when(task2).thenReturn(Domain::QueryResult<Domain::Task::Ptr>::Ptr());
+
+        Utils::MockObject<Domain::NoteRepository> noteRepositoryMock;
+
+        Utils::MockObject<Domain::TaskRepository> taskRepositoryMock;
+        auto job = new FakeJob(this);
+        job->setExpectedError(KJob::KilledJobError, "Foo");
+        taskRepositoryMock(&Domain::TaskRepository::removeTasks).when(Domain::Task::List() << task1 << task2)
+                                                                .thenReturn(job);
+
+        Presentation::InboxPageModel inbox(artifactQueriesMock.getInstance(),
+                                           taskQueriesMock.getInstance(),
+                                           taskRepositoryMock.getInstance(),
+                                           noteRepositoryMock.getInstance());
+        FakeErrorHandler errorHandler;
+        inbox.setErrorHandler(&errorHandler);
+
+        // WHEN
+        auto model = inbox.centralListModel();
+        inbox.removeItems(QModelIndexList() << model->index(0, 0) << model->index(1, 0));
+
+        // THEN
+        QTest::qWait(150);
+        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::removeTasks).when(Domain::Task::List() << task1 << task2)
+                                                                        .exactly(1));
+        QCOMPARE(errorHandler.m_message, QString("Cannot remove tasks task1, task2 from Inbox: Foo"));
+    }
+
     void shouldGetAnErrorMessageWhenDeleteItemsFailed()
     {
         // GIVEN
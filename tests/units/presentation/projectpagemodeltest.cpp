@@ -176,14 +176,16 @@ private slots:
 
         // WHEN
         auto childTask2 = Domain::Task::Ptr::create();
-        taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask2).thenReturn(new FakeJob(this));
+        taskRepositoryMock(&Domain::TaskRepository::associateChildren).when(rootTask, Domain::Task::List() << childTask2)
+                                                                      .thenReturn(new FakeJob(this));
         data = new QMimeData;
         data->setData("application/x-zanshin-object", "object");
         data->setProperty("objects", QVariant::fromValue(Domain::Artifact::List() << childTask2));
         model->dropMimeData(data, Qt::MoveAction, -1, -1, rootTaskIndex);
 
         // THEN
-        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask2).exactly(1));
+        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::associateChildren).when(rootTask, Domain::Task::List() << childTask2)
+                                                                              .exactly(1));
 
 
         // WHEN
@@ -198,16 +200,16 @@ private slots:
         // WHEN
         auto childTask3 = Domain::Task::Ptr::create();
         auto childTask4 = Domain::Task::Ptr::create();
-        taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask3).thenReturn(new FakeJob(this));
-        taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask4).thenReturn(new FakeJob(this));
+        taskRepositoryMock(&Domain::TaskRepository::associateChildren).when(rootTask, Domain::Task::List() << childTask3 << childTask4)
+                                                                      .thenReturn(new FakeJob(this));
         data = new QMimeData;
         data->setData("application/x-zanshin-object", "object");
         data->setProperty("objects", QVariant::fromValue(Domain::Artifact::List() << childTask3 << childTask4));
         model->dropMimeData(data, Qt::MoveAction, -1, -1, rootTaskIndex);
 
         // THEN
-        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask3).exactly(1));
-        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask4).exactly(1));
+        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::associateChildren).when(rootTask, Domain::Task::List() << childTask3 << childTask4)
+                                                                              .exactly(1));
     }
 
     void shouldAddTasks()
@@ -327,6 +329,51 @@ private slots:
         QVERIFY(taskRepositoryMock(&Domain::TaskRepository::remove).when(task2).exactly(1));
     }
 
+    void shouldDeleteSeveralItemsAtOnce()
+    {
+        // GIVEN
+
+        // One project
+        auto project = Domain::Project::Ptr::create();
+
+        // Two tasks and a note
+        auto task1 = Domain::Task::Ptr::create();
+        auto task2 = Domain::Task::Ptr::create();
+        auto note3 = Domain::Note::Ptr::create();
+        auto artifactProvider = Domain::QueryResultProvider<Domain::Artifact::Ptr>::Ptr::create();
+        auto artifactResult = Domain::QueryResult<Domain::Artifact::Ptr>::create(artifactProvider);
+        artifactProvider->append(task1);
+        artifactProvider->append(task2);
+        artifactProvider->append(note3);
+
+        Utils::MockObject<Domain::ProjectQueries> projectQueriesMock;
+        projectQueriesMock(&Domain::ProjectQueries::findTopLevelArtifacts).when(project).thenReturn(artifactResult);
+
+        Utils::MockObject<Domain::TaskQueries> taskQueriesMock;
+        taskQueriesMock(&Domain::TaskQueries::findChildren).when(task1).thenReturn(Domain::QueryResult<Domain::Task::Ptr>::Ptr());
+        taskQueriesMock(&Domain::TaskQueries::findChildren).when(task2).thenReturn(Domain::QueryResult<Domain::Task::Ptr>::Ptr());
+
+        Utils::MockObject<Domain::NoteRepository> noteRepositoryMock;
+
+        Utils::MockObject<Domain::TaskRepository> taskRepositoryMock;
+        taskRepositoryMock(&Domain::TaskRepository::removeTasks).when(Domain::Task::List() << task1 << task2)
+                                                                .thenReturn(new FakeJob(this));
+
+        Presentation::ProjectPageModel page(project,
+                                            projectQueriesMock.getInstance(),
+                                            taskQueriesMock.getInstance(),
+                                            taskRepositoryMock.getInstance(),
+                                            noteRepositoryMock.getInstance());
+
+        // WHEN
+        auto model = page.centralListModel();
+        page.removeItems(QModelIndexList() << model->index(0, 0) << model->index(1, 0) << model->index(2, 0));
+
+        // THEN
+        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::removeTasks).when(Domain::Task::List() << task1 << task2)
+                                                                        .exactly(1));
+    }
+
     void shouldGetAnErrorMessageWhenDeleteItemsFailed()
     {
         // GIVEN
@@ -547,10 +594,11 @@ private slots:
         auto childTask3 = Domain::Task::Ptr::create();
         childTask3->setTitle("childTask3");
         auto childTask4 = Domain::Task::Ptr::create();
+        childTask4->setTitle("childTask4");
         auto job = new FakeJob(this);
         job->setExpectedError(KJob::KilledJobError, "Foo");
-        taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask3).thenReturn(job);
-        taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask4).thenReturn(new FakeJob(this));
+        taskRepositoryMock(&Domain::TaskRepository::associateChildren).when(rootTask, Domain::Task::List() << childTask3 << childTask4)
+                                                                      .thenReturn(job);
         auto data = new QMimeData;
         data->setData("application/x-zanshin-object", "object");
         data->setProperty("objects", QVariant::fromValue(Domain::Artifact::List() << childTask3 << childTask4));
@@ -558,8 +606,7 @@ private slots:
 
         // THEN
         QTest::qWait(150);
-        QCOMPARE(errorHandler.m_message, QString("Cannot move task childTask3 as a sub-task of rootTask: Foo"));
-        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::associate).when(rootTask, childTask4).exactly(1));
+        QCOMPARE(errorHandler.m_message, QString("Cannot move tasks childTask3, childTask4 as sub-tasks of rootTask: Foo"));
     }
 };
 
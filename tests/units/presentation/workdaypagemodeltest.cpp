@@ -257,6 +257,42 @@ private slots:
         // THEN
         QVERIFY(taskRepositoryMock(&Domain::TaskRepository::remove).when(task2).exactly(1));
     }
+
+    void shouldDeleteSeveralItemsAtOnce()
+    {
+        // GIVEN
+
+        // Two tasks
+        auto task1 = Domain::Task::Ptr::create();
+        auto task2 = Domain::Task::Ptr::create();
+        auto taskProvider = Domain::QueryResultProvider<Domain::Task::Ptr>::Ptr::create();
+        auto taskResult = Domain::QueryResult<Domain::Task::Ptr>::create(taskProvider);
+        taskProvider->append(task1);
+        taskProvider->append(task2);
+
+        Utils::MockObject<Domain::TaskQueries> taskQueriesMock;
+        taskQueriesMock(&Domain::TaskQueries::findWorkdayTopLevel).when().thenReturn(taskResult);
+        taskQueriesMock(&Domain::TaskQueries::findChildren).when(task1).thenReturn(Domain::QueryResult<Domain::Task::Ptr>::Ptr());
+        taskQueriesMock(&Domain::TaskQueries::findChildren).when(task2).thenReturn(Domain::QueryResult<Domain::Task::Ptr>::Ptr());
+
+        Utils::MockObject<Domain::NoteRepository> noteRepositoryMock;
+
+        Utils::MockObject<Domain::TaskRepository> taskRepositoryMock;
+        taskRepositoryMock(&Domain::TaskRepository::removeTasks).when(Domain::Task::List() << task1 << task2)
+                                                                .thenReturn(new FakeJob(this));
+
+        Presentation::WorkdayPageModel workday(taskQueriesMock.getInstance(),
+                                               taskRepositoryMock.getInstance(),
+                                               noteRepositoryMock.getInstance());
+
+        // WHEN
+        auto model = workday.centralListModel();
+        workday.removeItems(QModelIndexList() << model->index(0, 0) << model->index(1, 0));
+
+        // THEN
+        QVERIFY(taskRepositoryMock(&Domain::TaskRepository::removeTasks).when(Domain::Task::List() << task1 << task2)
+                                                                        .exactly(1));
+    }
 };
 
 QTEST_MAIN(WorkdayPageModelTest)
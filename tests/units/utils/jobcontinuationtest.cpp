@@ -0,0 +1,276 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "utils/jobcontinuation.h"
+#include "utils/jobhandler.h"
+
+#include "testlib/fakejob.h"
+
+using namespace Utils;
+
+class JobContinuationTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void shouldRunAllJobsSideBySide()
+    {
+        // GIVEN
+        int callCount = 0;
+        QList<KJob*> seenJobs;
+        QList<int> seenErrors;
+
+        auto job1 = new FakeJob(this);
+        auto job2 = new FakeJob(this);
+        job2->setExpectedError(KJob::KilledJobError);
+        auto job3 = new FakeJob(this);
+        const auto jobs = QList<KJob*>() << job1 << job2 << job3;
+
+        // WHEN
+        QElapsedTimer timer;
+        timer.start();
+        JobContinuation::whenAll(jobs, [&] (KJob *job) {
+            seenJobs << job;
+            seenErrors << job->error();
+        }, [&] {
+            callCount++;
+        });
+        QCOMPARE(callCount, 0);
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QCOMPARE(callCount, 1);
+        QCOMPARE(seenJobs, jobs);
+        QCOMPARE(seenErrors, QList<int>() << KJob::NoError << KJob::KilledJobError << KJob::NoError);
+        QVERIFY(timer.elapsed() < 2 * FakeJob::DURATION);
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldCollectResultsOfJobsDoneInDifferentIterations()
+    {
+        // GIVEN
+        int callCount = 0;
+        bool firstJobGone = false;
+        QList<int> seenErrors;
+
+        auto job1 = new FakeJob(this);
+        job1->setExpectedError(KJob::KilledJobError);
+        auto job2 = new FakeJob(this);
+        QPointer<KJob> firstJob(job1);
+
+        // Done half way through the wait for job2
+        job1->start();
+        QTest::qWait(FakeJob::DURATION / 2);
+
+        // WHEN
+        JobContinuation::whenAll(QList<KJob*>() << job1 << job2, [&] (KJob *job) {
+            seenErrors << job->error();
+        }, [&] {
+            callCount++;
+            firstJobGone = firstJob.isNull();
+        });
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QCOMPARE(callCount, 1);
+        QCOMPARE(seenErrors, QList<int>() << KJob::KilledJobError << KJob::NoError);
+        QVERIFY(firstJobGone);
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldContinueRightAwayWithoutJobs()
+    {
+        // GIVEN
+        int callCount = 0;
+
+        // WHEN
+        JobContinuation::whenAll(QList<KJob*>(), [&] (KJob *) {
+            QFAIL("No job to handle");
+        }, [&] {
+            callCount++;
+        });
+
+        // THEN
+        QCOMPARE(callCount, 1);
+    }
+
+    void shouldDropTheContinuationOfAbandonedJobs()
+    {
+        // GIVEN
+        int owner = 0;
+        int callCount = 0;
+
+        {
+            JobHandler::OwnerScope scope(&owner);
+            JobContinuation::whenAll(QList<KJob*>() << new FakeJob(this) << new FakeJob(this),
+                                     [&] (KJob *) {
+                callCount++;
+            }, [&] {
+                callCount++;
+            });
+        }
+        QCOMPARE(JobHandler::currentOwner(), static_cast<const void*>(Q_NULLPTR));
+
+        // WHEN
+        JobHandler::abandon(&owner);
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QCOMPARE(callCount, 0);
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldFinishTheJoinAfterTheContinuation()
+    {
+        // GIVEN
+        bool joinDoneFirst = false;
+        int joinError = -1;
+        QString joinErrorText;
+        bool continuationCalled = false;
+
+        auto job1 = new FakeJob(this);
+        auto job2 = new FakeJob(this);
+        job2->setExpectedError(KJob::KilledJobError, QStringLiteral("Killed"));
+
+        // WHEN
+        KJob *join = JobContinuation::whenAll(QList<KJob*>() << job1 << job2, [] (KJob *) {}, [&] {
+            continuationCalled = true;
+        });
+        JobHandler::install(join, [&] (KJob *join) {
+            joinDoneFirst = !continuationCalled;
+            joinError = join->error();
+            joinErrorText = join->errorText();
+        });
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QVERIFY(continuationCalled);
+        QVERIFY(!joinDoneFirst);
+        QCOMPARE(joinError, int(KJob::KilledJobError));
+        QCOMPARE(joinErrorText, QStringLiteral("Killed"));
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldFinishTheJoinOfNoJobsLater()
+    {
+        // GIVEN
+        bool joinDone = false;
+
+        // WHEN
+        KJob *join = JobContinuation::whenAll(QList<KJob*>(), [] (KJob *) {}, [] {});
+        JobHandler::install(join, [&] { joinDone = true; });
+        QVERIFY(!joinDone);
+        QTest::qWait(10);
+
+        // THEN
+        QVERIFY(joinDone);
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldGiveUpOnJobsTakingTooLong()
+    {
+        // GIVEN
+        int callCount = 0;
+        int joinError = -1;
+
+        // WHEN
+        KJob *join = JobContinuation::whenAll(QList<KJob*>() << new FakeJob(this) << new FakeJob(this),
+                                              [&] (KJob *) {
+            callCount++;
+        }, [&] {
+            callCount++;
+        }, FakeJob::DURATION / 2);
+        JobHandler::install(join, [&] (KJob *join) {
+            joinError = join->error();
+        });
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QCOMPARE(callCount, 0);
+        QCOMPARE(joinError, int(JobContinuation::TimedOutError));
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldDropTheContinuationOfCancelledJoins()
+    {
+        // GIVEN
+        int callCount = 0;
+        KJob *join = JobContinuation::whenAll(QList<KJob*>() << new FakeJob(this) << new FakeJob(this),
+                                              [&] (KJob *) {
+            callCount++;
+        }, [&] {
+            callCount++;
+        });
+
+        // WHEN
+        QVERIFY(join->kill(KJob::EmitResult));
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QCOMPARE(callCount, 0);
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldContinueWithTheJobOnceDone()
+    {
+        // GIVEN
+        auto job = new FakeJob(this);
+        KJob *seenJob = Q_NULLPTR;
+
+        // WHEN
+        JobContinuation::whenDone(job, [&] (KJob *job) {
+            seenJob = job;
+        });
+        QVERIFY(!seenJob);
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QCOMPARE(seenJob, static_cast<KJob*>(job));
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+
+    void shouldRunTheContinuationOnBehalfOfTheOwner()
+    {
+        // GIVEN
+        int owner = 0;
+        const void *continuationOwner = Q_NULLPTR;
+
+        // WHEN
+        {
+            JobHandler::OwnerScope scope(&owner);
+            JobContinuation::whenAll(QList<KJob*>() << new FakeJob(this), [] (KJob *) {}, [&] {
+                continuationOwner = JobHandler::currentOwner();
+            });
+        }
+        QTest::qWait(FakeJob::DURATION + 10);
+
+        // THEN
+        QCOMPARE(continuationOwner, static_cast<const void*>(&owner));
+        QCOMPARE(JobHandler::jobCount(), 0);
+    }
+};
+
+QTEST_MAIN(JobContinuationTest)
+
+#include "jobcontinuationtest.moc"
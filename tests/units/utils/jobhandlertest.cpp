@@ -66,6 +66,41 @@ private slots:
         QCOMPARE(seenJobs.toSet(), QSet<KJob*>() << job1 << job2);
         QCOMPARE(JobHandler::jobCount(), 0);
     }
+
+    void shouldDropTheHandlersOfAbandonedJobs()
+    {
+        int owner = 0;
+        QStringList calls;
+
+        JobHandler::setCurrentOwner(&owner);
+        FakeJob *job1 = new FakeJob(this);
+        JobHandler::install(job1, [&] {
+            calls << "job1";
+
+            // Installed from an owned job handler, so owned as well
+            FakeJob *job3 = new FakeJob(this);
+            JobHandler::install(job3, [&] {
+                calls << "job3";
+            });
+        });
+        JobHandler::setCurrentOwner(Q_NULLPTR);
+        QCOMPARE(JobHandler::currentOwner(), static_cast<const void*>(Q_NULLPTR));
+
+        FakeJob *job2 = new FakeJob(this);
+        JobHandler::install(job2, [&] {
+            calls << "job2";
+        });
+
+        QTest::qWait(FakeJob::DURATION + 10);
+        QCOMPARE(calls, QStringList() << "job1" << "job2");
+        QCOMPARE(JobHandler::jobCount(), 1);
+
+        JobHandler::abandon(&owner);
+        QCOMPARE(JobHandler::jobCount(), 0);
+
+        QTest::qWait(FakeJob::DURATION + 10);
+        QCOMPARE(calls, QStringList() << "job1" << "job2");
+    }
 };
 
 QTEST_MAIN(JobHandlerTest)
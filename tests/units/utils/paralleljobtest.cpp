@@ -0,0 +1,232 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Mario Bensi <mbensi@ipsquad.net>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "utils/paralleljob.h"
+
+#include "testlib/fakejob.h"
+
+using namespace Utils;
+
+class ParallelJobTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void shouldRunSubjobsSideBySide()
+    {
+        // GIVEN
+        QStringList calls;
+        auto parallelJob = new ParallelJob(this);
+        parallelJob->setAutoDelete(false);
+        QVERIFY(parallelJob->install(new FakeJob(this), [&] { calls << "job1"; }));
+        QVERIFY(parallelJob->install(new FakeJob(this), [&] { calls << "job2"; }));
+        QVERIFY(parallelJob->install(new FakeJob(this), [&] { calls << "job3"; }));
+
+        // WHEN
+        QElapsedTimer timer;
+        timer.start();
+        parallelJob->exec();
+
+        // THEN
+        QVERIFY(timer.elapsed() < 2 * FakeJob::DURATION);
+        QCOMPARE(calls.toSet(), QSet<QString>() << "job1" << "job2" << "job3");
+        QVERIFY(!parallelJob->error());
+        QVERIFY(!parallelJob->hasSubjobs());
+        delete parallelJob;
+    }
+
+    void shouldBoundTheRunningSubjobs()
+    {
+        // GIVEN
+        auto parallelJob = new ParallelJob(2, this);
+        parallelJob->setAutoDelete(false);
+        QCOMPARE(parallelJob->maxRunningJobs(), 2);
+        for (int i = 0; i < 4; i++)
+            QVERIFY(parallelJob->addSubjob(new FakeJob(this)));
+
+        // WHEN
+        QElapsedTimer timer;
+        timer.start();
+        parallelJob->exec();
+
+        // THEN
+        QVERIFY(timer.elapsed() >= 2 * FakeJob::DURATION);
+        QVERIFY(timer.elapsed() < 3 * FakeJob::DURATION);
+        QVERIFY(!parallelJob->error());
+        delete parallelJob;
+    }
+
+    void shouldBoundTheDependentSubjobsStartingOnTheirOwn()
+    {
+        // GIVEN
+        auto parallelJob = new ParallelJob(2, this);
+        parallelJob->setAutoDelete(false);
+        for (int i = 0; i < 4; i++) {
+            QVERIFY(parallelJob->addDependentJob(QList<KJob*>(), [this] {
+                // Like Akonadi jobs, running as soon as created
+                auto job = new FakeJob(this);
+                job->start();
+                return job;
+            }));
+        }
+
+        // WHEN
+        QElapsedTimer timer;
+        timer.start();
+        parallelJob->exec();
+
+        // THEN
+        QVERIFY(timer.elapsed() >= 2 * FakeJob::DURATION);
+        QVERIFY(timer.elapsed() < 3 * FakeJob::DURATION);
+        QVERIFY(!parallelJob->error());
+        delete parallelJob;
+    }
+
+    void shouldCreateDependentSubjobsOnceTheirDependenciesAreDone()
+    {
+        // GIVEN
+        QStringList calls;
+        auto job1 = new FakeJob(this);
+        auto job2 = new FakeJob(this);
+
+        auto parallelJob = new ParallelJob(this);
+        parallelJob->setAutoDelete(false);
+        QVERIFY(parallelJob->install(job1, [&] { calls << "job1"; }));
+        QVERIFY(parallelJob->install(job2, [&] { calls << "job2"; }));
+        QVERIFY(parallelJob->addDependentJob(QList<KJob*>() << job1 << job2, [&] {
+            calls << "job3 created";
+            // Starts on its own like the Akonadi jobs
+            auto job3 = new FakeJob(this);
+            job3->start();
+            return job3;
+        }, [&] (KJob *) { calls << "job3"; }));
+        QVERIFY(!parallelJob->addDependentJob(QList<KJob*>() << new FakeJob(this), [] { return Q_NULLPTR; }));
+
+        // WHEN
+        parallelJob->exec();
+
+        // THEN
+        QCOMPARE(calls.size(), 4);
+        QCOMPARE(calls.mid(0, 2).toSet(), QSet<QString>() << "job1" << "job2");
+        QCOMPARE(calls.mid(2), QStringList() << "job3 created" << "job3");
+        QVERIFY(!parallelJob->error());
+        delete parallelJob;
+    }
+
+    void shouldAggregateErrorsAndNotCreateTheDependentSubjobs()
+    {
+        // GIVEN
+        QStringList calls;
+        auto job1 = new FakeJob(this);
+        job1->setExpectedError(KJob::KilledJobError, "foo");
+        auto job2 = new FakeJob(this);
+        job2->setExpectedError(KJob::UserDefinedError, "bar");
+        auto job3 = new FakeJob(this);
+
+        auto parallelJob = new ParallelJob(this);
+        parallelJob->setAutoDelete(false);
+        QVERIFY(parallelJob->install(job1, [&] { calls << "job1"; }));
+        QVERIFY(parallelJob->install(job2, [&] { calls << "job2"; }));
+        QVERIFY(parallelJob->install(job3, [&] { calls << "job3"; }));
+        QVERIFY(parallelJob->addDependentJob(QList<KJob*>() << job1 << job3, [&] {
+            calls << "job4 created";
+            return new FakeJob(this);
+        }));
+
+        // WHEN
+        parallelJob->exec();
+
+        // THEN
+        QCOMPARE(calls.toSet(), QSet<QString>() << "job1" << "job2" << "job3");
+        QCOMPARE(parallelJob->error(), int(KJob::KilledJobError));
+        QCOMPARE(parallelJob->errorText().split('\n').toSet(), QSet<QString>() << "foo" << "bar");
+        delete parallelJob;
+    }
+
+    void shouldCreateDependentSubjobsAddedByFactories()
+    {
+        // GIVEN
+        QStringList calls;
+        auto job1 = new FakeJob(this);
+
+        auto parallelJob = new ParallelJob(this);
+        parallelJob->setAutoDelete(false);
+        QVERIFY(parallelJob->install(job1, [&] { calls << "job1"; }));
+        QVERIFY(parallelJob->addDependentJob(QList<KJob*>() << job1, [&] {
+            calls << "job2 created";
+            // Nothing left to depend on, still has to be created
+            parallelJob->addDependentJob(QList<KJob*>(), [&] {
+                calls << "job3 created";
+                return Q_NULLPTR;
+            });
+            return Q_NULLPTR;
+        }));
+
+        // WHEN
+        parallelJob->exec();
+
+        // THEN
+        QCOMPARE(calls, QStringList() << "job1" << "job2 created" << "job3 created");
+        QVERIFY(!parallelJob->error());
+        delete parallelJob;
+    }
+
+    void shouldPickUpSubjobsAddedByHandlers()
+    {
+        // GIVEN
+        QStringList calls;
+        auto parallelJob = new ParallelJob(this);
+        parallelJob->setAutoDelete(false);
+        QVERIFY(parallelJob->install(new FakeJob(this), [&] {
+            calls << "job1";
+            QVERIFY(parallelJob->install(new FakeJob(this), [&] { calls << "job2"; }));
+        }));
+
+        // WHEN
+        parallelJob->exec();
+
+        // THEN
+        QCOMPARE(calls, QStringList() << "job1" << "job2");
+        QVERIFY(!parallelJob->error());
+        delete parallelJob;
+    }
+
+    void shouldBeDoneRightAwayWithoutSubjobs()
+    {
+        // GIVEN
+        auto parallelJob = new ParallelJob(this);
+        parallelJob->setAutoDelete(false);
+
+        // WHEN
+        QVERIFY(parallelJob->exec());
+
+        // THEN
+        QVERIFY(!parallelJob->error());
+        delete parallelJob;
+    }
+};
+
+QTEST_MAIN(ParallelJobTest)
+
+#include "paralleljobtest.moc"
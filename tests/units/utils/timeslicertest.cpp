@@ -0,0 +1,126 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+
+#include "utils/timeslicer.h"
+
+using namespace Utils;
+
+class TimeSlicerTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cleanup()
+    {
+        TimeSlicer::setEnabled(false);
+    }
+
+    void shouldRunWorkRightAwayWhenDisabled()
+    {
+        // GIVEN
+        int owner = 0;
+        int callCount = 0;
+
+        // WHEN
+        TimeSlicer::post(&owner, [&callCount] { callCount++; });
+
+        // THEN
+        QCOMPARE(callCount, 1);
+        QCOMPARE(TimeSlicer::pendingCount(&owner), 0);
+    }
+
+    void shouldYieldToTheEventLoopBetweenSlices()
+    {
+        // GIVEN
+        TimeSlicer::setEnabled(true);
+        int owner = 0;
+        int callCount = 0;
+
+        // WHEN
+        for (int i = 0; i < 3; i++) {
+            TimeSlicer::post(&owner, [&callCount] {
+                callCount++;
+                QTest::qSleep(TimeSlicer::budget());
+            });
+        }
+
+        // THEN
+        QCOMPARE(callCount, 0);
+        QCOMPARE(TimeSlicer::pendingCount(&owner), 3);
+        QCoreApplication::processEvents();
+        QVERIFY(callCount < 3);
+        QTest::qWait(TimeSlicer::budget() * 10);
+        QCOMPARE(callCount, 3);
+        QCOMPARE(TimeSlicer::pendingCount(&owner), 0);
+    }
+
+    void shouldServePromotedOwnersFirst()
+    {
+        // GIVEN
+        TimeSlicer::setEnabled(true);
+        int owner1 = 0;
+        int owner2 = 0;
+        int owner3 = 0;
+        QStringList calls;
+
+        // WHEN
+        TimeSlicer::promote(&owner3);
+        TimeSlicer::post(&owner1, [&calls] { calls << "1A"; });
+        TimeSlicer::post(&owner2, [&calls] { calls << "2A"; });
+        TimeSlicer::post(&owner1, [&calls] { calls << "1B"; });
+        TimeSlicer::post(&owner3, [&calls] { calls << "3A"; });
+        TimeSlicer::post(&owner2, [&calls] { calls << "2B"; });
+        TimeSlicer::promote(&owner2);
+        QTest::qWait(TimeSlicer::budget() * 2);
+
+        // THEN
+        QCOMPARE(calls, QStringList() << "2A" << "2B" << "3A" << "1A" << "1B");
+
+        TimeSlicer::release(&owner2);
+        TimeSlicer::release(&owner3);
+    }
+
+    void shouldDropCanceledWork()
+    {
+        // GIVEN
+        TimeSlicer::setEnabled(true);
+        int owner1 = 0;
+        int owner2 = 0;
+        QStringList calls;
+        TimeSlicer::post(&owner1, [&calls] { calls << "1A"; });
+        TimeSlicer::post(&owner2, [&calls] { calls << "2A"; });
+
+        // WHEN
+        TimeSlicer::cancel(&owner1);
+        QTest::qWait(TimeSlicer::budget() * 2);
+
+        // THEN
+        QCOMPARE(calls, QStringList() << "2A");
+        QCOMPARE(TimeSlicer::pendingCount(&owner1), 0);
+    }
+};
+
+QTEST_MAIN(TimeSlicerTest)
+
+#include "timeslicertest.moc"
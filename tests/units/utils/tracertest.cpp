@@ -0,0 +1,128 @@
+/* This file is part of Zanshin
+
+   Copyright 2014 Kevin Ottens <ervin@kde.org>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License or (at your option) version 3 or any later version
+   accepted by the membership of KDE e.V. (or its successor approved
+   by the membership of KDE e.V.), which shall act as a proxy
+   defined in Section 14 of version 3 of the license.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+   USA.
+*/
+
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "utils/jobhandler.h"
+#include "utils/tracer.h"
+
+#include "testlib/fakejob.h"
+
+using namespace Utils;
+
+class TracerTest : public QObject
+{
+    Q_OBJECT
+private:
+    QJsonArray readEvents(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QJsonArray();
+        return QJsonDocument::fromJson(file.readAll()).array();
+    }
+
+private slots:
+    void shouldBeDisabledByDefault()
+    {
+        QVERIFY(qgetenv(Tracer::environmentVariable().toLatin1()).isEmpty());
+        QVERIFY(!Tracer::isEnabled());
+    }
+
+    void shouldWriteSpans()
+    {
+        // GIVEN
+        QTemporaryDir dir;
+        const QString fileName = dir.path() + "/trace.json";
+        Tracer::setOutputFile(fileName);
+        QVERIFY(Tracer::isEnabled());
+
+        // WHEN
+        {
+            Tracer::Span span("test", "span");
+            span.setArg("answer", 42);
+            QTest::qWait(10);
+        }
+        Tracer::setOutputFile(QString());
+
+        // THEN
+        QVERIFY(!Tracer::isEnabled());
+        const auto events = readEvents(fileName);
+        QCOMPARE(events.size(), 1);
+
+        const auto event = events.first().toObject();
+        QCOMPARE(event.value("cat").toString(), QString("test"));
+        QCOMPARE(event.value("name").toString(), QString("span"));
+        QCOMPARE(event.value("ph").toString(), QString("X"));
+        QVERIFY(event.value("dur").toDouble() >= 10000);
+        QCOMPARE(event.value("args").toObject().value("answer").toInt(), 42);
+    }
+
+    void shouldWriteJobsWithTheirOwner()
+    {
+        // GIVEN
+        QTemporaryDir dir;
+        const QString fileName = dir.path() + "/trace.json";
+        Tracer::setOutputFile(fileName);
+
+        int owner = 0;
+        auto job = new FakeJob(this);
+        job->setExpectedError(KJob::KilledJobError, "failed");
+
+        // WHEN
+        {
+            JobHandler::OwnerScope scope(&owner);
+            Tracer::traceJob(job, "test", "job", QVariantMap(), [] (KJob *) {
+                QVariantMap args;
+                args.insert("count", 3);
+                return args;
+            });
+        }
+        job->start();
+        QTest::qWait(FakeJob::DURATION + 10);
+        Tracer::setOutputFile(QString());
+
+        // THEN
+        const auto events = readEvents(fileName);
+        QCOMPARE(events.size(), 2);
+
+        const auto begin = events.at(0).toObject();
+        QCOMPARE(begin.value("ph").toString(), QString("b"));
+        QCOMPARE(begin.value("args").toObject().value("owner").toString(), Tracer::ownerId(&owner));
+
+        const auto end = events.at(1).toObject();
+        QCOMPARE(end.value("ph").toString(), QString("e"));
+        QCOMPARE(end.value("id").toInt(), begin.value("id").toInt());
+        QCOMPARE(end.value("args").toObject().value("count").toInt(), 3);
+        QCOMPARE(end.value("args").toObject().value("error").toString(), QString("failed"));
+        QVERIFY(end.value("ts").toDouble() - begin.value("ts").toDouble() >= FakeJob::DURATION * 1000);
+    }
+};
+
+QTEST_MAIN(TracerTest)
+
+#include "tracertest.moc"
@@ -76,13 +76,21 @@ public slots:
         taskNames << name;
     }
 
-    void removeItem(const QModelIndex &index)
+    void removeItems(const QModelIndexList &indexes)
     {
-        removedIndices << index;
+        removeCalls++;
+        foreach (const QModelIndex &index, indexes)
+            removedIndices << index;
     }
 
 public:
+    PageModelStub()
+        : removeCalls(0)
+    {
+    }
+
     QStringList taskNames;
+    int removeCalls;
     QList<QPersistentModelIndex> removedIndices;
     QStandardItemModel itemModel;
 };
@@ -288,6 +296,7 @@ private slots:
 
         // THEN
         QVERIFY(msgbox->called());
+        QCOMPARE(stubPageModel.removeCalls, 1);
         QCOMPARE(stubPageModel.removedIndices.size(), 2);
         QCOMPARE(stubPageModel.removedIndices.first(), index);
         QCOMPARE(stubPageModel.removedIndices.at(1), index2);